@@ -14,11 +14,16 @@
 #define HCK_MOD_APP_SEQNO_DUPLICATE_CHECK                   1
 #define HCK_MOD_MAC_SEQNO_DUPLICATE_CHECK                   1
 //
+#define HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE              0 /* reuse IPHC encoding per (next hop, src, dst, next header) */
+//
 #define HCK_MOD_RPL_CODE_NO_PATH_DAO                        1
 #define HCK_MOD_RPL_IGNORE_REDUNDANCY_IN_BOOTSTRAP          0
 #define HCK_MOD_RPL_RELAX_ETX_NOACK_PENALTY                 1
 #define HCK_MOD_RPL_DAO_RETX_OPERATION                      1 /* stop dao retransmission when preferred parent changed */
 #define HCK_MOD_RPL_DAO_PARENT_NULLIFICATION                1 /* nullify old preferred parent before sending no-path dao, this makes no-path dao sent through common shared slotframe */
+#define HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION            0 /* cache link metrics and the best parent, re-evaluate only changed parents */
+#define HCK_MOD_RPL_CONTROL_SHAPER                          0 /* merge/suppress redundant DIOs and DAOs based on TSCH queue state, requires HCK_FORMATION_PACKET_TYPE_INFO */
+#define HCK_MOD_RPL_DAO_AGGREGATION                         0 /* storing mode parents forward child targets in one multi-target DAO, must be set network-wide */
 //
 #define HCK_MOD_TSCH_APPLY_LATEST_CONTIKI                   1
 #define HCK_MOD_TSCH_DEACTIVATE_RADIO_INTERRUPT_MODE        1
@@ -34,6 +39,27 @@
 //
 #define HCK_MOD_TSCH_PIGGYBACKING_HEADER_IE_32BITS          1 /* piggyback information of 32 bits to header IE of non-EB packets */
 #define HCK_MOD_TSCH_PIGGYBACKING_EB_IE_32BITS              1 /* piggyback information of 32 bits to IE of EB packets */
+#define HCK_MOD_TSCH_SHARED_CELL_POLICY                     0 /* compiled shared-cell policy plus a minimal fallback (shell: tsch-policy) */
+#define HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST                 0 /* parents blacklist bad channels per child from unicast PRR and announce them in EBs, must be set network-wide */
+#define HCK_MOD_TSCH_RX_SKIP                                0 /* skip idle Rx cells of the unicast slotframe on a schedule the sender derives from its last ACK, must be set network-wide */
+#define HCK_MOD_TSCH_ADAPTIVE_EB                            0 /* trickle-style EB output: reset on join activity, suppressed when enough EBs are heard */
+#define HCK_MOD_TSCH_LOCKFREE_HANDOFF                       0 /* barrier-ordered ringbufindex, and offload attribute changes of queued packets applied by slot operation instead of skipped under the TSCH lock */
+//
+#define HCK_MOD_QUEUEBUF_SLAB_POOL                          0 /* size-classed queuebuf data slabs, TSCH sent callbacks get attributes only */
+#define HCK_MOD_TRICKLE_SHARED_SCHEDULER                    0 /* RPL DIO and trickle-timer (MPL) expiries served by one shared ctimer in batches */
+#define HCK_MOD_ETIMER_WHEEL                                0 /* hashed timer wheel backend for etimer (and ctimer), see examples/benchmarks/etimer-wheel */
+#define HCK_MOD_PROCESS_PRIORITY                            0 /* per-class event queues (MAC > NET > APP > LOG) with aging and latency stats */
+#define HCK_MOD_COFFEE_NAME_INDEX                           0 /* RAM name-hash index of Coffee files with end hints, see examples/benchmarks/coffee-index */
+#define HCK_MOD_COFFEE_INCREMENTAL_GC                       0 /* Coffee GC in a background process with bounded steps and cached sector status, see examples/benchmarks/coffee-gc */
+#define HCK_MOD_ANTELOPE_JOIN_ALGORITHMS                    0 /* Antelope hash join (spilling to CFS) and merge join for joins without an index, see examples/benchmarks/antelope-join */
+#define HCK_MOD_ANTELOPE_COMPILED_PREDICATES                0 /* Antelope WHERE clauses compiled once per query into folded range plans, rows filtered a page per call, see examples/benchmarks/antelope-select */
+#define HCK_MOD_ANTELOPE_BULK_INSERT                        0 /* Antelope db_bulk_begin/end sessions buffering inserted rows in RAM, appended and indexed a chunk at a time, see examples/benchmarks/antelope-bulk */
+#define HCK_MOD_COAP_RESOURCE_INDEX                         0 /* CoAP resources found through a URL hash index, observers listed per resource, see examples/benchmarks/coap-dispatch */
+#define HCK_MOD_COAP_PIPELINED_BLOCKWISE                    0 /* CoAP Block2 responses fetched through a window of pipelined requests, retransmission timeouts estimated per endpoint, see examples/benchmarks/coap-blockwise */
+#define HCK_MOD_COAP_NOTIFY_COALESCING                      0 /* CoAP notifications held until just before the next Tx cell towards the parent, superseded ones dropped, see examples/benchmarks/coap-notify */
+#define HCK_MOD_TCP_SOCKET_SEND_REF                         0 /* tcp_socket_send_ref(): TCP socket output streams reference application data instead of copying it into the output buffer */
+#define HCK_MOD_MQTT_ZERO_COPY_PUBLISH                      0 /* MQTT PUBLISH topic and payload referenced by the TCP socket instead of copied into the output buffer, requires HCK_MOD_TCP_SOCKET_SEND_REF, see examples/benchmarks/mqtt-publish */
+#define HCK_MOD_LWM2M_STREAMING_READ                        0 /* LwM2M reads serialized a resource at a time for each block, with all instances of an object in one document, see examples/benchmarks/lwm2m-read */
 //
 #if HCK_MOD_APP_SEQNO_DUPLICATE_CHECK
 #define APP_SEQNO_MAX_AGE                                   (20 * CLOCK_SECOND)
@@ -44,6 +70,108 @@
 #define NETSTACK_CONF_MAC_SEQNO_MAX_AGE                     (20 * CLOCK_SECOND)
 #define NETSTACK_CONF_MAC_SEQNO_HISTORY                     8
 #endif
+//
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+#define HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE             4
+#endif
+//
+#if HCK_MOD_RPL_CONTROL_SHAPER
+#define HCK_RPL_CONTROL_SHAPER_BCAST_QUEUE_THRESH           2 /* hold back DIOs while this many broadcast packets are queued */
+#define HCK_RPL_CONTROL_SHAPER_DAO_DEFER_DELAY              (CLOCK_SECOND)
+#define HCK_RPL_CONTROL_SHAPER_MAX_DAO_DEFERRALS            3
+#endif
+//
+#if HCK_MOD_RPL_DAO_AGGREGATION
+#define HCK_RPL_DAO_AGGREGATION_MAX_TARGETS                 3 /* keeps an aggregated DAO within a single 802.15.4 frame */
+#define HCK_RPL_DAO_AGGREGATION_WINDOW                      (CLOCK_SECOND)
+#endif
+//
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+#define HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL             (8 * CLOCK_SECOND)
+#define HCK_TSCH_LINK_BLACKLIST_EPOCH_SHIFT                 9 /* epoch of 512 timeslots */
+#define HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES                 3 /* children per EB */
+#define HCK_TSCH_LINK_BLACKLIST_RESYNC_EBS                  3 /* EB periods without an EB of the time source before a child drops its blacklist */
+#define HCK_TSCH_LINK_BLACKLIST_RESYNC_TX_FAILS             8 /* consecutive Tx failures to a child before a parent drops its blacklist */
+#endif
+//
+#if HCK_MOD_TSCH_RX_SKIP
+#define HCK_TSCH_RX_SKIP_IDLE_CYCLES                        8 /* idle slotframes per skip level */
+#define HCK_TSCH_RX_SKIP_MAX_LEVEL                          2 /* listen at least every 2^2 slotframes */
+#endif
+//
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+#define HCK_TSCH_ADAPTIVE_EB_IMIN                           (CLOCK_SECOND) /* Imax is the current EB period */
+#define HCK_TSCH_ADAPTIVE_EB_K                              3 /* redundancy constant */
+#endif
+//
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+#define HCK_TSCH_CONF_REQUEST_QUEUE_LEN                     8 /* power of two */
+#endif
+//
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+#define HCK_QUEUEBUF_SMALL_SLAB_SIZE                        64 /* EB, keepalive and most RPL control frames fit */
+#define HCK_QUEUEBUF_SMALL_SLAB_NUM                         QUEUEBUF_NUM
+#define HCK_QUEUEBUF_FULL_SLAB_NUM                          (QUEUEBUF_NUM / 2)
+#endif
+//
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+#define HCK_TRICKLE_SCHED_CONF_BATCH_TICKS                  (CLOCK_SECOND / 8) /* expiries this close fire in one wake-up */
+#endif
+//
+#if HCK_MOD_ETIMER_WHEEL
+#define HCK_ETIMER_CONF_WHEEL_SLOTS                         64 /* power of two, at most 256 */
+#endif
+//
+#if HCK_MOD_PROCESS_PRIORITY
+#define HCK_PROCESS_PRIO_CONF_NUMEVENTS                     16 /* event queue size of each class */
+#define HCK_PROCESS_PRIO_CONF_MAX_SKIPS                     8 /* bound on events of higher classes served ahead of a waiting class */
+#endif
+//
+#if HCK_MOD_COFFEE_NAME_INDEX
+#define HCK_COFFEE_NAME_INDEX_CONF_SIZE                     32 /* files beyond this are found by a flash scan */
+#endif
+//
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+#define HCK_COFFEE_GC_CONF_STEP_BUDGET                      (RTIMER_SECOND / 500) /* a step exceeds it by at most one sector erase */
+#define HCK_COFFEE_GC_CONF_LOW_WATERMARK                    (2 * COFFEE_PAGES_PER_SECTOR) /* pages left after an allocation that start a sweep */
+#endif
+//
+#if HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
+#define HCK_ANTELOPE_JOIN_CONF_HASH_ENTRIES                 64 /* keys of the right relation held in RAM at a time */
+#define HCK_ANTELOPE_JOIN_CONF_HASH_BUCKETS                 16 /* power of two */
+#define HCK_ANTELOPE_JOIN_CONF_MAX_PARTITIONS               8 /* CFS spill partitions, larger ones are joined in chunks */
+#endif
+//
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+#define HCK_ANTELOPE_PLAN_CONF_STEPS                        16 /* steps of a compiled predicate, longer ones are interpreted */
+#define HCK_ANTELOPE_SELECT_CONF_BATCH_SIZE                 256 /* bytes of rows read per selection step */
+#endif
+//
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+#define HCK_ANTELOPE_BULK_CONF_BUFFER_SIZE                  256 /* bytes of rows buffered before an append, rows lost on a reset at most */
+#endif
+//
+#if HCK_MOD_COAP_RESOURCE_INDEX
+#define HCK_COAP_RESOURCE_INDEX_CONF_BUCKETS                16 /* power of two */
+#endif
+//
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+#define HCK_COAP_BLOCK_CONF_WINDOW                          4 /* blocks requested at once, buffering up to one less out of order */
+#define HCK_COAP_RTO_CONF_ENTRIES                           4 /* endpoints with a retransmission timeout estimate */
+#endif
+//
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+#define HCK_COAP_NOTIFY_CONF_DELAY                          250 /* msec, longest hold of a notification, and the hold without TSCH */
+#define HCK_COAP_NOTIFY_CONF_QUEUE_RESERVE                  2 /* queue buffers left to relayed packets */
+#endif
+//
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+#define HCK_TCP_SOCKET_CONF_SEGMENTS                        8 /* referenced and buffered pieces of a TCP socket output stream */
+#endif
+//
+#if HCK_MOD_LWM2M_STREAMING_READ
+#define HCK_LWM2M_OBJECT_INDEX_CONF_BUCKETS                 8 /* hash buckets of the LwM2M object registry, on the object ID */
+#endif
 
 
 /***************************************************************
@@ -57,6 +185,8 @@
 #define HCK_LOG_TSCH_SLOT                                   1
 #define HCK_LOG_TSCH_SLOT_APP_SEQNO                         1
 #define HCK_LOG_TSCH_SLOT_RX_OPERATION                      0
+#define HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING              0 /* rtimer ticks spent in shared-cell packet selection and policy dispatch */
+#define HCK_LOG_TSCH_SLOT_ENERGY                            0 /* cells and energest radio time per slotframe handle and cell outcome, requires simple-energest */
 //
 #define SIMPLE_ENERGEST_CONF_PERIOD                         (1 * 60 * CLOCK_SECOND)
 #define RPL_FIRST_MEASURE_PERIOD                            (1 * 60)
@@ -325,6 +455,7 @@
 #define TSCH_DBT_HANDLE_MISSED_DBT_SLOT                     1
 #define TSCH_DBT_HOLD_CURRENT_NBR                           1
 #define TSCH_DBT_QUEUE_AWARENESS                            1
+#define TSCH_DBT_MULTI_CELL_RESERVATION                     0 /* negotiate the burst length in the header IE and reserve all its cells at once, must be set network-wide */
 //
 #if WITH_ALICE
 #undef TSCH_SCHEDULE_CONF_MAX_LINKS
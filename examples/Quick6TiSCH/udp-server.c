@@ -188,8 +188,10 @@ reset_eval(uint8_t phase)
 static void
 print_log()
 {
+  print_log_sicslowpan();
   print_log_tsch();
   print_log_rpl_timers();
+  print_log_rpl_dag();
   print_log_rpl();
   print_log_simple_energest();
 }
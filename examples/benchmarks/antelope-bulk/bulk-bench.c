@@ -0,0 +1,220 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of a root logging the packets of its network
+ *         into an Antelope relation: NODES nodes sending PACKETS packets
+ *         per minute for MINUTES minutes, with a max-heap index on the
+ *         node and an inline index on the time stamp.
+ *         The log is flushed once per simulated minute, and checked
+ *         afterwards through both indexes and a full scan.
+ *         Build with BULK=0 to insert one row per query.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "index.h"
+#include "dev/xmem.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define NODES   83
+#define PACKETS 4
+#ifndef MINUTES
+#define MINUTES 10
+#endif
+#define ROWS    (NODES * PACKETS * MINUTES)
+
+static uint16_t row_rssi[ROWS];
+
+extern unsigned long flash_emu_reads;
+extern unsigned long flash_emu_writes;
+extern unsigned long flash_emu_write_bytes;
+
+PROCESS(bulk_bench_process, "Antelope bulk insertion benchmark");
+AUTOSTART_PROCESSES(&bulk_bench_process);
+
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check(const char *name, const char *query, unsigned long expected_rows,
+      long expected_sum)
+{
+  static db_handle_t handle;
+  attribute_value_t value;
+  db_result_t result;
+  unsigned long rows;
+  long sum;
+  uint64_t t0;
+
+  rows = 0;
+  sum = 0;
+  t0 = now_ns();
+  result = db_query(&handle, query);
+  while(!DB_ERROR(result) && db_processing(&handle)) {
+    result = db_process(&handle);
+    if(result == DB_GOT_ROW) {
+      rows++;
+      db_get_value(&value, &handle, 0);
+      sum += db_value_to_long(&value);
+    } else if(result == DB_FINISHED) {
+      break;
+    }
+  }
+  if(DB_ERROR(result)) {
+    printf("%s failed: %s\n", name, db_get_result_message(result));
+  }
+  db_free(&handle);
+
+  printf("%8s %8lu %10ld %10lu%s\n", name, rows, sum,
+         (unsigned long)((now_ns() - t0) / 1000),
+         rows == expected_rows && sum == expected_sum ? "" : " MISMATCH");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(bulk_bench_process, ev, data)
+{
+  static db_handle_t handle;
+  char buf[AQL_MAX_QUERY_LENGTH];
+  unsigned long reads, writes, write_bytes;
+  unsigned long expected_rows;
+  long expected_sum;
+  uint64_t t0, elapsed;
+  db_result_t result;
+  unsigned minute, i, row;
+
+  PROCESS_BEGIN();
+
+  xmem_init();
+  db_init();
+
+  db_query(&handle, "CREATE RELATION log;");
+  db_query(&handle, "CREATE ATTRIBUTE node DOMAIN INT IN log;");
+  db_query(&handle, "CREATE ATTRIBUTE rssi DOMAIN INT IN log;");
+  db_query(&handle, "CREATE ATTRIBUTE stamp DOMAIN LONG IN log;");
+  db_query(&handle, "CREATE INDEX log.node TYPE MAXHEAP;");
+  db_query(&handle, "CREATE INDEX log.stamp TYPE INLINE;");
+
+  printf("Antelope bulk insertion benchmark, %u nodes, %u packets/min, "
+         "%u minutes, %s\n", NODES, PACKETS, MINUTES,
+         HCK_MOD_ANTELOPE_BULK_INSERT ? "bulk" : "single rows");
+
+  reads = flash_emu_reads;
+  writes = flash_emu_writes;
+  write_bytes = flash_emu_write_bytes;
+  elapsed = 0;
+
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  result = db_bulk_begin("log");
+  if(DB_ERROR(result)) {
+    printf("db_bulk_begin failed: %s\n", db_get_result_message(result));
+  }
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
+  for(minute = 0, row = 0; minute < MINUTES; minute++) {
+    for(i = 0; i < NODES * PACKETS; i++, row++) {
+      row_rssi[row] = random_rand() % 100;
+      snprintf(buf, sizeof(buf), "INSERT (%u, %u, %u) INTO log;",
+               row % NODES, row_rssi[row], row);
+      t0 = now_ns();
+      result = db_query(&handle, buf);
+      elapsed += now_ns() - t0;
+      if(DB_ERROR(result)) {
+        printf("\"%s\" failed: %s\n", buf, db_get_result_message(result));
+      }
+    }
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+    /* Lose at most a minute of the log on a reset. */
+    t0 = now_ns();
+    db_bulk_flush();
+    elapsed += now_ns() - t0;
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+  }
+
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  db_bulk_end();
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
+  printf("%u rows inserted in %lu us (%lu ns/row), %lu flash writes "
+         "(%lu bytes), %lu flash reads\n", ROWS,
+         (unsigned long)(elapsed / 1000), (unsigned long)(elapsed / ROWS),
+         flash_emu_writes - writes, flash_emu_write_bytes - write_bytes,
+         flash_emu_reads - reads);
+
+  printf("%8s %8s %10s %10s\n", "query", "tuples", "sum", "us");
+
+  /* Every node's packets, through the max-heap index. */
+  expected_rows = 0;
+  expected_sum = 0;
+  for(row = 0; row < ROWS; row++) {
+    if(row % NODES == 7) {
+      expected_rows++;
+      expected_sum += row;
+    }
+  }
+  check("node", "SELECT stamp, node FROM log WHERE node = 7;",
+        expected_rows, expected_sum);
+
+  /* The last minute, through the inline index. */
+  expected_rows = 0;
+  expected_sum = 0;
+  for(row = ROWS - NODES * PACKETS; row < ROWS; row++) {
+    expected_rows++;
+    expected_sum += row_rssi[row];
+  }
+  snprintf(buf, sizeof(buf), "SELECT rssi, stamp FROM log WHERE stamp >= %u AND stamp < %u;",
+           ROWS - NODES * PACKETS, ROWS);
+  check("minute", buf, expected_rows, expected_sum);
+
+  /* Everything, scanning the relation. */
+  expected_rows = 0;
+  expected_sum = 0;
+  for(row = 0; row < ROWS; row++) {
+    if(row_rssi[row] >= 90) {
+      expected_rows++;
+      expected_sum += row_rssi[row];
+    }
+  }
+  check("scan", "SELECT rssi FROM log WHERE rssi >= 90;",
+        expected_rows, expected_sum);
+
+  printf("Antelope bulk insertion benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,180 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of Antelope joins of sensor readings with a
+ *         node table: index joins, a merge join of sorted relations,
+ *         and a hash join with a node table that fits in the hash table
+ *         and one that spills to CFS. Every reading matches one node, so
+ *         each join must return one tuple per reading, with the room of
+ *         its node.
+ *         Build with JOINS=0 to run the index join only.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define READINGS 1000
+
+static uint16_t reading_node[READINGS];
+
+PROCESS(join_bench_process, "Antelope join benchmark");
+AUTOSTART_PROCESSES(&join_bench_process);
+
+struct join_case {
+  const char *name;
+  uint16_t nodes;
+  uint8_t sorted;
+  uint8_t indexed;
+};
+
+static const struct join_case cases[] = {
+  { "index", 50, 0, 1 },
+  { "index", 400, 0, 1 },
+  { "merge", 50, 1, 0 },
+  { "hash", 50, 0, 0 },
+  { "hash-spill", 400, 0, 0 },
+};
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static db_result_t
+query(const char *format, unsigned a, unsigned b)
+{
+  static db_handle_t handle;
+  char buf[AQL_MAX_QUERY_LENGTH];
+  db_result_t result;
+
+  snprintf(buf, sizeof(buf), format, a, b);
+  result = db_query(&handle, buf);
+  if(DB_ERROR(result)) {
+    printf("\"%s\" failed: %s\n", buf, db_get_result_message(result));
+  }
+  return result;
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_relations(const struct join_case *c)
+{
+  unsigned i;
+
+  query("REMOVE RELATION readings;", 0, 0);
+  query("REMOVE RELATION nodes;", 0, 0);
+  /* Start every case from an empty flash */
+  cfs_coffee_format();
+  query("CREATE RELATION readings;", 0, 0);
+  query("CREATE ATTRIBUTE node DOMAIN INT IN readings;", 0, 0);
+  query("CREATE ATTRIBUTE value DOMAIN INT IN readings;", 0, 0);
+  query("CREATE RELATION nodes;", 0, 0);
+  query("CREATE ATTRIBUTE node DOMAIN INT IN nodes;", 0, 0);
+  query("CREATE ATTRIBUTE room DOMAIN INT IN nodes;", 0, 0);
+  if(c->indexed) {
+    query("CREATE INDEX nodes.node TYPE MAXHEAP;", 0, 0);
+  }
+
+  for(i = 0; i < c->nodes; i++) {
+    query("INSERT (%u, %u) INTO nodes;", i, i / 10);
+  }
+  for(i = 0; i < READINGS; i++) {
+    reading_node[i] = c->sorted ? i * c->nodes / READINGS :
+                      random_rand() % c->nodes;
+    query("INSERT (%u, %u) INTO readings;", reading_node[i], i);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(join_bench_process, ev, data)
+{
+  static db_handle_t handle;
+  static uint16_t s;
+  static unsigned long rows, wrong;
+  static uint64_t t0;
+  attribute_value_t value, room;
+  db_result_t result;
+
+  PROCESS_BEGIN();
+
+  xmem_init();
+  db_init();
+
+  printf("Antelope join benchmark, %u readings\n", READINGS);
+  printf("%12s %6s %10s %10s\n", "join", "nodes", "tuples", "us");
+
+  for(s = 0; s < sizeof(cases) / sizeof(cases[0]); s++) {
+    if(!HCK_MOD_ANTELOPE_JOIN_ALGORITHMS && !cases[s].indexed) {
+      continue;
+    }
+    load_relations(&cases[s]);
+
+    rows = wrong = 0;
+    t0 = now_ns();
+    result = db_query(&handle, "JOIN readings, nodes ON node PROJECT value, room;");
+    while(!DB_ERROR(result) && db_processing(&handle)) {
+      result = db_process(&handle);
+      if(result == DB_GOT_ROW) {
+        rows++;
+        db_get_value(&value, &handle, 0);
+        db_get_value(&room, &handle, 1);
+        if(db_value_to_long(&room) !=
+           reading_node[db_value_to_long(&value) % READINGS] / 10) {
+          wrong++;
+        }
+      } else if(result == DB_FINISHED) {
+        break;
+      }
+    }
+    t0 = now_ns() - t0;
+    if(DB_ERROR(result)) {
+      printf("%s join failed: %s\n", cases[s].name,
+             db_get_result_message(result));
+    }
+    db_free(&handle);
+
+    printf("%12s %6u %10lu %10lu%s\n", cases[s].name, cases[s].nodes, rows,
+           (unsigned long)(t0 / 1000),
+           rows == READINGS && wrong == 0 ? "" : " MISMATCH");
+  }
+
+  printf("Antelope join benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
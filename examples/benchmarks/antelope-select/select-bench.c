@@ -0,0 +1,227 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of Antelope selections over stored sensor
+ *         readings: range, equality, disjunctive, arithmetic and
+ *         aggregating WHERE clauses scanning the relation, and one
+ *         narrowed by an inline index on the time stamps.
+ *         Each query's tuple count and value sum are checked against
+ *         the readings kept in RAM.
+ *         Build with PLAN=0 to interpret the predicates per tuple.
+ */
+
+#include "contiki.h"
+#include "antelope.h"
+#include "index.h"
+#include "dev/xmem.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#ifndef READINGS
+#define READINGS 3000
+#endif
+#define ROUNDS   5
+
+static uint16_t reading_node[READINGS];
+static uint16_t reading_temp[READINGS];
+
+extern unsigned long flash_emu_reads;
+
+PROCESS(select_bench_process, "Antelope select benchmark");
+AUTOSTART_PROCESSES(&select_bench_process);
+
+struct select_case {
+  const char *name;
+  const char *query;
+  int (*match)(unsigned i);
+  /* The first projected attribute, summed over the result. */
+  long (*value)(unsigned i);
+  uint8_t aggregate;
+};
+
+static int range_match(unsigned i)
+{ return reading_temp[i] > 200 && reading_temp[i] < 300; }
+static int equal_match(unsigned i)
+{ return reading_node[i] == 7; }
+static int or_match(unsigned i)
+{ return reading_node[i] < 5 || reading_temp[i] >= 990; }
+static int arith_match(unsigned i)
+{ return reading_temp[i] * 2 > 1900; }
+static int index_match(unsigned i)
+{ return i >= 1000 && i < 1500 && reading_temp[i] > 500; }
+static int max_match(unsigned i)
+{ return reading_node[i] == 9; }
+static long temp_value(unsigned i)
+{ return reading_temp[i]; }
+static long stamp_value(unsigned i)
+{ return i; }
+
+static const struct select_case cases[] = {
+  { "range", "SELECT temp FROM readings WHERE temp > 200 AND temp < 300;",
+    range_match, temp_value, 0 },
+  { "equal", "SELECT stamp, node FROM readings WHERE node = 7;",
+    equal_match, stamp_value, 0 },
+  { "or",
+    "SELECT stamp, node, temp FROM readings WHERE node < 5 OR temp >= 990;",
+    or_match, stamp_value, 0 },
+  { "arith", "SELECT stamp, temp FROM readings WHERE temp * 2 > 1900;",
+    arith_match, stamp_value, 0 },
+  { "max", "SELECT MAX(temp) FROM readings WHERE node = 9;",
+    max_match, temp_value, 1 },
+  { "index",
+    "SELECT stamp, temp FROM readings WHERE stamp >= 1000 AND stamp < 1500 "
+    "AND temp > 500;",
+    index_match, stamp_value, 0 },
+};
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+load_readings(void)
+{
+  static db_handle_t handle;
+  char buf[AQL_MAX_QUERY_LENGTH];
+  unsigned i;
+
+  db_query(&handle, "CREATE RELATION readings;");
+  db_query(&handle, "CREATE ATTRIBUTE node DOMAIN INT IN readings;");
+  db_query(&handle, "CREATE ATTRIBUTE temp DOMAIN INT IN readings;");
+  db_query(&handle, "CREATE ATTRIBUTE stamp DOMAIN LONG IN readings;");
+
+  for(i = 0; i < READINGS; i++) {
+    reading_node[i] = random_rand() % 50;
+    reading_temp[i] = random_rand() % 1000;
+    snprintf(buf, sizeof(buf), "INSERT (%u, %u, %u) INTO readings;",
+             reading_node[i], reading_temp[i], i);
+    if(DB_ERROR(db_query(&handle, buf))) {
+      printf("\"%s\" failed\n", buf);
+    }
+  }
+
+  /* The readings are stored in time order. */
+  db_query(&handle, "CREATE INDEX readings.stamp TYPE INLINE;");
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(select_bench_process, ev, data)
+{
+  static db_handle_t handle;
+  static uint16_t s;
+  static uint8_t round;
+  static unsigned long rows, expected_rows, reads;
+  static long sum, expected_sum;
+  static uint64_t t0, elapsed;
+  static relation_t *rel;
+  attribute_value_t value;
+  db_result_t result;
+  unsigned i;
+
+  PROCESS_BEGIN();
+
+  xmem_init();
+  db_init();
+  load_readings();
+
+  /* Let the indexer load the index over the stored readings. */
+  rel = relation_load("readings");
+  while(!index_exists(relation_attribute_get(rel, "stamp"))) {
+    PROCESS_PAUSE();
+  }
+  relation_release(rel);
+
+  printf("Antelope select benchmark, %u readings, %s predicates\n",
+         READINGS, HCK_MOD_ANTELOPE_COMPILED_PREDICATES ?
+         "compiled" : "interpreted");
+  printf("%8s %8s %10s %10s %10s\n", "query", "tuples", "sum", "us",
+         "reads");
+
+  for(s = 0; s < sizeof(cases) / sizeof(cases[0]); s++) {
+    expected_rows = 0;
+    expected_sum = 0;
+    for(i = 0; i < READINGS; i++) {
+      if(cases[s].match(i)) {
+        expected_rows++;
+        if(cases[s].aggregate) {
+          if(cases[s].value(i) > expected_sum) {
+            expected_sum = cases[s].value(i);
+          }
+        } else {
+          expected_sum += cases[s].value(i);
+        }
+      }
+    }
+    if(cases[s].aggregate) {
+      expected_rows = 1;
+    }
+
+    elapsed = 0;
+    reads = flash_emu_reads;
+    for(round = 0; round < ROUNDS; round++) {
+      rows = 0;
+      sum = 0;
+      t0 = now_ns();
+      result = db_query(&handle, cases[s].query);
+      while(!DB_ERROR(result) && db_processing(&handle)) {
+        result = db_process(&handle);
+        if(result == DB_GOT_ROW) {
+          rows++;
+          db_get_value(&value, &handle, 0);
+          sum += db_value_to_long(&value);
+        } else if(result == DB_FINISHED) {
+          break;
+        }
+      }
+      elapsed += now_ns() - t0;
+      if(DB_ERROR(result)) {
+        printf("%s failed: %s\n", cases[s].name,
+               db_get_result_message(result));
+      }
+      db_free(&handle);
+    }
+
+    printf("%8s %8lu %10ld %10lu %10lu%s\n", cases[s].name, rows, sum,
+           (unsigned long)(elapsed / ROUNDS / 1000),
+           (flash_emu_reads - reads) / ROUNDS,
+           rows == expected_rows && sum == expected_sum ? "" : " MISMATCH");
+  }
+
+  printf("Antelope select benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,161 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of a CoAP Block2 transfer across an emulated
+ *         multi-hop path (see loop-net.c): a node pulls a DUMP_SIZE byte
+ *         diagnostics dump from a peer, with and without packet loss.
+ *         The peer is this node's own CoAP server, and every byte
+ *         received is checked.
+ *         Build with PIPE=0 for one block per round trip and the fixed
+ *         retransmission timeout.
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-callback-api.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+
+#define DUMP_SIZE 2048
+
+extern unsigned loop_net_loss_percent;
+extern unsigned long loop_net_sent;
+extern unsigned long loop_net_lost;
+
+PROCESS(block_bench_process, "CoAP blockwise benchmark");
+AUTOSTART_PROCESSES(&block_bench_process);
+
+static coap_callback_request_state_t request_state;
+static unsigned long received;
+static uint8_t corrupted;
+static coap_request_status_t final_status;
+
+/*---------------------------------------------------------------------------*/
+static uint8_t
+dump_byte(uint32_t offset)
+{
+  return (offset * 7 + (offset >> 8)) & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_dump_get_handler(coap_message_t *request, coap_message_t *response,
+                     uint8_t *buffer, uint16_t preferred_size,
+                     int32_t *offset)
+{
+  int32_t len;
+  int32_t i;
+
+  len = MIN(preferred_size, DUMP_SIZE - *offset);
+  if(len < 0) {
+    len = 0;
+  }
+  for(i = 0; i < len; i++) {
+    buffer[i] = dump_byte(*offset + i);
+  }
+  coap_set_payload(response, buffer, len);
+  *offset = *offset + len >= DUMP_SIZE ? -1 : *offset + len;
+}
+RESOURCE(res_dump, "title=\"Diagnostics dump\"", res_dump_get_handler,
+         NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+response_callback(coap_callback_request_state_t *callback_state)
+{
+  coap_request_state_t *state = &callback_state->state;
+  coap_message_t *response = state->response;
+  uint32_t offset;
+  uint16_t i;
+
+  switch(state->status) {
+  case COAP_REQUEST_STATUS_MORE:
+  case COAP_REQUEST_STATUS_RESPONSE:
+    offset = state->block_num * COAP_MAX_CHUNK_SIZE;
+    for(i = 0; i < response->payload_len; i++) {
+      if(response->payload[i] != dump_byte(offset + i)) {
+        corrupted = 1;
+      }
+    }
+    received += response->payload_len;
+    break;
+  default:
+    final_status = state->status;
+    process_poll(&block_bench_process);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(block_bench_process, ev, data)
+{
+  static const uint8_t losses[] = { 0, 5, 10 };
+  static coap_endpoint_t server;
+  static coap_message_t request[1];
+  static clock_time_t start;
+  static unsigned long sent, lost;
+  static uint8_t l;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  coap_activate_resource(&res_dump, "dump");
+  uip_ip6addr(&server.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  server.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+  printf("CoAP blockwise benchmark, %u bytes in %u byte blocks, %s\n",
+         DUMP_SIZE, COAP_MAX_CHUNK_SIZE,
+         HCK_MOD_COAP_PIPELINED_BLOCKWISE ? "pipelined" : "stop-and-wait");
+  printf("%6s %10s %10s %8s %8s %s\n", "loss", "ms", "bytes", "packets",
+         "lost", "status");
+
+  for(l = 0; l < sizeof(losses); l++) {
+    loop_net_loss_percent = losses[l];
+    sent = loop_net_sent;
+    lost = loop_net_lost;
+    received = 0;
+    corrupted = 0;
+
+    coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+    coap_set_header_uri_path(request, "dump");
+    start = clock_time();
+    coap_send_request(&request_state, &server, request, response_callback);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    printf("%5u%% %10lu %10lu %8lu %8lu %s\n", losses[l],
+           (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND),
+           received, loop_net_sent - sent, loop_net_lost - lost,
+           final_status == COAP_REQUEST_STATUS_FINISHED
+           && received == DUMP_SIZE && !corrupted ? "ok" : "FAILED");
+  }
+
+  printf("CoAP blockwise benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
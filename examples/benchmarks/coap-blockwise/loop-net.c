@@ -0,0 +1,147 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Network driver emulating a multi-hop path to a peer: every
+ *         packet sent takes the shared bottleneck for loop_net_spacing_ms,
+ *         arrives loop_net_delay_ms later, and is lost with a probability
+ *         of loop_net_loss_percent. A packet to the peer comes back with
+ *         its source and destination swapped, so this node answers its
+ *         own requests as if they came from the peer.
+ */
+
+#include "contiki.h"
+#include "net/netstack.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/tcpip.h"
+#include "lib/random.h"
+
+#include <string.h>
+
+#define QUEUE_SIZE 32
+
+struct frame {
+  clock_time_t due;
+  uint16_t len;
+  uint8_t data[UIP_BUFSIZE];
+};
+
+static struct frame queue[QUEUE_SIZE];
+static unsigned head, count;
+static clock_time_t link_free;
+static struct ctimer timer;
+
+unsigned loop_net_delay_ms = 40;
+unsigned loop_net_spacing_ms = 10;
+unsigned loop_net_loss_percent;
+unsigned long loop_net_sent;
+unsigned long loop_net_lost;
+
+static void deliver(void *ptr);
+/*---------------------------------------------------------------------------*/
+static void
+schedule(void)
+{
+  clock_time_t now = clock_time();
+
+  if(count > 0) {
+    ctimer_set(&timer, queue[head].due > now ? queue[head].due - now : 0,
+               deliver, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+deliver(void *ptr)
+{
+  uip_ipaddr_t addr;
+  struct frame *f;
+
+  while(count > 0 && queue[head].due <= clock_time()) {
+    f = &queue[head];
+    head = (head + 1) % QUEUE_SIZE;
+    count--;
+
+    memcpy(uip_buf, f->data, f->len);
+    uip_len = f->len;
+    /* The checksums stay valid, as the pseudo-header sum does not
+       depend on the order of the addresses. */
+    uip_ipaddr_copy(&addr, &UIP_IP_BUF->srcipaddr);
+    uip_ipaddr_copy(&UIP_IP_BUF->srcipaddr, &UIP_IP_BUF->destipaddr);
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &addr);
+    tcpip_input();
+  }
+  schedule();
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(void)
+{
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+output(const linkaddr_t *localdest)
+{
+  clock_time_t start;
+  struct frame *f;
+
+  if(uip_len == 0) {
+    return 0;
+  }
+
+  loop_net_sent++;
+  start = MAX(clock_time(), link_free);
+  link_free = start + loop_net_spacing_ms * CLOCK_SECOND / 1000;
+
+  if(count == QUEUE_SIZE || random_rand() % 100 < loop_net_loss_percent) {
+    loop_net_lost++;
+    return 0;
+  }
+
+  f = &queue[(head + count) % QUEUE_SIZE];
+  f->due = link_free + loop_net_delay_ms * CLOCK_SECOND / 1000;
+  f->len = uip_len;
+  memcpy(f->data, uip_buf, uip_len);
+  if(count++ == 0) {
+    schedule();
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+const struct network_driver loop_net_driver = {
+  "loop-net",
+  init,
+  input,
+  output
+};
+/*---------------------------------------------------------------------------*/
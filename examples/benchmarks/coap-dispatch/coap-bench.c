@@ -0,0 +1,182 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of CoAP resource dispatch and observe
+ *         notification: GET requests spread over a growing number of
+ *         per-neighbor diagnostic resources and a parent resource for
+ *         per-slotframe sub-resources, then notifications of every
+ *         resource with observers on an eighth of them.
+ *         The requests are fed to coap_receive() directly, and every
+ *         request and notification is checked to reach its handler.
+ *         Build with INDEX=0 to walk the resource and observer lists.
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define RESOURCES 512
+#define REQUESTS  16384
+#define OBSERVERS 64
+
+static coap_resource_t resources[RESOURCES];
+static char urls[RESOURCES][16];
+static unsigned long hits;
+static unsigned long parent_hits;
+
+PROCESS(coap_bench_process, "CoAP dispatch benchmark");
+AUTOSTART_PROCESSES(&coap_bench_process);
+
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_get_handler(coap_message_t *request, coap_message_t *response,
+                uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  hits++;
+  buffer[0] = '1';
+  coap_set_payload(response, buffer, 1);
+}
+/*---------------------------------------------------------------------------*/
+static void
+res_sf_get_handler(coap_message_t *request, coap_message_t *response,
+                   uint8_t *buffer, uint16_t preferred_size, int32_t *offset)
+{
+  parent_hits++;
+  buffer[0] = '2';
+  coap_set_payload(response, buffer, 1);
+}
+PARENT_RESOURCE(res_sf, "title=\"Slotframe cells\"", res_sf_get_handler,
+                NULL, NULL, NULL);
+/*---------------------------------------------------------------------------*/
+static void
+request(const coap_endpoint_t *ep, const char *url, int observe)
+{
+  static coap_message_t message[1];
+  static uint8_t buffer[COAP_MAX_PACKET_SIZE];
+  static uint16_t mid;
+  uint8_t token[2];
+
+  coap_init_message(message, COAP_TYPE_NON, COAP_GET, ++mid);
+  coap_set_header_uri_path(message, url);
+  if(observe) {
+    token[0] = ep->port >> 8;
+    token[1] = ep->port & 0xff;
+    coap_set_token(message, token, sizeof(token));
+    coap_set_header_observe(message, 0);
+  }
+  coap_receive(ep, buffer, coap_serialize_message(message, buffer));
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coap_bench_process, ev, data)
+{
+  static const unsigned stages[] = { 8, 64, RESOURCES };
+  static coap_endpoint_t ep;
+  static unsigned active;
+  char url[24];
+  unsigned long expected, expected_parent;
+  uint64_t t0, elapsed;
+  unsigned s, i, k;
+
+  PROCESS_BEGIN();
+
+  printf("CoAP dispatch benchmark, %s\n", HCK_MOD_COAP_RESOURCE_INDEX ?
+         "resource index" : "resource list");
+
+  uip_ip6addr(&ep.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  ep.port = UIP_HTONS(5683);
+
+  coap_activate_resource(&res_sf, "diag/sf");
+
+  printf("%10s %10s %10s\n", "resources", "ns/req", "handled");
+  for(s = 0, active = 0; s < sizeof(stages) / sizeof(stages[0]); s++) {
+    for(; active < stages[s]; active++) {
+      snprintf(urls[active], sizeof(urls[active]), "diag/nbr/%u", active);
+      resources[active].flags = IS_OBSERVABLE;
+      resources[active].get_handler = res_get_handler;
+      coap_activate_resource(&resources[active], urls[active]);
+    }
+
+    hits = parent_hits = 0;
+    expected = expected_parent = 0;
+    elapsed = 0;
+    for(k = 0; k < REQUESTS; k++) {
+      if(k % 16 == 0) {
+        snprintf(url, sizeof(url), "diag/sf/%u/cells", k % 7);
+        expected_parent++;
+      } else {
+        strcpy(url, urls[(k * 7919) % active]);
+        expected++;
+      }
+      t0 = now_ns();
+      request(&ep, url, 0);
+      elapsed += now_ns() - t0;
+    }
+
+    printf("%10u %10lu %10s\n", active,
+           (unsigned long)(elapsed / REQUESTS),
+           hits == expected && parent_hits == expected_parent ?
+           "ok" : "MISMATCH");
+  }
+
+  /* Observers from distinct clients on every eighth resource. */
+  for(i = 0; i < OBSERVERS; i++) {
+    ep.port = UIP_HTONS(6000 + i);
+    request(&ep, urls[(i * 8) % RESOURCES], 1);
+  }
+
+  hits = 0;
+  t0 = now_ns();
+  for(i = 0; i < RESOURCES; i++) {
+    coap_notify_observers(&resources[i]);
+  }
+  elapsed = now_ns() - t0;
+
+  printf("%u notifications of %u resources in %lu us (%lu ns/resource) %s\n",
+         (unsigned)hits, RESOURCES, (unsigned long)(elapsed / 1000),
+         (unsigned long)(elapsed / RESOURCES),
+         hits == OBSERVERS ? "ok" : "MISMATCH");
+
+  printf("CoAP dispatch benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
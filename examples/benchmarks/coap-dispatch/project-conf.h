@@ -0,0 +1,17 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+/* The IPv6 stack of this tree logs through the HCK macros. */
+#define HCK_LOG 1
+
+#define COAP_MAX_OBSERVERS                 64
+#define COAP_CONF_OBSERVER_URL_LEN         24
+/* Keep the notifications non-confirmable, so that they do not hold
+   transactions. */
+#define COAP_CONF_OBSERVE_REFRESH_INTERVAL 0
+
+/* The responses go nowhere; keep the per-packet logs out of the timing.
+   The HCK statistics are printed regardless of the log levels. */
+#define LOG_CONF_OUTPUT(...)               do { } while(0)
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,182 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of CoAP observe notifications: a node observes
+ *         SENSORS telemetry resources of a peer, which change at random
+ *         every UPDATE_INTERVAL_MS. The peer is this node's own CoAP
+ *         server across the emulated path of loop-net.c, which counts
+ *         the packets sent.
+ *         Build with COALESCE=0 for one notification per change.
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-observe.h"
+#include "coap-observe-client.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define SENSORS 4
+#define UPDATES 500
+#define UPDATE_INTERVAL_MS 20
+#define HISTORY 64
+
+extern unsigned long loop_net_sent;
+
+PROCESS(notify_bench_process, "CoAP notify benchmark");
+AUTOSTART_PROCESSES(&notify_bench_process);
+
+static unsigned values[SENSORS];
+static clock_time_t changed[SENSORS][HISTORY];
+static unsigned last_received[SENSORS];
+static unsigned long notifications;
+static unsigned long delay_sum;
+
+static void res_sensor_get_handler(coap_message_t *request,
+                                   coap_message_t *response, uint8_t *buffer,
+                                   uint16_t preferred_size, int32_t *offset);
+
+EVENT_RESOURCE(res_sensor0, "obs", res_sensor_get_handler, NULL, NULL,
+               NULL, NULL);
+EVENT_RESOURCE(res_sensor1, "obs", res_sensor_get_handler, NULL, NULL,
+               NULL, NULL);
+EVENT_RESOURCE(res_sensor2, "obs", res_sensor_get_handler, NULL, NULL,
+               NULL, NULL);
+EVENT_RESOURCE(res_sensor3, "obs", res_sensor_get_handler, NULL, NULL,
+               NULL, NULL);
+
+static coap_resource_t *const sensors[SENSORS] = {
+  &res_sensor0, &res_sensor1, &res_sensor2, &res_sensor3
+};
+static char *const urls[SENSORS] = {
+  "sensor/0", "sensor/1", "sensor/2", "sensor/3"
+};
+/*---------------------------------------------------------------------------*/
+static void
+res_sensor_get_handler(coap_message_t *request, coap_message_t *response,
+                       uint8_t *buffer, uint16_t preferred_size,
+                       int32_t *offset)
+{
+  const char *url;
+  int len;
+  int i;
+
+  len = coap_get_header_uri_path(request, &url);
+  i = len > 0 ? url[len - 1] - '0' : 0;
+  len = snprintf((char *)buffer, preferred_size, "%d %u", i, values[i]);
+  coap_set_header_content_format(response, TEXT_PLAIN);
+  coap_set_payload(response, buffer, len);
+}
+/*---------------------------------------------------------------------------*/
+static void
+notification_callback(coap_observee_t *obs, void *notification,
+                      coap_notification_flag_t flag)
+{
+  coap_message_t *message = notification;
+  char payload[16];
+  unsigned sensor, value;
+
+  if(flag != NOTIFICATION_OK && flag != OBSERVE_OK) {
+    printf("Observation failed: %d\n", flag);
+    return;
+  }
+
+  memcpy(payload, message->payload, MIN(message->payload_len,
+                                        sizeof(payload) - 1));
+  payload[MIN(message->payload_len, sizeof(payload) - 1)] = '\0';
+  if(sscanf(payload, "%u %u", &sensor, &value) != 2 || sensor >= SENSORS) {
+    return;
+  }
+
+  if(flag == NOTIFICATION_OK) {
+    notifications++;
+    delay_sum += clock_time() - changed[sensor][value % HISTORY];
+  }
+  last_received[sensor] = value;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(notify_bench_process, ev, data)
+{
+  static coap_endpoint_t server;
+  static struct etimer et;
+  static unsigned long sent;
+  static unsigned updates;
+  static uint8_t stale;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  uip_ip6addr(&server.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  server.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+  for(i = 0; i < SENSORS; i++) {
+    coap_activate_resource(sensors[i], urls[i]);
+    coap_obs_request_registration(&server, urls[i], notification_callback,
+                                  NULL);
+  }
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  printf("CoAP notify benchmark, %u sensors, %u changes every %u ms, %s\n",
+         SENSORS, UPDATES, UPDATE_INTERVAL_MS,
+         HCK_MOD_COAP_NOTIFY_COALESCING ? "coalesced" : "one per change");
+
+  sent = loop_net_sent;
+  for(updates = 0; updates < UPDATES; updates++) {
+    i = random_rand() % SENSORS;
+    values[i]++;
+    changed[i][values[i] % HISTORY] = clock_time();
+    coap_notify_observers(sensors[i]);
+
+    etimer_set(&et, UPDATE_INTERVAL_MS * CLOCK_SECOND / 1000);
+    PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+  }
+
+  etimer_set(&et, CLOCK_SECOND);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  stale = 0;
+  for(i = 0; i < SENSORS; i++) {
+    stale |= last_received[i] != values[i];
+  }
+  printf("%10s %10s %14s %s\n", "packets", "received", "avg delay ms",
+         "latest values");
+  printf("%10lu %10lu %14lu %s\n", loop_net_sent - sent, notifications,
+         notifications > 0 ? delay_sum * 1000 / CLOCK_SECOND / notifications
+                           : 0,
+         stale ? "STALE" : "ok");
+  printf("CoAP notify benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
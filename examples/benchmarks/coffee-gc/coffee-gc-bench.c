@@ -0,0 +1,153 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of Coffee garbage collection pauses: a log
+ *         rotation workload that keeps LIVE_FILES files on the flash,
+ *         creating a new one and removing the oldest in every round, and
+ *         yielding in between so that the background collector can run.
+ *         Reports the latency of the file operations and the collector
+ *         statistics, and checks the contents of the live files at the end. Build with GC=0 to collect inside reserve() only.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FILE_SIZE  4000
+#define DATA_SIZE  2000
+#define LIVE_FILES 100
+#define ROUNDS     2000
+
+PROCESS(coffee_gc_bench_process, "Coffee GC benchmark");
+AUTOSTART_PROCESSES(&coffee_gc_bench_process);
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+file_name(char *name, uint16_t i)
+{
+  snprintf(name, 16, "log%u", i);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_bench_process, ev, data)
+{
+  static char name[16];
+  static char buf[DATA_SIZE];
+  static uint16_t i;
+  static uint64_t t0, op_ns, total_ns, max_ns;
+  static unsigned long slow_ops, failures, corrupt;
+  static char check[DATA_SIZE];
+  int fd;
+
+  PROCESS_BEGIN();
+
+  printf("Coffee GC benchmark, collection %s\n",
+         HCK_MOD_COFFEE_INCREMENTAL_GC ? "incremental" : "synchronous");
+
+  xmem_init();
+  cfs_coffee_format();
+  memset(buf, 'x', sizeof(buf));
+
+  for(i = 0; i < ROUNDS; i++) {
+    t0 = now_ns();
+    if(i >= LIVE_FILES) {
+      file_name(name, i - LIVE_FILES);
+      cfs_remove(name);
+    }
+    file_name(name, i);
+    if(cfs_coffee_reserve(name, FILE_SIZE) < 0) {
+      failures++;
+    } else {
+      fd = cfs_open(name, CFS_WRITE);
+      cfs_write(fd, buf, sizeof(buf));
+      cfs_close(fd);
+    }
+    op_ns = now_ns() - t0;
+
+    total_ns += op_ns;
+    if(op_ns > max_ns) {
+      max_ns = op_ns;
+    }
+    /* Slower than an erase: the operation waited for a collection */
+    if(op_ns > FLASH_EMU_ERASE_US * 1000ULL) {
+      slow_ops++;
+    }
+
+    PROCESS_PAUSE();
+  }
+
+  /* The collector must not have touched the live files */
+  for(i = ROUNDS - LIVE_FILES; i < ROUNDS; i++) {
+    file_name(name, i);
+    fd = cfs_open(name, CFS_READ);
+    if(fd < 0 || cfs_read(fd, check, sizeof(check)) != sizeof(check) ||
+       memcmp(check, buf, sizeof(check)) != 0) {
+      corrupt++;
+    }
+    cfs_close(fd);
+  }
+
+  printf("rounds %u failures %lu corrupt files %lu\n", ROUNDS, failures,
+         corrupt);
+  printf("operation avg %lu us max %lu us, %lu ops over %u us\n",
+         (unsigned long)(total_ns / ROUNDS / 1000),
+         (unsigned long)(max_ns / 1000), slow_ops, FLASH_EMU_ERASE_US);
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  printf("sync runs %lu pause sum %lu max %lu (rtimer ticks)\n",
+         (unsigned long)cfs_coffee_gc_stats.sync_runs,
+         (unsigned long)cfs_coffee_gc_stats.sync_pause_sum,
+         (unsigned long)cfs_coffee_gc_stats.sync_pause_max);
+  printf("background sweeps %lu steps %lu erased %lu step max %lu\n",
+         (unsigned long)cfs_coffee_gc_stats.sweeps,
+         (unsigned long)cfs_coffee_gc_stats.steps,
+         (unsigned long)cfs_coffee_gc_stats.erased,
+         (unsigned long)cfs_coffee_gc_stats.step_pause_max);
+  printf("sector status cache hits %lu misses %lu\n",
+         (unsigned long)cfs_coffee_gc_stats.status_hits,
+         (unsigned long)cfs_coffee_gc_stats.status_misses);
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+
+  printf("Coffee GC benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
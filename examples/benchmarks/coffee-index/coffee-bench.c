@@ -0,0 +1,161 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of Coffee open latency as the file count grows:
+ *         opens of existing files in random order (so that most of them
+ *         miss the open-file cache) and opens of missing files, on the
+ *         host-file flash emulator. Build with INDEX=0 to measure the
+ *         flash-scanning lookup.
+ */
+
+#include "contiki.h"
+#include "cfs/cfs.h"
+#include "cfs/cfs-coffee.h"
+#include "dev/xmem.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FILE_SIZE   1000
+#define DATA_SIZE   300
+#define OPEN_ROUNDS 2000
+
+PROCESS(coffee_bench_process, "Coffee benchmark");
+AUTOSTART_PROCESSES(&coffee_bench_process);
+
+extern unsigned long flash_emu_reads;
+extern unsigned long flash_emu_read_bytes;
+
+static const uint16_t sizes[] = { 16, 64, 256, 512 };
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+static void
+file_name(char *name, uint16_t i)
+{
+  snprintf(name, 16, "f%u", i);
+}
+/*---------------------------------------------------------------------------*/
+/* Open and close a file, returning the open latency in nanoseconds */
+static uint64_t
+timed_open(const char *name, int expect_found)
+{
+  uint64_t t0;
+  int fd;
+
+  t0 = now_ns();
+  fd = cfs_open(name, CFS_READ);
+  t0 = now_ns() - t0;
+  if((fd >= 0) != expect_found) {
+    printf("unexpected open result for %s\n", name);
+  }
+  if(fd >= 0) {
+    cfs_close(fd);
+  }
+  return t0;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_bench_process, ev, data)
+{
+  static char name[16];
+  static char buf[DATA_SIZE];
+  static uint16_t s, i, n;
+  static uint64_t hit_ns, miss_ns;
+  static unsigned long hit_reads, hit_bytes, miss_reads;
+  int fd;
+
+  PROCESS_BEGIN();
+
+  printf("Coffee open benchmark, lookup %s\n",
+         HCK_MOD_COFFEE_NAME_INDEX ? "index" : "scan");
+  printf("%6s %12s %10s %12s %12s %10s\n", "files", "open ns",
+         "reads", "read bytes", "miss ns", "reads");
+
+  xmem_init();
+  memset(buf, 'x', sizeof(buf));
+
+  for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    n = sizes[s];
+    cfs_coffee_format();
+
+    for(i = 0; i < n; i++) {
+      file_name(name, i);
+      if(cfs_coffee_reserve(name, FILE_SIZE) < 0) {
+        printf("reserve of %s failed\n", name);
+        break;
+      }
+      fd = cfs_open(name, CFS_WRITE);
+      cfs_write(fd, buf, sizeof(buf));
+      cfs_close(fd);
+    }
+
+    /* One pass in order so that both variants start from known file ends */
+    for(i = 0; i < n; i++) {
+      file_name(name, i);
+      timed_open(name, 1);
+    }
+
+    hit_ns = 0;
+    flash_emu_reads = flash_emu_read_bytes = 0;
+    for(i = 0; i < OPEN_ROUNDS; i++) {
+      file_name(name, random_rand() % n);
+      hit_ns += timed_open(name, 1);
+    }
+    hit_reads = flash_emu_reads;
+    hit_bytes = flash_emu_read_bytes;
+
+    miss_ns = 0;
+    flash_emu_reads = 0;
+    for(i = 0; i < OPEN_ROUNDS; i++) {
+      file_name(name, n + i);
+      miss_ns += timed_open(name, 0);
+    }
+    miss_reads = flash_emu_reads;
+
+    printf("%6u %12lu %10lu %12lu %12lu %10lu\n", n,
+           (unsigned long)(hit_ns / OPEN_ROUNDS), hit_reads / OPEN_ROUNDS,
+           hit_bytes / OPEN_ROUNDS, (unsigned long)(miss_ns / OPEN_ROUNDS),
+           miss_reads / OPEN_ROUNDS);
+  }
+
+  printf("Coffee benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
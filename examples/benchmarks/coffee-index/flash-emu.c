@@ -0,0 +1,99 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Flash emulator for the Coffee benchmark: the xmem interface of
+ *         the native platform backed by a host file, so that every Coffee
+ *         page access costs a system call as it costs a bus transaction
+ *         on a real flash. Reads are counted for the benchmark report,
+ *         and FLASH_EMU_ERASE_US adds the latency of a sector erase.
+ */
+
+#include "contiki.h"
+#include "dev/xmem.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define FLASH_EMU_FILE "coffee-bench.flash"
+#define FLASH_EMU_SIZE (1024UL * 1024UL)
+
+#ifndef FLASH_EMU_ERASE_US
+#define FLASH_EMU_ERASE_US 0
+#endif
+
+static int fd = -1;
+unsigned long flash_emu_reads;
+unsigned long flash_emu_read_bytes;
+unsigned long flash_emu_writes;
+unsigned long flash_emu_write_bytes;
+/*---------------------------------------------------------------------------*/
+int
+xmem_pwrite(const void *buf, int size, unsigned long offset)
+{
+  flash_emu_writes++;
+  flash_emu_write_bytes += size;
+  return pwrite(fd, buf, size, offset);
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_pread(void *buf, int size, unsigned long offset)
+{
+  flash_emu_reads++;
+  flash_emu_read_bytes += size;
+  return pread(fd, buf, size, offset);
+}
+/*---------------------------------------------------------------------------*/
+int
+xmem_erase(long nbytes, unsigned long offset)
+{
+  static unsigned char zero[4096];
+  long done;
+
+  for(done = 0; done < nbytes; done += sizeof(zero)) {
+    pwrite(fd, zero, sizeof(zero), offset + done);
+  }
+  if(FLASH_EMU_ERASE_US > 0) {
+    usleep(FLASH_EMU_ERASE_US);
+  }
+  return nbytes;
+}
+/*---------------------------------------------------------------------------*/
+void
+xmem_init(void)
+{
+  fd = open(FLASH_EMU_FILE, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0 || ftruncate(fd, FLASH_EMU_SIZE) < 0) {
+    perror(FLASH_EMU_FILE);
+    exit(1);
+  }
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,141 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *         Native benchmark of the etimer backend: cost of insert, cancel,
+ *         poll (nothing due) and expiry with 10, 100 and 1000 pending
+ *         timers. Build with WHEEL=0 to measure the list-based etimer.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define MAX_TIMERS  1000
+#define POLL_ROUNDS 1000
+
+PROCESS(etimer_bench_process, "etimer benchmark");
+AUTOSTART_PROCESSES(&etimer_bench_process);
+
+static struct etimer timers[MAX_TIMERS];
+static const uint16_t sizes[] = { 10, 100, 1000 };
+/*---------------------------------------------------------------------------*/
+static uint64_t
+now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+/*---------------------------------------------------------------------------*/
+/* Far enough that nothing expires while measuring */
+static clock_time_t
+far_interval(void)
+{
+  return 60 * CLOCK_SECOND + random_rand() % (600 * CLOCK_SECOND);
+}
+/*---------------------------------------------------------------------------*/
+static void
+poll_etimer(void)
+{
+  process_post_synch(&etimer_process, PROCESS_EVENT_POLL, NULL);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_bench_process, ev, data)
+{
+  static uint16_t s, i, n, expired;
+  static uint64_t t0, insert_ns, cancel_ns, poll_ns, expire_ns;
+
+  PROCESS_BEGIN();
+
+  printf("etimer benchmark, backend %s\n",
+         HCK_MOD_ETIMER_WHEEL ? "wheel" : "list");
+
+  for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    n = sizes[s];
+
+    /* Insert and cancel */
+    t0 = now_ns();
+    for(i = 0; i < n; i++) {
+      etimer_set(&timers[i], far_interval());
+    }
+    insert_ns = now_ns() - t0;
+
+    t0 = now_ns();
+    for(i = 0; i < n; i++) {
+      etimer_stop(&timers[n - 1 - i]);
+    }
+    cancel_ns = now_ns() - t0;
+
+    /* Poll with n pending timers and nothing due */
+    for(i = 0; i < n; i++) {
+      etimer_set(&timers[i], far_interval());
+    }
+    t0 = now_ns();
+    for(i = 0; i < POLL_ROUNDS; i++) {
+      poll_etimer();
+      etimer_next_expiration_time();
+    }
+    poll_ns = now_ns() - t0;
+
+    /* Expiry: all n due now, served in batches bounded by the event queue */
+    for(i = 0; i < n; i++) {
+      etimer_set(&timers[i], 0);
+    }
+    expire_ns = 0;
+    expired = 0;
+    while(expired < n) {
+      t0 = now_ns();
+      poll_etimer();
+      expire_ns += now_ns() - t0;
+      /* Drain the timer events posted to us by this poll */
+      do {
+        process_poll(&etimer_bench_process);
+        PROCESS_YIELD();
+        if(ev == PROCESS_EVENT_TIMER) {
+          expired++;
+        }
+      } while(ev != PROCESS_EVENT_POLL);
+    }
+
+    printf("n %4u insert %5lu ns cancel %5lu ns poll %7lu ns expire %5lu ns\n",
+           n,
+           (unsigned long)(insert_ns / n),
+           (unsigned long)(cancel_ns / n),
+           (unsigned long)(poll_ns / POLL_ROUNDS),
+           (unsigned long)(expire_ns / n));
+  }
+
+  printf("etimer benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
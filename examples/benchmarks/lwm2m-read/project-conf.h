@@ -0,0 +1,20 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+/* The IPv6 stack of this tree logs through the HCK macros. */
+#define HCK_LOG 1
+
+/* A multi-hop path emulated in loop-net.c instead of tun. */
+#define NETSTACK_CONF_NETWORK              loop_net_driver
+#define UIP_CONF_ND6_AUTOFILL_NBR_CACHE    1
+
+#define COAP_MAX_CHUNK_SIZE                64
+#define COAP_MAX_OPEN_TRANSACTIONS         8
+
+/* The objects are read directly, no LwM2M server is involved. */
+#define LWM2M_ENGINE_CONF_USE_RD_CLIENT    0
+
+/* The HCK statistics are printed regardless of the log levels. */
+#define LOG_CONF_OUTPUT(...)               do { } while(0)
+
+#endif /* PROJECT_CONF_H_ */
@@ -0,0 +1,268 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of a bulk LwM2M read across an emulated
+ *         multi-hop path (see loop-net.c): a node reads all instances
+ *         of a TSCH neighbour statistics object from a peer, as JSON and
+ *         as TLV, with and without packet loss. The peer is this node's
+ *         own LwM2M engine, and the representation received is checked.
+ *         Build with STREAM=0 for the stateful read and one block per
+ *         round trip.
+ */
+
+#include "contiki.h"
+#include "coap-engine.h"
+#include "coap-callback-api.h"
+#include "lwm2m-engine.h"
+#include "lwm2m-tlv.h"
+#include "lib/random.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* A private object: one instance per neighbour, one resource per counter */
+#define STATS_OBJECT_ID   10241
+#define STATS_NEIGHBOURS  8
+#define STATS_COUNTERS    8
+
+#define EXPECTED_SIZE     2048
+
+extern unsigned loop_net_loss_percent;
+extern unsigned long loop_net_sent;
+extern unsigned long loop_net_lost;
+
+PROCESS(read_bench_process, "LwM2M read benchmark");
+AUTOSTART_PROCESSES(&read_bench_process);
+
+static const lwm2m_resource_id_t stats_resources[STATS_COUNTERS] = {
+  RO(0), RO(1), RO(2), RO(3), RO(4), RO(5), RO(6), RO(7)
+};
+static lwm2m_object_instance_t stats_instances[STATS_NEIGHBOURS];
+
+static coap_callback_request_state_t request_state;
+static uint8_t expected[EXPECTED_SIZE];
+static size_t expected_len;
+static unsigned long received;
+static uint8_t corrupted;
+static coap_request_status_t final_status;
+
+/*---------------------------------------------------------------------------*/
+static int32_t
+counter_value(uint16_t neighbour, uint16_t counter)
+{
+  /* Link metrics are negative, packet counters grow large */
+  return counter == 4 ? -60 - neighbour
+    : (int32_t)(neighbour + 1) * 1237 * (counter + 1) + counter;
+}
+/*---------------------------------------------------------------------------*/
+static lwm2m_status_t
+stats_callback(lwm2m_object_instance_t *object, lwm2m_context_t *ctx)
+{
+  if(ctx->level < 3 || ctx->operation != LWM2M_OP_READ) {
+    return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+  }
+  if(ctx->resource_id >= STATS_COUNTERS) {
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+  lwm2m_object_write_int(ctx, counter_value(object->instance_id,
+                                            ctx->resource_id));
+  return LWM2M_STATUS_OK;
+}
+/*---------------------------------------------------------------------------*/
+static void
+expect(const char *text)
+{
+  expected_len += snprintf((char *)&expected[expected_len],
+                           sizeof(expected) - expected_len, "%s", text);
+}
+/*---------------------------------------------------------------------------*/
+/* What the engine is expected to send for a read of the whole object */
+static void
+build_expected(unsigned format)
+{
+  char text[48];
+  uint8_t *tlv_start;
+  uint16_t i;
+  uint16_t r;
+
+  expected_len = 0;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(format == LWM2M_JSON) {
+    snprintf(text, sizeof(text), "{\"bn\":\"/%u/\",\"e\":[", STATS_OBJECT_ID);
+    expect(text);
+  }
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+  for(i = 0; i < STATS_NEIGHBOURS; i++) {
+    if(format == LWM2M_TLV) {
+      tlv_start = &expected[expected_len];
+      for(r = 0; r < STATS_COUNTERS; r++) {
+        expected_len += lwm2m_tlv_write_int32(LWM2M_TLV_TYPE_RESOURCE, r,
+                                              counter_value(i, r),
+                                              &expected[expected_len],
+                                              sizeof(expected) - expected_len);
+      }
+#if HCK_MOD_LWM2M_STREAMING_READ
+      {
+        /* Each instance is wrapped in an object instance TLV */
+        lwm2m_tlv_t tlv;
+        uint8_t header[8];
+        size_t header_len;
+        size_t len = &expected[expected_len] - tlv_start;
+
+        tlv.type = LWM2M_TLV_TYPE_OBJECT_INSTANCE;
+        tlv.value = NULL;
+        tlv.length = len;
+        tlv.id = i;
+        header_len = lwm2m_tlv_write(&tlv, header, sizeof(header));
+        memmove(tlv_start + header_len, tlv_start, len);
+        memcpy(tlv_start, header, header_len);
+        expected_len += header_len;
+      }
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+      continue;
+    }
+#if !HCK_MOD_LWM2M_STREAMING_READ
+    /* One document per instance */
+    snprintf(text, sizeof(text), "{\"bn\":\"/%u/%u/\",\"e\":[",
+             STATS_OBJECT_ID, i);
+    expect(text);
+#endif /* !HCK_MOD_LWM2M_STREAMING_READ */
+    for(r = 0; r < STATS_COUNTERS; r++) {
+#if HCK_MOD_LWM2M_STREAMING_READ
+      snprintf(text, sizeof(text), "%s{\"n\":\"%u/%u\",\"v\":%ld}",
+               i > 0 || r > 0 ? "," : "", i, r, (long)counter_value(i, r));
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
+      snprintf(text, sizeof(text), "%s{\"n\":\"%u\",\"v\":%ld}",
+               r > 0 ? "," : "", r, (long)counter_value(i, r));
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+      expect(text);
+    }
+#if !HCK_MOD_LWM2M_STREAMING_READ
+    expect("]}");
+#endif /* !HCK_MOD_LWM2M_STREAMING_READ */
+  }
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(format == LWM2M_JSON) {
+    expect("]}");
+  }
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_callback(coap_callback_request_state_t *callback_state)
+{
+  coap_request_state_t *state = &callback_state->state;
+  coap_message_t *response = state->response;
+  uint32_t offset;
+
+  switch(state->status) {
+  case COAP_REQUEST_STATUS_MORE:
+  case COAP_REQUEST_STATUS_RESPONSE:
+    offset = state->block_num * COAP_MAX_CHUNK_SIZE;
+    if(response->code != CONTENT_2_05
+       || offset + response->payload_len > expected_len
+       || memcmp(&expected[offset], response->payload,
+                 response->payload_len) != 0) {
+      corrupted = 1;
+    }
+    received += response->payload_len;
+    break;
+  default:
+    final_status = state->status;
+    process_poll(&read_bench_process);
+    break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(read_bench_process, ev, data)
+{
+  static const uint8_t losses[] = { 0, 5, 10 };
+  static const unsigned formats[] = { LWM2M_JSON, LWM2M_TLV };
+  static coap_endpoint_t server;
+  static coap_message_t request[1];
+  static clock_time_t start;
+  static unsigned long sent, lost;
+  static char path[8];
+  static uint8_t f;
+  static uint8_t l;
+  uint16_t i;
+
+  PROCESS_BEGIN();
+
+  random_init(1);
+  lwm2m_engine_init();
+  for(i = 0; i < STATS_NEIGHBOURS; i++) {
+    stats_instances[i].object_id = STATS_OBJECT_ID;
+    stats_instances[i].instance_id = i;
+    stats_instances[i].resource_ids = stats_resources;
+    stats_instances[i].resource_count = STATS_COUNTERS;
+    stats_instances[i].callback = stats_callback;
+    lwm2m_engine_add_object(&stats_instances[i]);
+  }
+  snprintf(path, sizeof(path), "%u", STATS_OBJECT_ID);
+  uip_ip6addr(&server.ipaddr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+  server.port = UIP_HTONS(COAP_DEFAULT_PORT);
+
+  printf("LwM2M read benchmark, %u x %u counters in %u byte blocks, %s\n",
+         STATS_NEIGHBOURS, STATS_COUNTERS, COAP_MAX_CHUNK_SIZE,
+         HCK_MOD_LWM2M_STREAMING_READ ? "streaming" : "stateful");
+  printf("%6s %6s %10s %10s %8s %8s %s\n", "format", "loss", "ms", "bytes",
+         "packets", "lost", "status");
+
+  for(f = 0; f < sizeof(formats) / sizeof(formats[0]); f++) {
+    build_expected(formats[f]);
+    for(l = 0; l < sizeof(losses); l++) {
+      loop_net_loss_percent = losses[l];
+      sent = loop_net_sent;
+      lost = loop_net_lost;
+      received = 0;
+      corrupted = 0;
+
+      coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+      coap_set_header_uri_path(request, path);
+      coap_set_header_accept(request, formats[f]);
+      start = clock_time();
+      coap_send_request(&request_state, &server, request, response_callback);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+      printf("%6s %5u%% %10lu %10lu %8lu %8lu %s\n",
+             formats[f] == LWM2M_JSON ? "json" : "tlv", losses[l],
+             (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND),
+             received, loop_net_sent - sent, loop_net_lost - lost,
+             final_status == COAP_REQUEST_STATUS_FINISHED
+             && received == expected_len && !corrupted ? "ok" : "FAILED");
+    }
+  }
+
+  printf("LwM2M read benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
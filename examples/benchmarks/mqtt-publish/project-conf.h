@@ -0,0 +1,15 @@
+#ifndef PROJECT_CONF_H_
+#define PROJECT_CONF_H_
+
+/* The IPv6 stack of this tree logs through the HCK macros. */
+#define HCK_LOG 1
+
+/* A path to the broker emulated in loop-net.c instead of tun. */
+#define NETSTACK_CONF_NETWORK              loop_net_driver
+#define UIP_CONF_ND6_AUTOFILL_NBR_CACHE    1
+#define UIP_CONF_TCP                       1
+
+/* The HCK statistics are printed regardless of the log levels. */
+#define LOG_CONF_OUTPUT(...)               do { } while(0)
+
+#endif /* PROJECT_CONF_H_ */
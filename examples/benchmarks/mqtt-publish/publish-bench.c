@@ -0,0 +1,278 @@
+/*
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \file
+ *         Native benchmark of MQTT publishing: a gateway relays telemetry
+ *         samples, each a sequence number followed by a sample body, to a
+ *         broker at QoS 1. The broker is a minimal one on this node,
+ *         across the emulated path of loop-net.c, and checks every byte
+ *         it gets.
+ *         Build with ZC=0 for the copying publish path.
+ */
+
+#include "contiki.h"
+#include "mqtt.h"
+#include "tcp-socket.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define BROKER_PORT 1883
+#define PUBLISHES 100
+#define TOPIC "gw/telemetry/relay"
+#define MAX_BODY 1000
+#define SEQ_LEN 4
+
+extern unsigned loop_net_delay_ms;
+extern unsigned loop_net_spacing_ms;
+extern unsigned long loop_net_sent;
+
+PROCESS(publish_bench_process, "MQTT publish benchmark");
+AUTOSTART_PROCESSES(&publish_bench_process);
+
+static struct mqtt_connection conn;
+static uint8_t body[MAX_BODY];
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+static struct mqtt_topic topic;
+static uint8_t seq[SEQ_LEN];
+static struct mqtt_iovec payload[2];
+#else
+static uint8_t packet[SEQ_LEN + MAX_BODY];
+#endif
+
+/* Broker side */
+static struct tcp_socket broker;
+static uint8_t broker_in[128];
+static uint8_t broker_out[64];
+static enum { FHDR, LENGTH, BODY } broker_state;
+static uint8_t fhdr;
+static uint32_t remaining, shift, pos;
+static uint16_t topic_len, mid;
+static uint8_t bad;
+static unsigned long received, corrupted;
+/*---------------------------------------------------------------------------*/
+static uint8_t
+body_byte(uint32_t i)
+{
+  return (i * 7 + 3) & 0xff;
+}
+/*---------------------------------------------------------------------------*/
+static void
+publish_byte(uint8_t b)
+{
+  uint32_t offset;
+
+  if(pos < 2) {
+    topic_len = (topic_len << 8) | b;
+  } else if(pos < 2 + topic_len) {
+    bad |= pos - 2 >= strlen(TOPIC) || TOPIC[pos - 2] != b;
+  } else if(pos < 2 + topic_len + 2) {
+    mid = (mid << 8) | b;
+  } else {
+    offset = pos - 2 - topic_len - 2;
+    if(offset < SEQ_LEN) {
+      bad |= b != ((received >> (8 * (SEQ_LEN - 1 - offset))) & 0xff);
+    } else {
+      bad |= b != body_byte(offset - SEQ_LEN);
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+packet_done(void)
+{
+  uint8_t reply[4];
+
+  switch(fhdr >> 4) {
+  case MQTT_FHDR_MSG_TYPE_CONNECT >> 4:
+    reply[0] = MQTT_FHDR_MSG_TYPE_CONNACK;
+    reply[1] = 2;
+    reply[2] = 0;
+    reply[3] = 0;
+    tcp_socket_send(&broker, reply, 4);
+    break;
+  case MQTT_FHDR_MSG_TYPE_PUBLISH >> 4:
+    corrupted += bad || topic_len != strlen(TOPIC);
+    received++;
+    reply[0] = MQTT_FHDR_MSG_TYPE_PUBACK;
+    reply[1] = 2;
+    reply[2] = mid >> 8;
+    reply[3] = mid & 0xff;
+    tcp_socket_send(&broker, reply, 4);
+    break;
+  case MQTT_FHDR_MSG_TYPE_PINGREQ >> 4:
+    reply[0] = MQTT_FHDR_MSG_TYPE_PINGRESP;
+    reply[1] = 0;
+    tcp_socket_send(&broker, reply, 2);
+    break;
+  }
+  broker_state = FHDR;
+}
+/*---------------------------------------------------------------------------*/
+static int
+broker_input(struct tcp_socket *s, void *ptr, const uint8_t *data, int len)
+{
+  int i;
+
+  for(i = 0; i < len; i++) {
+    switch(broker_state) {
+    case FHDR:
+      fhdr = data[i];
+      remaining = shift = 0;
+      broker_state = LENGTH;
+      break;
+    case LENGTH:
+      remaining |= (uint32_t)(data[i] & 0x7f) << shift;
+      shift += 7;
+      if(!(data[i] & 0x80)) {
+        pos = 0;
+        topic_len = mid = bad = 0;
+        broker_state = BODY;
+        if(remaining == 0) {
+          packet_done();
+        }
+      }
+      break;
+    case BODY:
+      if((fhdr >> 4) == MQTT_FHDR_MSG_TYPE_PUBLISH >> 4) {
+        publish_byte(data[i]);
+      }
+      if(++pos == remaining) {
+        packet_done();
+      }
+      break;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+broker_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
+{
+  if(event == TCP_SOCKET_CONNECTED) {
+    broker_state = FHDR;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+mqtt_event(struct mqtt_connection *m, mqtt_event_t event, void *data)
+{
+  if(event == MQTT_EVENT_CONNECTED || event == MQTT_EVENT_PUBACK) {
+    process_poll(&publish_bench_process);
+  } else if(event == MQTT_EVENT_DISCONNECTED) {
+    printf("Disconnected from the broker\n");
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+publish(uint32_t n, uint16_t body_len)
+{
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  seq[0] = n >> 24;
+  seq[1] = n >> 16;
+  seq[2] = n >> 8;
+  seq[3] = n;
+  payload[0].data = seq;
+  payload[0].len = SEQ_LEN;
+  payload[1].data = body;
+  payload[1].len = body_len;
+  mqtt_publish_sg(&conn, NULL, &topic, payload, 2, MQTT_QOS_LEVEL_1,
+                  MQTT_RETAIN_OFF);
+#else
+  packet[0] = n >> 24;
+  packet[1] = n >> 16;
+  packet[2] = n >> 8;
+  packet[3] = n;
+  memcpy(&packet[SEQ_LEN], body, body_len);
+  mqtt_publish(&conn, NULL, TOPIC, packet, SEQ_LEN + body_len,
+               MQTT_QOS_LEVEL_1, MQTT_RETAIN_OFF);
+#endif
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(publish_bench_process, ev, data)
+{
+  static const uint16_t sizes[] = { 60, 480, 1000 };
+  static struct etimer et;
+  static clock_time_t start;
+  static unsigned long sent, first;
+  static uint8_t s;
+  static int i;
+
+  PROCESS_BEGIN();
+
+  loop_net_delay_ms = 5;
+  loop_net_spacing_ms = 1;
+
+  for(i = 0; i < MAX_BODY; i++) {
+    body[i] = body_byte(i);
+  }
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  mqtt_topic_init(&topic, TOPIC);
+#endif
+
+  tcp_socket_register(&broker, NULL, broker_in, sizeof(broker_in),
+                      broker_out, sizeof(broker_out),
+                      broker_input, broker_event);
+  tcp_socket_listen(&broker, BROKER_PORT);
+
+  mqtt_register(&conn, &publish_bench_process, "gw", mqtt_event, 1024);
+  mqtt_connect(&conn, "fe80::1", BROKER_PORT, 60, 1);
+  PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL && mqtt_connected(&conn));
+  /* The CONNACK is reported before the connect exchange completes */
+  etimer_set(&et, CLOCK_SECOND / 10);
+  PROCESS_WAIT_EVENT_UNTIL(etimer_expired(&et));
+
+  printf("MQTT publish benchmark, %u QoS 1 publishes per size, %s\n",
+         PUBLISHES, HCK_MOD_MQTT_ZERO_COPY_PUBLISH ? "zero-copy" : "copying");
+  printf("%6s %10s %10s %10s %s\n", "bytes", "ms", "msg/s", "packets",
+         "status");
+
+  for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+    sent = loop_net_sent;
+    first = received;
+    corrupted = 0;
+    start = clock_time();
+    for(i = 0; i < PUBLISHES; i++) {
+      PROCESS_WAIT_UNTIL(mqtt_ready(&conn));
+      publish(received, sizes[s]);
+      PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+    }
+    printf("%6u %10lu %10lu %10lu %s\n", SEQ_LEN + sizes[s],
+           (unsigned long)((clock_time() - start) * 1000 / CLOCK_SECOND),
+           (unsigned long)(PUBLISHES * CLOCK_SECOND
+                           / MAX(clock_time() - start, 1)),
+           loop_net_sent - sent,
+           received - first == PUBLISHES && corrupted == 0 ? "ok" : "FAILED");
+  }
+
+  printf("MQTT publish benchmark done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -97,14 +97,21 @@ tcpip_handler(void)
       trickle_timer_inconsistency(&tt);
 
       /*
-       * Here tt.ct.etimer.timer.{start + interval} points to time t in the
-       * current interval. However, between t and I it points to the interval's
-       * end so if you're going to use this, do so with caution.
+       * Here tt.ct.etimer.timer.{start + interval} (tt.se.expiry with the
+       * shared trickle scheduler) points to time t in the current interval.
+       * However, between t and I it points to the interval's end so if
+       * you're going to use this, do so with caution.
        */
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+      PRINTF("At %lu: Trickle inconsistency. Scheduled TX for %lu\n",
+             (unsigned long)clock_time(),
+             (unsigned long)tt.se.expiry);
+#else
       PRINTF("At %lu: Trickle inconsistency. Scheduled TX for %lu\n",
              (unsigned long)clock_time(),
              (unsigned long)(tt.ct.etimer.timer.start +
                              tt.ct.etimer.timer.interval));
+#endif
     }
   }
   return;
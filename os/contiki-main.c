@@ -130,6 +130,9 @@ main(void)
   {
     uip_ds6_addr_t *lladdr;
     memcpy(&uip_lladdr.addr, &linkaddr_node_addr, sizeof(uip_lladdr.addr));
+#if HCK_MOD_PROCESS_PRIORITY
+    process_set_priority(&tcpip_process, PROCESS_PRIO_NET);
+#endif
     process_start(&tcpip_process, NULL);
 
     lladdr = uip_ds6_get_link_local(-1);
@@ -44,6 +44,9 @@
 
 #include <string.h>
 #include "lib/ringbufindex.h"
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+#include "sys/memory-barrier.h"
+#endif
 
 #if WITH_QUICK6 && QUICK6_CRITICALITY_BASED_PACKET_SELECTION
 /* Shift get_ptr of ring buffer */
@@ -82,6 +85,10 @@ ringbufindex_put(struct ringbufindex *r)
   if(((r->put_ptr - r->get_ptr) & r->mask) == r->mask) {
     return 0;
   }
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+  /* The element must be written before it is published to the consumer */
+  memory_barrier();
+#endif
   r->put_ptr = (r->put_ptr + 1) & r->mask;
   return 1;
 }
@@ -96,6 +103,10 @@ ringbufindex_peek_put(const struct ringbufindex *r)
   if(((r->put_ptr - r->get_ptr) & r->mask) == r->mask) {
     return -1;
   }
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+  /* The slot must be seen free before the producer writes to it */
+  memory_barrier();
+#endif
   return r->put_ptr;
 }
 /* Remove the first element and return its index */
@@ -116,6 +127,10 @@ ringbufindex_get(struct ringbufindex *r)
    */
   if(((r->put_ptr - r->get_ptr) & r->mask) > 0) {
     get_ptr = r->get_ptr;
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+    /* The element must be read before its slot is released to the producer */
+    memory_barrier();
+#endif
     r->get_ptr = (r->get_ptr + 1) & r->mask;
     return get_ptr;
   } else {
@@ -131,6 +146,10 @@ ringbufindex_peek_get(const struct ringbufindex *r)
      first one. If there are no bytes left, we return -1.
    */
   if(((r->put_ptr - r->get_ptr) & r->mask) > 0) {
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+    /* The element must be seen published before the consumer reads it */
+    memory_barrier();
+#endif
     return r->get_ptr;
   } else {
     return -1;
@@ -42,6 +42,15 @@
 
 #include "contiki.h"
 
+/*
+ * A ringbufindex is safe without locking between one producer (put side)
+ * and one consumer (get side) running in different contexts, e.g. an
+ * interrupt and a process. The producer writes the element at
+ * ringbufindex_peek_put() then calls ringbufindex_put(); the consumer reads
+ * the element at ringbufindex_peek_get() then calls ringbufindex_get().
+ * With HCK_MOD_TSCH_LOCKFREE_HANDOFF, these calls also issue the memory
+ * barriers that order the element accesses against the index updates.
+ */
 struct ringbufindex {
   uint8_t mask;
   /* These must be 8-bit quantities to avoid race conditions. */
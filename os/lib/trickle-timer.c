@@ -46,6 +46,9 @@
 #include "sys/ctimer.h"
 #include "sys/cc.h"
 #include "lib/random.h"
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+#include "lib/list.h"
+#endif
 /*---------------------------------------------------------------------------*/
 #define DEBUG 0
 
@@ -73,6 +76,116 @@ static clock_time_t loc_clock; /* A local, general-purpose placeholder */
 
 static void fire(void *ptr);
 static void double_interval(void *ptr);
+
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+#define tt_timer_set(tt, delay, f) trickle_sched_set(&(tt)->se, (delay), (f), (tt))
+#define tt_timer_start(tt)         (clock_time()) /* Entries are set relative to now */
+#define tt_timer_expiry(tt)        ((tt)->se.expiry)
+#else
+#define tt_timer_set(tt, delay, f) ctimer_set(&(tt)->ct, (delay), (f), (tt))
+#define tt_timer_start(tt)         ((tt)->ct.etimer.timer.start)
+#define tt_timer_expiry(tt)        ((tt)->ct.etimer.timer.start + \
+                                    (tt)->ct.etimer.timer.interval)
+#endif
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+/* Shared trickle scheduler: pending entries sorted by expiry, and the entries
+ * of the batch being served */
+LIST(sched_list);
+LIST(sched_batch);
+static struct ctimer sched_ct;
+struct trickle_sched_stats trickle_sched_stats;
+
+static void sched_run(void *ptr);
+/*---------------------------------------------------------------------------*/
+/* Ticks until an entry expires, 0 if it is already due */
+static clock_time_t
+sched_left(const struct trickle_sched_entry *e, clock_time_t now)
+{
+  clock_time_t left = e->expiry - now;
+  return left > (TRICKLE_TIMER_CLOCK_MAX >> 1) ? 0 : left;
+}
+/*---------------------------------------------------------------------------*/
+/* Arm the shared ctimer for the earliest entry */
+static void
+sched_arm(void)
+{
+  struct trickle_sched_entry *head = list_head(sched_list);
+
+  if(head == NULL) {
+    ctimer_stop(&sched_ct);
+  } else {
+    ctimer_set(&sched_ct, sched_left(head, clock_time()), sched_run, NULL);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Serve every entry due within the batch window in one wake-up. Entries
+ * set again by their callback wait for the next wake-up. */
+static void
+sched_run(void *ptr)
+{
+  struct trickle_sched_entry *e;
+  clock_time_t now = clock_time();
+
+  trickle_sched_stats.wakeups++;
+
+  while((e = list_head(sched_list)) != NULL
+        && sched_left(e, now) <= HCK_TRICKLE_SCHED_BATCH_TICKS) {
+    list_remove(sched_list, e);
+    list_add(sched_batch, e);
+  }
+
+  while((e = list_pop(sched_batch)) != NULL) {
+    trickle_sched_stats.expiries++;
+    PROCESS_CONTEXT_BEGIN(e->p);
+    e->f(e->ptr);
+    PROCESS_CONTEXT_END(e->p);
+  }
+
+  sched_arm();
+}
+/*---------------------------------------------------------------------------*/
+void
+trickle_sched_set(struct trickle_sched_entry *e, clock_time_t delay,
+                  void (*f)(void *), void *ptr)
+{
+  struct trickle_sched_entry *prev = NULL;
+  struct trickle_sched_entry *cur;
+  clock_time_t now = clock_time();
+
+  list_remove(sched_list, e);
+  list_remove(sched_batch, e);
+
+  e->expiry = now + delay;
+  e->f = f;
+  e->ptr = ptr;
+  e->p = PROCESS_CURRENT();
+
+  for(cur = list_head(sched_list);
+      cur != NULL && sched_left(cur, now) <= delay;
+      cur = list_item_next(cur)) {
+    prev = cur;
+  }
+  if(prev == NULL) {
+    list_push(sched_list, e);
+    sched_arm();
+  } else {
+    list_insert(sched_list, prev, e);
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+trickle_sched_stop(struct trickle_sched_entry *e)
+{
+  int was_head = list_head(sched_list) == e;
+
+  list_remove(sched_list, e);
+  list_remove(sched_batch, e);
+  if(was_head) {
+    sched_arm();
+  }
+}
+#endif /* HCK_MOD_TRICKLE_SHARED_SCHEDULER */
 /*---------------------------------------------------------------------------*/
 /* Local utilities and functions to be used as ctimer callbacks */
 /*---------------------------------------------------------------------------*/
@@ -183,7 +296,7 @@ schedule_for_end(struct trickle_timer *tt)
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
 
-  ctimer_set(&tt->ct, loc_clock, double_interval, tt);
+  tt_timer_set(tt, loc_clock, double_interval);
 }
 /*---------------------------------------------------------------------------*/
 /* This is used as a ctimer callback, thus its argument must be void *. ptr is
@@ -233,7 +346,7 @@ double_interval(void *ptr)
     loc_clock = 0;
     PRINTF("trickle_timer doubling: Was in the past. Compensating\n");
   }
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
+  tt_timer_set(loctt, loc_clock, fire);
 
   /* Store the actual interval start (absolute time), we need it later.
    * We pretend that it started at the same time when the last one ended */
@@ -241,16 +354,15 @@ double_interval(void *ptr)
 #else
   /* Assumed that the previous interval's end is 'now' and schedule in t ticks
    * after 'now', ignoring potential offsets */
-  ctimer_set(&loctt->ct, loc_clock, fire, loctt);
+  tt_timer_set(loctt, loc_clock, fire);
   /* Store the actual interval start (absolute time), we need it later */
-  loctt->i_start = loctt->ct.etimer.timer.start;
+  loctt->i_start = tt_timer_start(loctt);
 #endif
 
   PRINTF("trickle_timer doubling: Last end %lu, new end %lu, for %lu, I=%lu\n",
          (unsigned long)last_end,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(loctt),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval),
+         (unsigned long)tt_timer_expiry(loctt),
          (unsigned long)(loctt->i_cur));
 }
 /*---------------------------------------------------------------------------*/
@@ -264,8 +376,7 @@ fire(void *ptr)
 
   PRINTF("trickle_timer fire: at %lu (was for %lu)\n",
          (unsigned long)clock_time(),
-         (unsigned long)(loctt->ct.etimer.timer.start +
-                         loctt->ct.etimer.timer.interval));
+         (unsigned long)tt_timer_expiry(loctt));
 
   if(loctt->cb) {
     /*
@@ -274,6 +385,13 @@ fire(void *ptr)
      */
     PRINTF("trickle_timer fire: Suppression Status %u (%u < %u)\n",
            TRICKLE_TIMER_PROTO_TX_ALLOW(loctt), loctt->c, loctt->k);
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+    if(TRICKLE_TIMER_PROTO_TX_ALLOW(loctt)) {
+      trickle_sched_stats.tx++;
+    } else {
+      trickle_sched_stats.suppressed++;
+    }
+#endif
     loctt->cb(loctt->cb_arg, TRICKLE_TIMER_PROTO_TX_ALLOW(loctt));
   }
 
@@ -292,10 +410,10 @@ new_interval(struct trickle_timer *tt)
   /* Random t in [I/2, I) */
   loc_clock = get_t(tt->i_cur);
 
-  ctimer_set(&tt->ct, loc_clock, fire, tt);
+  tt_timer_set(tt, loc_clock, fire);
 
   /* Store the actual interval start (absolute time), we need it later */
-  tt->i_start = tt->ct.etimer.timer.start;
+  tt->i_start = tt_timer_start(tt);
   PRINTF("trickle_timer new interval: at %lu, ends %lu, ",
          (unsigned long)clock_time(),
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt));
@@ -409,7 +527,7 @@ trickle_timer_set(struct trickle_timer *tt, trickle_timer_cb_t proto_cb,
   PRINTF("trickle_timer set: at %lu, ends %lu, t=%lu in [%lu , %lu)\n",
          (unsigned long)tt->i_start,
          (unsigned long)TRICKLE_TIMER_INTERVAL_END(tt),
-         (unsigned long)tt->ct.etimer.timer.interval,
+         (unsigned long)(tt_timer_expiry(tt) - tt->i_start),
          (unsigned long)tt->i_cur >> 1, (unsigned long)tt->i_cur);
 
   return TRICKLE_TIMER_SUCCESS;
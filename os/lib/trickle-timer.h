@@ -347,6 +347,59 @@
  */
 typedef void (* trickle_timer_cb_t)(void *ptr, uint8_t suppress);
 
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+/**
+ * \brief Expiries closer than this are served by the same wake-up of the
+ * shared trickle scheduler
+ */
+#ifdef HCK_TRICKLE_SCHED_CONF_BATCH_TICKS
+#define HCK_TRICKLE_SCHED_BATCH_TICKS HCK_TRICKLE_SCHED_CONF_BATCH_TICKS
+#else
+#define HCK_TRICKLE_SCHED_BATCH_TICKS (CLOCK_SECOND / 8)
+#endif
+
+/**
+ * \brief An entry of the shared trickle scheduler
+ *
+ * A one-shot callback, like a \ref ctimer. All entries are kept in a single
+ * list sorted by expiry and served by a single ctimer, so that entries due
+ * within ::HCK_TRICKLE_SCHED_BATCH_TICKS of each other fire in one batch.
+ * The callback runs in the context of the process that set the entry.
+ */
+struct trickle_sched_entry {
+  struct trickle_sched_entry *next;
+  clock_time_t expiry;
+  void (*f)(void *);
+  void *ptr;
+  struct process *p;
+};
+
+/** \brief Statistics of the shared trickle scheduler */
+struct trickle_sched_stats {
+  uint32_t wakeups;    /**< Times the shared ctimer expired */
+  uint32_t expiries;   /**< Entries served, over all wake-ups */
+  uint32_t tx;         /**< Trickle transmissions allowed (c < k) */
+  uint32_t suppressed; /**< Trickle transmissions suppressed (c >= k) */
+};
+extern struct trickle_sched_stats trickle_sched_stats;
+
+/**
+ * \brief      Set an entry of the shared trickle scheduler
+ * \param e    The entry, re-scheduled if already pending
+ * \param delay Ticks from now
+ * \param f    The callback
+ * \param ptr  The callback argument
+ */
+void trickle_sched_set(struct trickle_sched_entry *e, clock_time_t delay,
+                       void (*f)(void *), void *ptr);
+
+/**
+ * \brief      Cancel an entry of the shared trickle scheduler
+ * \param e    The entry, ignored if not pending
+ */
+void trickle_sched_stop(struct trickle_sched_entry *e);
+#endif /* HCK_MOD_TRICKLE_SHARED_SCHEDULER */
+
 /**
  * \struct trickle_timer
  *
@@ -370,7 +423,11 @@ struct trickle_timer {
                                Imin << Imax used internally, so that we can
                                have direct access to the maximum interval size
                                without having to calculate it all the time */
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+  struct trickle_sched_entry se; /**< Entry of the shared trickle scheduler */
+#else
   struct ctimer ct;       /**< A \ref ctimer used internally */
+#endif
   trickle_timer_cb_t cb;  /**< Protocol's own callback, invoked at time t
                                within the current interval */
   void *cb_arg;           /**< Opaque pointer to be used as the argument of the
@@ -448,10 +505,17 @@ uint8_t trickle_timer_set(struct trickle_timer *tt,
  * to reset a timer manually. Instead, in response to events or inconsistencies,
  * the corresponding functions must be used
  */
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+#define trickle_timer_stop(tt) do { \
+  trickle_sched_stop(&((tt)->se)); \
+  (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
+} while(0)
+#else
 #define trickle_timer_stop(tt) do { \
   ctimer_stop(&((tt)->ct)); \
   (tt)->i_cur = TRICKLE_TIMER_IS_STOPPED; \
 } while(0)
+#endif
 
 /**
  * \brief      To be called by the protocol when it hears a consistent
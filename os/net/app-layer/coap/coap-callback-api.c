@@ -83,11 +83,249 @@ progress_request(coap_callback_request_state_t *callback_state) {
   return 0;
 }
 
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+static int
+request_block(coap_callback_request_state_t *callback_state, uint32_t num)
+{
+  coap_request_state_t *state = &callback_state->state;
+  struct coap_block_request *req;
+  uint32_t block_num;
+  int sent;
+
+  for(req = callback_state->in_flight;
+      req < &callback_state->in_flight[HCK_COAP_BLOCK_WINDOW]; req++) {
+    if(!req->used) {
+      /* progress_request() asks for state->block_num. */
+      block_num = state->block_num;
+      state->block_num = num;
+      sent = progress_request(callback_state);
+      state->block_num = block_num;
+      if(sent) {
+        req->block_num = num;
+        req->mid = state->request->mid;
+        req->used = 1;
+      }
+      return sent;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+fill_window(coap_callback_request_state_t *callback_state)
+{
+  coap_request_state_t *state = &callback_state->state;
+  int i, in_flight;
+
+  for(i = in_flight = 0; i < HCK_COAP_BLOCK_WINDOW; i++) {
+    in_flight += callback_state->in_flight[i].used;
+  }
+
+  /* Blocks in flight and blocks waiting for earlier ones together stay
+     within the window, so that the latter always find a slot. */
+  while(in_flight < callback_state->window
+        && callback_state->next_block <= callback_state->last_block
+        && callback_state->next_block - state->block_num
+           < HCK_COAP_BLOCK_WINDOW
+        && request_block(callback_state, callback_state->next_block)) {
+    callback_state->next_block++;
+    in_flight++;
+  }
+
+  return in_flight;
+}
+/*---------------------------------------------------------------------------*/
+static void
+cancel_blocks(coap_callback_request_state_t *callback_state)
+{
+  coap_transaction_t *t;
+  int i;
+
+  for(i = 0; i < HCK_COAP_BLOCK_WINDOW; i++) {
+    if(callback_state->in_flight[i].used) {
+      t = coap_get_transaction_by_mid(callback_state->in_flight[i].mid);
+      if(t != NULL && t->callback_data == &callback_state->state) {
+        coap_clear_transaction(t);
+      }
+      callback_state->in_flight[i].used = 0;
+    }
+  }
+  for(i = 0; i < HCK_COAP_BLOCK_WINDOW - 1; i++) {
+    callback_state->early[i].used = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static struct coap_block_request *
+find_block_request(coap_callback_request_state_t *callback_state,
+                   coap_message_t *response)
+{
+  struct coap_block_request *req;
+  uint32_t num;
+
+  /* A piggybacked response carries the MID of its request. */
+  for(req = callback_state->in_flight;
+      req < &callback_state->in_flight[HCK_COAP_BLOCK_WINDOW]; req++) {
+    if(req->used && req->mid == response->mid) {
+      return req;
+    }
+  }
+  if(coap_get_header_block2(response, &num, NULL, NULL, NULL)) {
+    for(req = callback_state->in_flight;
+        req < &callback_state->in_flight[HCK_COAP_BLOCK_WINDOW]; req++) {
+      if(req->used && req->block_num == num) {
+        return req;
+      }
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+save_early_block(coap_callback_request_state_t *callback_state, uint32_t num,
+                 coap_message_t *response)
+{
+  struct coap_early_block *early;
+
+  for(early = callback_state->early;
+      early < &callback_state->early[HCK_COAP_BLOCK_WINDOW - 1]; early++) {
+    if(!early->used) {
+      early->block_num = num;
+      early->response = *response;
+      early->response.payload_len = MIN(response->payload_len,
+                                        sizeof(early->payload));
+      memcpy(early->payload, response->payload, early->response.payload_len);
+      early->response.payload = early->payload;
+      early->used = 1;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Hand the blocks that are due to the callback, in order. */
+static int
+deliver_blocks(coap_callback_request_state_t *callback_state,
+               coap_message_t *response)
+{
+  coap_request_state_t *state = &callback_state->state;
+  struct coap_early_block *early;
+
+  do {
+    state->more = 0;
+    coap_get_header_block2(response, NULL, &state->more, NULL, NULL);
+    state->response = response;
+    state->status = state->more ? COAP_REQUEST_STATUS_MORE
+                                : COAP_REQUEST_STATUS_RESPONSE;
+    callback_state->callback(callback_state);
+    ++(state->block_num);
+
+    if(state->block_num > callback_state->last_block) {
+      cancel_blocks(callback_state);
+      state->status = COAP_REQUEST_STATUS_FINISHED;
+      state->response = NULL;
+      callback_state->callback(callback_state);
+      return 1;
+    }
+
+    response = NULL;
+    for(early = callback_state->early;
+        early < &callback_state->early[HCK_COAP_BLOCK_WINDOW - 1]; early++) {
+      if(early->used && early->block_num == state->block_num) {
+        early->used = 0;
+        response = &early->response;
+        break;
+      }
+    }
+  } while(response != NULL);
+
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+pipelined_callback(coap_callback_request_state_t *callback_state,
+                   coap_message_t *response)
+{
+  coap_request_state_t *state = &callback_state->state;
+  struct coap_block_request *req;
+  uint32_t num;
+  uint8_t more;
+
+  state->response = response;
+
+  if(!state->response) {
+    LOG_WARN("Server not responding giving up...\n");
+    cancel_blocks(callback_state);
+    state->status = COAP_REQUEST_STATUS_TIMEOUT;
+    callback_state->callback(callback_state);
+    return;
+  }
+
+  req = find_block_request(callback_state, response);
+  if(req == NULL) {
+    return;
+  }
+  num = req->block_num;
+  req->used = 0;
+
+  state->res_block = 0;
+  more = 0;
+  coap_get_header_block2(response, &state->res_block, &more, NULL, NULL);
+
+  LOG_DBG("Received #%"PRIu32"%s for #%"PRIu32" (%u bytes), window %u\n",
+          state->res_block, more ? "+" : "", num, response->payload_len,
+          callback_state->window);
+
+  if(num > state->block_num && response->code >= BAD_REQUEST_4_00) {
+    /* Requested past the end of a resource that does not know its
+       size. */
+    callback_state->last_block = MIN(callback_state->last_block, num - 1);
+  } else if(state->res_block != num) {
+    LOG_WARN("WRONG BLOCK %"PRIu32"/%"PRIu32"\n", state->res_block, num);
+    if(++(state->block_error) >= COAP_MAX_ATTEMPTS) {
+      cancel_blocks(callback_state);
+      state->status = COAP_REQUEST_STATUS_BLOCK_ERROR;
+      callback_state->callback(callback_state);
+      return;
+    }
+    /* Fall back to one block at a time. */
+    cancel_blocks(callback_state);
+    callback_state->window = 1;
+    callback_state->next_block = state->block_num;
+  } else {
+    if(coap_transaction_last_retransmissions() > 0) {
+      callback_state->window = MAX(callback_state->window / 2, 1);
+    } else if(more && state->block_error == 0
+              && callback_state->window < HCK_COAP_BLOCK_WINDOW) {
+      callback_state->window++;
+    }
+    if(!more) {
+      callback_state->last_block = MIN(callback_state->last_block, num);
+    }
+
+    if(num > callback_state->last_block || num < state->block_num) {
+      /* Past the end or a duplicate. */
+    } else if(num > state->block_num) {
+      save_early_block(callback_state, num, response);
+    } else if(deliver_blocks(callback_state, response)) {
+      return;
+    }
+  }
+
+  if(fill_window(callback_state) == 0) {
+    /* Out of transactions: give up rather than stall. */
+    state->status = COAP_REQUEST_STATUS_BLOCK_ERROR;
+    callback_state->callback(callback_state);
+  }
+}
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 /*---------------------------------------------------------------------------*/
 
 static void
 coap_request_callback(void *callback_data, coap_message_t *response)
 {
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+  pipelined_callback((coap_callback_request_state_t *)callback_data, response);
+#else /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
   coap_callback_request_state_t *callback_state = (coap_callback_request_state_t*)callback_data;
   coap_request_state_t *state = &callback_state->state;
 
@@ -142,6 +380,7 @@ coap_request_callback(void *callback_data, coap_message_t *response)
     state->response = NULL;
     callback_state->callback(callback_state);
   }
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 }
 
 /*---------------------------------------------------------------------------*/
@@ -162,7 +401,17 @@ coap_send_request(coap_callback_request_state_t *callback_state, coap_endpoint_t
   state->remote_endpoint = endpoint;
   callback_state->callback = callback;
 
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+  memset(callback_state->in_flight, 0, sizeof(callback_state->in_flight));
+  memset(callback_state->early, 0, sizeof(callback_state->early));
+  callback_state->next_block = 0;
+  callback_state->last_block = UINT32_MAX;
+  /* Block 0 alone, until the server shows that it does Block2. */
+  callback_state->window = 1;
+  return fill_window(callback_state) > 0;
+#else /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
   return progress_request(callback_state);
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 }
 /*---------------------------------------------------------------------------*/
 /** @} */
@@ -55,9 +55,39 @@
 /*---------------------------------------------------------------------------*/
 typedef struct coap_callback_request_state coap_callback_request_state_t;
 
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+#ifdef HCK_COAP_BLOCK_CONF_WINDOW
+#define HCK_COAP_BLOCK_WINDOW HCK_COAP_BLOCK_CONF_WINDOW
+#else
+#define HCK_COAP_BLOCK_WINDOW 4
+#endif
+
+/* A Block2 request in flight. */
+struct coap_block_request {
+  uint32_t block_num;
+  uint16_t mid;
+  uint8_t used;
+};
+
+/* A block that arrived ahead of the ones before it. */
+struct coap_early_block {
+  uint32_t block_num;
+  coap_message_t response;
+  uint8_t payload[COAP_MAX_CHUNK_SIZE];
+  uint8_t used;
+};
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
+
 struct coap_callback_request_state {
   coap_request_state_t state;
   void (*callback)(coap_callback_request_state_t *state);
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+  struct coap_block_request in_flight[HCK_COAP_BLOCK_WINDOW];
+  struct coap_early_block early[HCK_COAP_BLOCK_WINDOW - 1];
+  uint32_t next_block;     /* the next block to request */
+  uint32_t last_block;     /* the final block, once known */
+  uint8_t window;          /* congestion window, in blocks */
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 };
 
 /**
@@ -67,6 +97,13 @@ struct coap_callback_request_state {
  * \param request The request to be sent
  * \param callback callback to execute when the response arrives or the timeout expires
  * \return 1 if there is a transaction available to send, 0 otherwise
+ *
+ * With HCK_MOD_COAP_PIPELINED_BLOCKWISE, a Block2 transfer keeps up to
+ * HCK_COAP_BLOCK_WINDOW blocks in flight once the server has answered
+ * block 0 with the More flag. The window grows by one block per block
+ * answered without a retransmission, halves on a retransmission, and
+ * falls back to one block if the server answers with blocks other than
+ * those requested. The callback still gets the blocks in order.
  */
 int coap_send_request(coap_callback_request_state_t *callback_state, coap_endpoint_t *endpoint,
                        coap_message_t *request,
@@ -72,6 +72,109 @@ LIST(coap_handlers);
 LIST(coap_resource_services);
 static uint8_t is_initialized = 0;
 
+#if HCK_MOD_COAP_RESOURCE_INDEX
+#ifdef HCK_COAP_RESOURCE_INDEX_CONF_BUCKETS
+#define HCK_COAP_RESOURCE_INDEX_BUCKETS HCK_COAP_RESOURCE_INDEX_CONF_BUCKETS
+#else
+#define HCK_COAP_RESOURCE_INDEX_BUCKETS 16 /* power of two */
+#endif
+
+/*
+ * Hash index of the activated resources by URL. A request is matched
+ * against its whole path and, if there are parent resources, against
+ * each prefix of it that ends before a '/'. As with the list walk, the
+ * resource activated first wins when several match.
+ */
+static coap_resource_t *resource_index[HCK_COAP_RESOURCE_INDEX_BUCKETS];
+static uint16_t resource_order;
+static uint8_t parent_resources;
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
+
+#if HCK_MOD_COAP_RESOURCE_INDEX
+/*---------------------------------------------------------------------------*/
+/*- Resource index ----------------------------------------------------------*/
+/*---------------------------------------------------------------------------*/
+static uint16_t
+url_hash_step(uint16_t hash, char c)
+{
+  return (hash << 5) + hash + (uint8_t)c;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_remove(coap_resource_t *resource)
+{
+  coap_resource_t **r;
+
+  if(resource->url == NULL) {
+    return;
+  }
+
+  for(r = &resource_index[resource->url_hash &
+                          (HCK_COAP_RESOURCE_INDEX_BUCKETS - 1)];
+      *r != NULL; r = &(*r)->index_next) {
+    if(*r == resource) {
+      *r = resource->index_next;
+      if(resource->flags & HAS_SUB_RESOURCES) {
+        parent_resources--;
+      }
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add(coap_resource_t *resource)
+{
+  coap_resource_t **bucket;
+  const char *c;
+
+  resource->url_len = 0;
+  resource->url_hash = 5381;
+  for(c = resource->url; *c != '\0'; c++) {
+    resource->url_hash = url_hash_step(resource->url_hash, *c);
+    resource->url_len++;
+  }
+  resource->index_order = resource_order++;
+
+  bucket = &resource_index[resource->url_hash &
+                           (HCK_COAP_RESOURCE_INDEX_BUCKETS - 1)];
+  resource->index_next = *bucket;
+  *bucket = resource;
+  if(resource->flags & HAS_SUB_RESOURCES) {
+    parent_resources++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static coap_resource_t *
+index_find(const char *url, int url_len)
+{
+  coap_resource_t *r;
+  coap_resource_t *found;
+  uint16_t hash;
+  int i;
+
+  found = NULL;
+  hash = 5381;
+  for(i = 0; i <= url_len; i++) {
+    if(i == url_len || (url[i] == '/' && parent_resources > 0)) {
+      for(r = resource_index[hash & (HCK_COAP_RESOURCE_INDEX_BUCKETS - 1)];
+          r != NULL; r = r->index_next) {
+        if(r->url_hash == hash && r->url_len == i
+           && (i == url_len || (r->flags & HAS_SUB_RESOURCES))
+           && (found == NULL || r->index_order < found->index_order)
+           && memcmp(r->url, url, i) == 0) {
+          found = r;
+        }
+      }
+    }
+    if(i < url_len) {
+      hash = url_hash_step(hash, url[i]);
+    }
+  }
+
+  return found;
+}
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
 /*---------------------------------------------------------------------------*/
 /*- CoAP service handlers---------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -308,6 +411,9 @@ coap_receive(const coap_endpoint_t *src,
       }
 
       if((transaction = coap_get_transaction_by_mid(message->mid))) {
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+        coap_transaction_acked(transaction);
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
         /* free transaction memory before callback, as it may create a new transaction */
         coap_resource_response_handler_t callback = transaction->callback;
         void *callback_data = transaction->callback_data;
@@ -399,7 +505,13 @@ void
 coap_activate_resource(coap_resource_t *resource, const char *path)
 {
   coap_periodic_resource_t *periodic;
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  index_remove(resource);
+  resource->url = path;
+  index_add(resource);
+#else /* HCK_MOD_COAP_RESOURCE_INDEX */
   resource->url = path;
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
   list_add(coap_resource_services, resource);
 
   LOG_INFO("Activating: %s\n", resource->url);
@@ -442,9 +554,16 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
 
   coap_resource_t *resource = NULL;
   const char *url = NULL;
-  int url_len, res_url_len;
+  int url_len;
+#if !HCK_MOD_COAP_RESOURCE_INDEX
+  int res_url_len;
+#endif /* !HCK_MOD_COAP_RESOURCE_INDEX */
 
   url_len = coap_get_header_uri_path(request, &url);
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  resource = index_find(url, url_len);
+  if(resource != NULL) {
+#else /* HCK_MOD_COAP_RESOURCE_INDEX */
   for(resource = list_head(coap_resource_services);
       resource; resource = resource->next) {
 
@@ -455,6 +574,7 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
             && (resource->flags & HAS_SUB_RESOURCES)
             && url[res_url_len] == '/'))
        && strncmp(resource->url, url, res_url_len) == 0) {
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
       coap_resource_flags_t method = coap_get_method_type(request);
       found = 1;
 
@@ -479,8 +599,10 @@ invoke_coap_resource_service(coap_message_t *request, coap_message_t *response,
         allowed = 0;
         coap_set_status_code(response, METHOD_NOT_ALLOWED_4_05);
       }
+#if !HCK_MOD_COAP_RESOURCE_INDEX
       break;
     }
+#endif /* !HCK_MOD_COAP_RESOURCE_INDEX */
   }
   if(!found) {
     coap_set_status_code(response, NOT_FOUND_4_04);
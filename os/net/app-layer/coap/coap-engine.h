@@ -46,6 +46,7 @@
 
 typedef struct coap_resource_s coap_resource_t;
 typedef struct coap_periodic_resource_s coap_periodic_resource_t;
+struct coap_observer;
 
 #include "coap.h"
 #include "coap-timer.h"
@@ -111,6 +112,13 @@ struct coap_resource_s {
     coap_resource_trigger_handler_t trigger;
     coap_resource_trigger_handler_t resume;
   };
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  coap_resource_t *index_next;      /* next resource in the same index bucket */
+  uint16_t url_len;
+  uint16_t url_hash;
+  uint16_t index_order;             /* activation order, the first match wins */
+  struct coap_observer *observers;  /* observers that requested this resource */
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
 };
 
 struct coap_periodic_resource_s {
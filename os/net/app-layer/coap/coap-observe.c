@@ -47,6 +47,10 @@
 #include "coap-engine.h"
 #include "lib/memb.h"
 #include "lib/list.h"
+#if HCK_MOD_COAP_NOTIFY_COALESCING && MAC_CONF_WITH_TSCH
+#include "net/queuebuf.h"
+#include "net/mac/tsch/tsch.h"
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING && MAC_CONF_WITH_TSCH */
 
 /* Log configuration */
 #include "coap-log.h"
@@ -56,6 +60,33 @@
 /*---------------------------------------------------------------------------*/
 MEMB(observers_memb, coap_observer_t, COAP_MAX_OBSERVERS);
 LIST(observers_list);
+
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+/* Longest wait for a notification, and the wait without TSCH (msec) */
+#ifdef HCK_COAP_NOTIFY_CONF_DELAY
+#define HCK_COAP_NOTIFY_DELAY HCK_COAP_NOTIFY_CONF_DELAY
+#else
+#define HCK_COAP_NOTIFY_DELAY 250
+#endif
+/* Queue buffers left to the traffic relayed by this node */
+#ifdef HCK_COAP_NOTIFY_CONF_QUEUE_RESERVE
+#define HCK_COAP_NOTIFY_QUEUE_RESERVE HCK_COAP_NOTIFY_CONF_QUEUE_RESERVE
+#else
+#define HCK_COAP_NOTIFY_QUEUE_RESERVE 2
+#endif
+
+/*
+ * Notifications are not sent right away: the observer is marked, and
+ * all marked observers are served by a flush just before the next Tx
+ * cell towards the parent, which is when the MAC would send them
+ * anyway. A notification that is still pending when the resource
+ * changes again is superseded, as the flush asks the resource for its
+ * current representation. The flush sends the notifications of one
+ * endpoint back to back.
+ */
+static coap_timer_t flush_timer;
+static uint8_t flush_scheduled;
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
@@ -79,6 +110,9 @@ add_observer(const coap_endpoint_t *endpoint, const uint8_t *token,
     o->token_len = token_len;
     memcpy(o->token, token, token_len);
     o->last_mid = 0;
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+    o->pending = 0;
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
 
     LOG_INFO("Adding observer (%u/%u) for /%s [0x%02X%02X]\n",
              list_length(observers_list) + 1, COAP_MAX_OBSERVERS,
@@ -97,6 +131,19 @@ coap_remove_observer(coap_observer_t *o)
   LOG_INFO("Removing observer for /%s [0x%02X%02X]\n", o->url, o->token[0],
            o->token[1]);
 
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  if(o->resource != NULL) {
+    coap_observer_t **r;
+
+    for(r = &o->resource->observers; *r != NULL; r = &(*r)->resource_next) {
+      if(*r == o) {
+        *r = o->resource_next;
+        break;
+      }
+    }
+  }
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
+
   memb_free(&observers_memb, o);
   list_remove(observers_list, o);
 }
@@ -180,6 +227,152 @@ coap_remove_observer_by_mid(const coap_endpoint_t *endpoint, uint16_t mid)
 /*---------------------------------------------------------------------------*/
 /*- Notification ------------------------------------------------------------*/
 /*---------------------------------------------------------------------------*/
+static void
+send_notification(coap_observer_t *obs, coap_resource_t *resource,
+                  coap_message_t *request, coap_message_t *notification)
+{
+  coap_transaction_t *transaction = NULL;
+
+  /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
+
+  if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
+    /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
+    if(COAP_OBSERVE_REFRESH_INTERVAL != 0
+        && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
+      LOG_DBG("           Force Confirmable for\n");
+      notification->type = COAP_TYPE_CON;
+    }
+
+    LOG_DBG("           Observer ");
+    LOG_DBG_COAP_EP(&obs->endpoint);
+    LOG_DBG_("\n");
+
+    /* update last MID for RST matching */
+    obs->last_mid = transaction->mid;
+
+    /* prepare response */
+    notification->mid = transaction->mid;
+
+    int32_t new_offset = 0;
+
+    /* Either old style get_handler or the full handler */
+    if(coap_call_handlers(request, notification, transaction->message +
+                          COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
+                          &new_offset) > 0) {
+      LOG_DBG("Notification on new handlers\n");
+    } else {
+      if(resource != NULL) {
+        resource->get_handler(request, notification,
+                              transaction->message + COAP_MAX_HEADER_SIZE,
+                              COAP_MAX_CHUNK_SIZE, &new_offset);
+      } else {
+        /* What to do here? */
+        notification->code = BAD_REQUEST_4_00;
+      }
+    }
+
+    if(notification->code < BAD_REQUEST_4_00) {
+      coap_set_header_observe(notification, (obs->obs_counter)++);
+      /* mask out to keep the CoAP observe option length <= 3 bytes */
+      obs->obs_counter &= 0xffffff;
+    }
+    coap_set_token(notification, obs->token, obs->token_len);
+
+    if(new_offset != 0) {
+      coap_set_header_block2(notification,
+                             0,
+                             new_offset != -1,
+                             COAP_MAX_BLOCK_SIZE);
+      coap_set_payload(notification,
+                       notification->payload,
+                       MIN(notification->payload_len,
+                           COAP_MAX_BLOCK_SIZE));
+    }
+
+    transaction->message_len =
+      coap_serialize_message(notification, transaction->message);
+
+    coap_send_transaction(transaction);
+  }
+}
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+/*---------------------------------------------------------------------------*/
+/* Time until the flush due before the next Tx cell towards the parent,
+   or until the flush after that cell once it has freed a queue buffer */
+static uint64_t
+flush_delay(int after_cell)
+{
+#if MAC_CONF_WITH_TSCH
+  struct tsch_neighbor *n;
+  uint32_t slot_ms;
+  uint16_t slots;
+
+  n = tsch_queue_get_time_source();
+  if(tsch_is_associated && n != NULL) {
+    slots = tsch_schedule_get_slots_to_next_tx(tsch_queue_get_nbr_address(n));
+    if(slots > 0) {
+      slot_ms = tsch_timing_us[tsch_ts_timeslot_length] / 1000;
+      return MIN((after_cell ? slots + 1 : slots - 1) * slot_ms,
+                 HCK_COAP_NOTIFY_DELAY);
+    }
+  }
+#endif /* MAC_CONF_WITH_TSCH */
+  return HCK_COAP_NOTIFY_DELAY;
+}
+/*---------------------------------------------------------------------------*/
+static void flush_notifications(coap_timer_t *timer);
+/*---------------------------------------------------------------------------*/
+static void
+schedule_flush(int after_cell)
+{
+  if(!flush_scheduled) {
+    flush_scheduled = 1;
+    coap_timer_set_callback(&flush_timer, flush_notifications);
+    coap_timer_set(&flush_timer, flush_delay(after_cell));
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+flush_notifications(coap_timer_t *timer)
+{
+  coap_message_t notification[1];
+  coap_message_t request[1];
+  coap_observer_t *obs, *o;
+  char url[COAP_OBSERVER_URL_LEN];
+
+  flush_scheduled = 0;
+
+  for(obs = (coap_observer_t *)list_head(observers_list); obs;
+      obs = obs->next) {
+    if(!obs->pending) {
+      continue;
+    }
+    /* This observer's endpoint first, as one burst. */
+    for(o = obs; o; o = o->next) {
+      if(!o->pending || !coap_endpoint_cmp(&o->endpoint, &obs->endpoint)) {
+        continue;
+      }
+#if MAC_CONF_WITH_TSCH
+      if(queuebuf_numfree() <= HCK_COAP_NOTIFY_QUEUE_RESERVE) {
+        /* Wait for the next cell rather than have relayed packets
+           dropped. */
+        schedule_flush(1);
+        return;
+      }
+#endif /* MAC_CONF_WITH_TSCH */
+      o->pending = 0;
+      memcpy(url, o->url, o->pending_url_len);
+      url[o->pending_url_len] = '\0';
+
+      coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
+      coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
+      coap_set_header_uri_path(request, url);
+      send_notification(o, o->pending_resource, request, notification);
+    }
+  }
+}
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
+/*---------------------------------------------------------------------------*/
 void
 coap_notify_observers(coap_resource_t *resource)
 {
@@ -190,9 +383,11 @@ coap_notify_observers(coap_resource_t *resource)
 void
 coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
 {
+#if !HCK_MOD_COAP_NOTIFY_COALESCING
   /* build notification */
   coap_message_t notification[1]; /* this way the message can be treated as pointer as usual */
   coap_message_t request[1]; /* this way the message can be treated as pointer as usual */
+#endif /* !HCK_MOD_COAP_NOTIFY_COALESCING */
   coap_observer_t *obs = NULL;
   int url_len, obs_url_len;
   char url[COAP_OBSERVER_URL_LEN];
@@ -216,17 +411,27 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
   /* url now contains the notify URL that needs to match the observer */
   LOG_INFO("Notification from %s\n", url);
 
+#if !HCK_MOD_COAP_NOTIFY_COALESCING
   coap_init_message(notification, COAP_TYPE_NON, CONTENT_2_05, 0);
   /* create a "fake" request for the URI */
   coap_init_message(request, COAP_TYPE_CON, COAP_GET, 0);
   coap_set_header_uri_path(request, url);
+#endif /* !HCK_MOD_COAP_NOTIFY_COALESCING */
 
   /* iterate over observers */
   url_len = strlen(url);
   /* Assumes lazy evaluation... */
   sub_ok = (resource == NULL) || (resource->flags & HAS_SUB_RESOURCES);
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  /* A resource only has to check the observers that requested it. */
+  for(obs = resource != NULL ? resource->observers
+          : (coap_observer_t *)list_head(observers_list);
+      obs;
+      obs = resource != NULL ? obs->resource_next : obs->next) {
+#else /* HCK_MOD_COAP_RESOURCE_INDEX */
   for(obs = (coap_observer_t *)list_head(observers_list); obs;
       obs = obs->next) {
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
     obs_url_len = strlen(obs->url);
 
     /* Do a match based on the parent/sub-resource match so that it is
@@ -239,69 +444,15 @@ coap_notify_observers_sub(coap_resource_t *resource, const char *subpath)
             && sub_ok
             && obs->url[url_len] == '/'))
        && strncmp(url, obs->url, url_len) == 0) {
-      coap_transaction_t *transaction = NULL;
-
-      /*TODO implement special transaction for CON, sharing the same buffer to allow for more observers */
-
-      if((transaction = coap_new_transaction(coap_get_mid(), &obs->endpoint))) {
-        /* if COAP_OBSERVE_REFRESH_INTERVAL is zero, never send observations as confirmable messages */
-        if(COAP_OBSERVE_REFRESH_INTERVAL != 0
-            && (obs->obs_counter % COAP_OBSERVE_REFRESH_INTERVAL == 0)) {
-          LOG_DBG("           Force Confirmable for\n");
-          notification->type = COAP_TYPE_CON;
-        }
-
-        LOG_DBG("           Observer ");
-        LOG_DBG_COAP_EP(&obs->endpoint);
-        LOG_DBG_("\n");
-
-        /* update last MID for RST matching */
-        obs->last_mid = transaction->mid;
-
-        /* prepare response */
-        notification->mid = transaction->mid;
-
-	int32_t new_offset = 0;
-
-        /* Either old style get_handler or the full handler */
-        if(coap_call_handlers(request, notification, transaction->message +
-                              COAP_MAX_HEADER_SIZE, COAP_MAX_CHUNK_SIZE,
-                              &new_offset) > 0) {
-          LOG_DBG("Notification on new handlers\n");
-        } else {
-          if(resource != NULL) {
-            resource->get_handler(request, notification,
-                                  transaction->message + COAP_MAX_HEADER_SIZE,
-                                  COAP_MAX_CHUNK_SIZE, &new_offset);
-          } else {
-            /* What to do here? */
-            notification->code = BAD_REQUEST_4_00;
-          }
-        }
-
-        if(notification->code < BAD_REQUEST_4_00) {
-          coap_set_header_observe(notification, (obs->obs_counter)++);
-          /* mask out to keep the CoAP observe option length <= 3 bytes */
-          obs->obs_counter &= 0xffffff;
-        }
-        coap_set_token(notification, obs->token, obs->token_len);
-
-	if(new_offset != 0) {
-	  coap_set_header_block2(notification,
-				 0,
-				 new_offset != -1,
-				 COAP_MAX_BLOCK_SIZE);
-	  coap_set_payload(notification,
-			   notification->payload,
-			   MIN(notification->payload_len,
-			       COAP_MAX_BLOCK_SIZE));
-	}
-
-        transaction->message_len =
-          coap_serialize_message(notification, transaction->message);
-
-        coap_send_transaction(transaction);
-      }
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+      /* Supersedes the notification still pending, if any. */
+      obs->pending_resource = resource;
+      obs->pending_url_len = url_len;
+      obs->pending = 1;
+      schedule_flush(0);
+#else /* HCK_MOD_COAP_NOTIFY_COALESCING */
+      send_notification(obs, resource, request, notification);
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
     }
   }
 }
@@ -324,6 +475,19 @@ coap_observe_handler(coap_resource_t *resource, coap_message_t *coap_req,
         obs = add_observer(src_ep,
                            coap_req->token, coap_req->token_len,
                            coap_req->uri_path, coap_req->uri_path_len);
+#if HCK_MOD_COAP_RESOURCE_INDEX
+        if(obs) {
+          coap_observer_t **r;
+
+          /* Append, to notify in the same order as the global list. */
+          obs->resource = resource;
+          obs->resource_next = NULL;
+          if(resource != NULL) {
+            for(r = &resource->observers; *r != NULL; r = &(*r)->resource_next);
+            *r = obs;
+          }
+        }
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
         if(obs) {
           coap_set_header_observe(coap_res, (obs->obs_counter)++);
           /* mask out to keep the CoAP observe option length <= 3 bytes */
@@ -61,6 +61,15 @@ typedef struct coap_observer {
 
   coap_timer_t retrans_timer;
   uint8_t retrans_counter;
+#if HCK_MOD_COAP_RESOURCE_INDEX
+  coap_resource_t *resource;            /* NULL for observers of handlers */
+  struct coap_observer *resource_next;  /* for the resource's observers */
+#endif /* HCK_MOD_COAP_RESOURCE_INDEX */
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+  coap_resource_t *pending_resource;    /* of the notification to send */
+  uint8_t pending_url_len;              /* of the notify URL, a prefix of url */
+  uint8_t pending;
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
 } coap_observer_t;
 
 void coap_remove_observer(coap_observer_t *o);
@@ -47,6 +47,9 @@
 #include "lib/memb.h"
 #include "lib/list.h"
 #include <stdlib.h>
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+#include <string.h>
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 
 /* Log configuration */
 #include "coap-log.h"
@@ -57,6 +60,43 @@
 MEMB(transactions_memb, coap_transaction_t, COAP_MAX_OPEN_TRANSACTIONS);
 LIST(transactions_list);
 
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+#ifdef HCK_COAP_RTO_CONF_ENTRIES
+#define HCK_COAP_RTO_ENTRIES HCK_COAP_RTO_CONF_ENTRIES
+#else
+#define HCK_COAP_RTO_ENTRIES 4
+#endif
+
+/*
+ * CoCoA-style RTO estimation per endpoint, in msec. Exchanges answered
+ * without a retransmission feed the strong estimator, those answered
+ * after one or two retransmissions the weak one, which counts the RTT
+ * from the first transmission. Both are RFC 6298 estimators (K = 4 and
+ * K = 1) blended into the RTO with weights 1/2 and 1/4. The backoff
+ * factor depends on the RTO, and RTOs that are not updated for a while
+ * drift back towards 1-3 s.
+ */
+#define RTO_MIN 250
+#define RTO_MAX 60000UL
+
+struct rtt_estimator {
+  uint32_t srtt;
+  uint32_t rttvar;
+};
+
+struct rto_entry {
+  coap_endpoint_t endpoint;
+  struct rtt_estimator strong;
+  struct rtt_estimator weak;
+  uint32_t rto;
+  uint64_t updated;
+  uint8_t used;
+};
+
+static struct rto_entry rto_entries[HCK_COAP_RTO_ENTRIES];
+static uint8_t last_retransmissions;
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
+
 /*---------------------------------------------------------------------------*/
 static void
 coap_retransmit_transaction(coap_timer_t *nt)
@@ -71,6 +111,112 @@ coap_retransmit_transaction(coap_timer_t *nt)
   coap_send_transaction(t);
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+static struct rto_entry *
+rto_lookup(const coap_endpoint_t *ep, int create)
+{
+  struct rto_entry *e;
+  struct rto_entry *oldest;
+
+  oldest = NULL;
+  for(e = rto_entries; e < &rto_entries[HCK_COAP_RTO_ENTRIES]; e++) {
+    if(e->used && coap_endpoint_cmp(&e->endpoint, ep)) {
+      return e;
+    }
+    if(oldest == NULL || !e->used
+       || (oldest->used && e->updated < oldest->updated)) {
+      oldest = e;
+    }
+  }
+
+  if(!create) {
+    return NULL;
+  }
+
+  memset(oldest, 0, sizeof(*oldest));
+  coap_endpoint_copy(&oldest->endpoint, ep);
+  oldest->rto = COAP_RESPONSE_TIMEOUT_TICKS;
+  oldest->updated = coap_timer_uptime();
+  oldest->used = 1;
+  return oldest;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+rtt_estimate(struct rtt_estimator *est, uint32_t rtt, uint8_t k)
+{
+  uint32_t diff;
+
+  if(est->srtt == 0) {
+    est->srtt = rtt;
+    est->rttvar = rtt / 2;
+  } else {
+    diff = est->srtt > rtt ? est->srtt - rtt : rtt - est->srtt;
+    est->rttvar = (3 * est->rttvar + diff) / 4;
+    est->srtt = (7 * est->srtt + rtt) / 8;
+  }
+
+  return est->srtt + k * est->rttvar;
+}
+/*---------------------------------------------------------------------------*/
+uint32_t
+coap_get_rto(const coap_endpoint_t *ep)
+{
+  struct rto_entry *e;
+  uint64_t now;
+
+  e = rto_lookup(ep, 0);
+  if(e == NULL) {
+    return COAP_RESPONSE_TIMEOUT_TICKS;
+  }
+
+  now = coap_timer_uptime();
+  if(e->rto < 1000 && now - e->updated > 16 * (uint64_t)e->rto) {
+    e->rto *= 2;
+    e->updated = now;
+  } else if(e->rto > 3000 && now - e->updated > 4 * (uint64_t)e->rto) {
+    e->rto = (1000 + e->rto) / 2;
+    e->updated = now;
+  }
+
+  return e->rto;
+}
+/*---------------------------------------------------------------------------*/
+void
+coap_transaction_acked(coap_transaction_t *t)
+{
+  struct rto_entry *e;
+  uint32_t rtt;
+  uint32_t rto;
+
+  last_retransmissions = t->retrans_counter;
+
+  /* Only confirmable transactions that we sent have an RTO, and later
+     retransmissions make the RTT ambiguous. */
+  if(t->rto == 0 || t->retrans_counter > 2) {
+    return;
+  }
+
+  rtt = MAX(coap_timer_uptime() - t->first_sent, 1);
+  e = rto_lookup(&t->endpoint, 1);
+  if(t->retrans_counter == 0) {
+    rto = (rtt_estimate(&e->strong, rtt, 4) + e->rto) / 2;
+  } else {
+    rto = (rtt_estimate(&e->weak, rtt, 1) + 3 * e->rto) / 4;
+  }
+  e->rto = MIN(MAX(rto, RTO_MIN), RTO_MAX);
+  e->updated = coap_timer_uptime();
+
+  LOG_DBG("RTT %lu msec after %u retransmissions, RTO %lu msec\n",
+          (unsigned long)rtt, t->retrans_counter, (unsigned long)e->rto);
+}
+/*---------------------------------------------------------------------------*/
+uint8_t
+coap_transaction_last_retransmissions(void)
+{
+  return last_retransmissions;
+}
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
+/*---------------------------------------------------------------------------*/
 
 /*---------------------------------------------------------------------------*/
 /*- Internal API ------------------------------------------------------------*/
@@ -83,6 +229,9 @@ coap_new_transaction(uint16_t mid, const coap_endpoint_t *endpoint)
   if(t) {
     t->mid = mid;
     t->retrans_counter = 0;
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+    t->rto = 0;
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 
     /* save client address */
     coap_endpoint_copy(&t->endpoint, endpoint);
@@ -108,11 +257,26 @@ coap_send_transaction(coap_transaction_t *t)
       if(t->retrans_counter == 0) {
         coap_timer_set_callback(&t->retrans_timer, coap_retransmit_transaction);
         coap_timer_set_user_data(&t->retrans_timer, t);
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+        /* Dither the estimated RTO by the same random factor. */
+        t->rto = coap_get_rto(&t->endpoint);
+        t->first_sent = coap_timer_uptime();
+        t->retrans_interval = t->rto + (rand() % (uint32_t)
+          (t->rto * ((float)COAP_RESPONSE_RANDOM_FACTOR - 1.0) + 1));
+#else /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
         t->retrans_interval =
           COAP_RESPONSE_TIMEOUT_TICKS + (rand() %
                                          COAP_RESPONSE_TIMEOUT_BACKOFF_MASK);
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
         LOG_DBG("Initial interval %lu msec\n",
                 (unsigned long)t->retrans_interval);
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+      } else if(t->rto < 1000) {
+        /* Variable backoff: short RTOs back off faster, long ones slower. */
+        t->retrans_interval *= 3;
+      } else if(t->rto > 3000) {
+        t->retrans_interval += t->retrans_interval / 2;
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
       } else {
         t->retrans_interval <<= 1;  /* double */
         LOG_DBG("Doubled (%u) interval %lu s\n", t->retrans_counter,
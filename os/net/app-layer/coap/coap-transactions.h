@@ -63,6 +63,10 @@ typedef struct coap_transaction {
   coap_timer_t retrans_timer;
   uint32_t retrans_interval;
   uint8_t retrans_counter;
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+  uint64_t first_sent;                  /* for RTT measurements */
+  uint32_t rto;                         /* RTO of the first transmission */
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
 
   coap_endpoint_t endpoint;
 
@@ -79,5 +83,17 @@ void coap_send_transaction(coap_transaction_t *t);
 void coap_clear_transaction(coap_transaction_t *t);
 coap_transaction_t *coap_get_transaction_by_mid(uint16_t mid);
 
+#if HCK_MOD_COAP_PIPELINED_BLOCKWISE
+/*
+ * To be called when the response to a confirmable transaction arrives,
+ * before the transaction is cleared: feeds the RTT estimators of the
+ * endpoint.
+ */
+void coap_transaction_acked(coap_transaction_t *t);
+/* Retransmissions needed by the last acked transaction. */
+uint8_t coap_transaction_last_retransmissions(void);
+uint32_t coap_get_rto(const coap_endpoint_t *ep);
+#endif /* HCK_MOD_COAP_PIPELINED_BLOCKWISE */
+
 #endif /* COAP_TRANSACTIONS_H_ */
 /** @} */
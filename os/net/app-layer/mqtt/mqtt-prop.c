@@ -701,6 +701,44 @@ mqtt_prop_create_list(struct mqtt_prop_list **prop_list_out)
   (*prop_list_out)->properties_len_enc_bytes = 1; /* 1 byte needed for len = 0 */
 }
 /*----------------------------------------------------------------------------*/
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+/* Copies the encoded properties of a list (none if NULL) to buf, returns
+ * the number of bytes written or 0 if they do not fit
+ */
+uint32_t
+mqtt_prop_serialize(struct mqtt_prop_list *prop_list, uint8_t *buf,
+                    uint32_t len)
+{
+  struct mqtt_prop_out_property *prop;
+  uint32_t pos;
+
+  if(prop_list == NULL) {
+    if(len < 1) {
+      return 0;
+    }
+    buf[0] = 0;
+    return 1;
+  }
+
+  if(prop_list->properties_len_enc_bytes + prop_list->properties_len > len) {
+    return 0;
+  }
+
+  memcpy(buf, prop_list->properties_len_enc,
+         prop_list->properties_len_enc_bytes);
+  pos = prop_list->properties_len_enc_bytes;
+  for(prop = (struct mqtt_prop_out_property *)list_head(prop_list->props);
+      prop != NULL;
+      prop = (struct mqtt_prop_out_property *)list_item_next(prop)) {
+    buf[pos++] = prop->id;
+    memcpy(&buf[pos], prop->val, prop->property_len);
+    pos += prop->property_len;
+  }
+
+  return pos;
+}
+#endif
+/*----------------------------------------------------------------------------*/
 /* Prints all properties in the given property list (debug)
  * If ID == MQTT_VHDR_PROP_ANY, prints all properties, otherwise it filters them
  * by property ID
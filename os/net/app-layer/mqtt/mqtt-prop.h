@@ -120,6 +120,16 @@ void mqtt_prop_create_list(struct mqtt_prop_list **prop_list_out);
 
 void mqtt_prop_print_list(struct mqtt_prop_list *prop_list, mqtt_vhdr_prop_t prop_id);
 
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+/* Largest output of mqtt_prop_serialize() for a list of registered
+ * properties */
+#define MQTT_PROP_MAX_SERIALIZED_LEN (MQTT_PROP_MAX_PROP_LEN_BYTES + \
+  MQTT_PROP_MAX_OUT_PROPS * (1 + MQTT_PROP_MAX_PROP_LENGTH))
+
+uint32_t mqtt_prop_serialize(struct mqtt_prop_list *prop_list, uint8_t *buf,
+                             uint32_t len);
+#endif
+
 void mqtt_prop_clear_list(struct mqtt_prop_list **prop_list);
 
 void mqtt_props_init();
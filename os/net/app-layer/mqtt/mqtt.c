@@ -830,6 +830,18 @@ PT_THREAD(unsubscribe_pt(struct pt *pt, struct mqtt_connection *conn))
 static
 PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
 {
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  uint8_t hdr[1 + MQTT_MAX_REMAINING_LENGTH_BYTES + MQTT_STRING_LEN_SIZE];
+#if MQTT_5
+  uint8_t vhdr[MQTT_MID_SIZE + MQTT_PROP_MAX_SERIALIZED_LEN];
+  uint32_t props_len;
+#else
+  uint8_t vhdr[MQTT_MID_SIZE];
+#endif
+  uint32_t vhdr_len;
+  uint8_t i;
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
+
   PT_BEGIN(pt);
 
   DBG("MQTT - Sending publish message! topic %s topic_length %i\n",
@@ -871,6 +883,47 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
     conn->out_packet.fhdr &= ~MQTT_FHDR_DUP_FLAG;
   }
 
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  /*
+   * The socket queue is empty (see mqtt_do_publish_event). The packet is
+   * queued at once: the headers and properties are copied, the topic and
+   * the payload referenced.
+   */
+  hdr[0] = conn->out_packet.fhdr;
+  memcpy(&hdr[1], conn->out_packet.remaining_length_enc,
+         conn->out_packet.remaining_length_enc_bytes);
+  memcpy(&hdr[1 + conn->out_packet.remaining_length_enc_bytes],
+         conn->out_packet.topic_enc->length_enc, MQTT_STRING_LEN_SIZE);
+
+  vhdr_len = 0;
+  if(conn->out_packet.qos > MQTT_QOS_LEVEL_0) {
+    vhdr[vhdr_len++] = conn->out_packet.mid >> 8;
+    vhdr[vhdr_len++] = conn->out_packet.mid & 0x00FF;
+  }
+#if MQTT_5
+  props_len = mqtt_prop_serialize(conn->out_props, &vhdr[vhdr_len],
+                                  sizeof(vhdr) - vhdr_len);
+  if(props_len == 0) {
+    call_event(conn, MQTT_EVENT_PROTOCOL_ERROR, NULL);
+    PRINTF("MQTT - Error, properties too long\n");
+    PT_EXIT(pt);
+  }
+  vhdr_len += props_len;
+#endif
+
+  conn->out_buffer_sent = 0;
+  tcp_socket_send(&conn->socket, hdr, 1 +
+                  conn->out_packet.remaining_length_enc_bytes +
+                  MQTT_STRING_LEN_SIZE);
+  tcp_socket_send_ref(&conn->socket,
+                      (const uint8_t *)conn->out_packet.topic_enc->name,
+                      conn->out_packet.topic_enc->length);
+  tcp_socket_send(&conn->socket, vhdr, vhdr_len);
+  for(i = 0; i < conn->out_packet.iovcnt; i++) {
+    tcp_socket_send_ref(&conn->socket, conn->out_packet.iov[i].data,
+                        conn->out_packet.iov[i].len);
+  }
+#else /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
   /* Write Fixed Header */
   PT_MQTT_WRITE_BYTE(conn, conn->out_packet.fhdr);
   PT_MQTT_WRITE_BYTES(conn, (uint8_t *)conn->out_packet.remaining_length_enc,
@@ -896,6 +949,7 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
                       conn->out_packet.payload_size);
 
   send_out_buffer(conn);
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
   timer_set(&conn->t, RESPONSE_WAIT_TIMEOUT);
 
   /*
@@ -905,6 +959,10 @@ PT_THREAD(publish_pt(struct pt *pt, struct mqtt_connection *conn))
    * Also notify the app will not be notified via PUBACK or PUBCOMP
    */
   if(conn->out_packet.qos == 0) {
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+    /* The payload is referenced until the broker has it */
+    PT_WAIT_UNTIL(pt, conn->out_buffer_sent || timer_expired(&conn->t));
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
     process_post(conn->app_process, mqtt_update_event, NULL);
   } else if(conn->out_packet.qos == 1) {
     /* Wait for PUBACK */
@@ -1605,7 +1663,11 @@ tcp_event(struct tcp_socket *s, void *ptr, tcp_socket_event_t event)
   case TCP_SOCKET_DATA_SENT: {
     DBG("MQTT - Got TCP_DATA_SENT\n");
 
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+    if(tcp_socket_queuelen(&conn->socket) == 0) {
+#else /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
     if(conn->socket.output_data_len == 0) {
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
       conn->out_buffer_sent = 1;
       conn->out_buffer_ptr = conn->out_buffer;
     }
@@ -1993,6 +2055,12 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
 
   DBG("MQTT - Call to mqtt_publish...\n");
 
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  if(payload_size > 0xffff - MQTT_TCP_OUTPUT_BUFF_SIZE - strlen(topic)) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
+
   /* Currently don't have a queue, so only one item at a time */
   if(conn->out_queue_full) {
     DBG("MQTT - Not accepted!\n");
@@ -2024,18 +2092,98 @@ mqtt_publish(struct mqtt_connection *conn, uint16_t *mid, char *topic,
   conn->out_packet.payload_size = payload_size;
   conn->out_packet.qos = qos_level;
   conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  mqtt_topic_init(&conn->out_topic, conn->out_packet.topic);
+  conn->out_iov.data = payload;
+  conn->out_iov.len = payload_size;
+  conn->out_packet.topic_enc = &conn->out_topic;
+  conn->out_packet.iov = &conn->out_iov;
+  conn->out_packet.iovcnt = 1;
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
+
+  if(mid) {
+    *mid = conn->out_packet.mid;
+  }
+
+#if MQTT_5
+  conn->out_props = prop_list;
+#endif
+
+  process_post(&mqtt_process, mqtt_do_publish_event, conn);
+  return MQTT_STATUS_OK;
+}
+/*----------------------------------------------------------------------------*/
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+void
+mqtt_topic_init(struct mqtt_topic *topic, const char *name)
+{
+  topic->name = name;
+  topic->length = strlen(name);
+  topic->length_enc[0] = topic->length >> 8;
+  topic->length_enc[1] = topic->length & 0x00FF;
+}
+/*----------------------------------------------------------------------------*/
+mqtt_status_t
+mqtt_publish_sg(struct mqtt_connection *conn, uint16_t *mid,
+                const struct mqtt_topic *topic,
+                const struct mqtt_iovec *payload, uint8_t iovcnt,
+                mqtt_qos_level_t qos_level,
+#if MQTT_5
+                mqtt_retain_t retain,
+                struct mqtt_prop_list *prop_list)
+#else
+                mqtt_retain_t retain)
+#endif
+{
+  uint32_t payload_size;
+  uint8_t i;
+
+  if(conn->state != MQTT_CONN_STATE_CONNECTED_TO_BROKER) {
+    return MQTT_STATUS_NOT_CONNECTED_ERROR;
+  }
+
+  payload_size = 0;
+  for(i = 0; i < iovcnt; i++) {
+    payload_size += payload[i].len;
+  }
+  /* The socket references the topic and each piece of the payload, next
+     to two runs of copied bytes, and counts its queue in 16 bits */
+  if(iovcnt > HCK_TCP_SOCKET_SEGMENTS - 3 ||
+     payload_size > 0xffff - MQTT_TCP_OUTPUT_BUFF_SIZE - topic->length) {
+    return MQTT_STATUS_INVALID_ARGS_ERROR;
+  }
+
+  if(conn->out_queue_full) {
+    DBG("MQTT - Not accepted!\n");
+    return MQTT_STATUS_OUT_QUEUE_FULL;
+  }
+  conn->out_queue_full = 1;
+
+  conn->out_packet.mid = INCREMENT_MID(conn);
+  conn->out_packet.retain = retain;
+  conn->out_packet.topic = (char *)topic->name;
+  conn->out_packet.topic_length = topic->length;
+  conn->out_packet.topic_enc = topic;
+  conn->out_packet.payload = NULL;
+  conn->out_packet.payload_size = payload_size;
+  conn->out_packet.iov = payload;
+  conn->out_packet.iovcnt = iovcnt;
+  conn->out_packet.qos = qos_level;
+  conn->out_packet.qos_state = MQTT_QOS_STATE_NO_ACK;
 
   if(mid) {
     *mid = conn->out_packet.mid;
   }
 
 #if MQTT_5
+  conn->out_packet.topic_alias = 0;
   conn->out_props = prop_list;
 #endif
 
   process_post(&mqtt_process, mqtt_do_publish_event, conn);
   return MQTT_STATUS_OK;
 }
+#endif /* HCK_MOD_MQTT_ZERO_COPY_PUBLISH */
 /*----------------------------------------------------------------------------*/
 void
 mqtt_set_username_password(struct mqtt_connection *conn, char *username,
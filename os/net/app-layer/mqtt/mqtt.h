@@ -381,6 +381,24 @@ struct mqtt_string {
   uint16_t length;
 };
 
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+#if !HCK_MOD_TCP_SOCKET_SEND_REF
+#error "HCK_MOD_MQTT_ZERO_COPY_PUBLISH requires HCK_MOD_TCP_SOCKET_SEND_REF (tcp_socket_send_ref())"
+#endif
+/* A topic published repeatedly, encoded once by mqtt_topic_init() */
+struct mqtt_topic {
+  const char *name;
+  uint16_t length;
+  uint8_t length_enc[MQTT_STRING_LEN_SIZE];
+};
+
+/* A piece of a payload given to mqtt_publish_sg() */
+struct mqtt_iovec {
+  const uint8_t *data;
+  uint16_t len;
+};
+#endif
+
 /*
  * Note that the pairing mid <-> QoS level only applies one-to-one if we only
  * allow the subscription of one topic at a time. Otherwise we will have an
@@ -478,6 +496,11 @@ struct mqtt_out_packet {
   mqtt_qos_level_t qos;
   mqtt_qos_state_t qos_state;
   mqtt_retain_t retain;
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  const struct mqtt_topic *topic_enc;
+  const struct mqtt_iovec *iov;
+  uint8_t iovcnt;
+#endif
 #if MQTT_5
   uint8_t topic_alias;
   uint8_t sub_options;
@@ -549,6 +572,11 @@ struct mqtt_connection {
   uint8_t out_buffer[MQTT_TCP_OUTPUT_BUFF_SIZE];
   uint8_t out_buffer_sent;
   struct mqtt_out_packet out_packet;
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+  /* Topic and payload of mqtt_publish() */
+  struct mqtt_topic out_topic;
+  struct mqtt_iovec out_iov;
+#endif
   struct pt out_proto_thread;
   uint32_t out_write_pos;
   uint16_t max_segment_size;
@@ -714,6 +742,46 @@ mqtt_status_t mqtt_publish(struct mqtt_connection *conn,
                            mqtt_retain_t retain);
 #endif
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_MQTT_ZERO_COPY_PUBLISH
+/**
+ * \brief Encode a topic for mqtt_publish_sg().
+ * \param topic A pointer to the encoded topic.
+ * \param name The topic name, which must stay valid while the encoding is used.
+ */
+void mqtt_topic_init(struct mqtt_topic *topic, const char *name);
+/*---------------------------------------------------------------------------*/
+/**
+ * \brief Publish to a MQTT topic without copying the topic or the payload.
+ * \param conn A pointer to the MQTT connection.
+ * \param mid A pointer to message ID.
+ * \param topic A pointer to the topic, encoded by mqtt_topic_init().
+ * \param payload The pieces of the payload, in order.
+ * \param iovcnt The number of pieces, at most HCK_TCP_SOCKET_SEGMENTS - 3.
+ * \param qos_level Quality Of Service level to use. Currently supports 0, 1.
+ * \param retain See mqtt_publish().
+ * \param prop_list Output properties (MQTTv5-only).
+ * \return MQTT_STATUS_OK or some error status
+ *
+ * The topic name and the payload are read straight into the outgoing TCP
+ * segments, and read again by retransmissions. They and the payload array
+ * must stay unchanged until the publish completes, i.e. until the
+ * mqtt_update_event (QoS 0) or MQTT_EVENT_PUBACK (QoS 1) that follows.
+ * The same applies to mqtt_publish(), which is built on it.
+ */
+mqtt_status_t mqtt_publish_sg(struct mqtt_connection *conn,
+                              uint16_t *mid,
+                              const struct mqtt_topic *topic,
+                              const struct mqtt_iovec *payload,
+                              uint8_t iovcnt,
+                              mqtt_qos_level_t qos_level,
+#if MQTT_5
+                              mqtt_retain_t retain,
+                              struct mqtt_prop_list *prop_list);
+#else
+                              mqtt_retain_t retain);
+#endif
+#endif
+/*---------------------------------------------------------------------------*/
 /**
  * \brief Set the user name and password for a MQTT client.
  * \param conn A pointer to the MQTT connection.
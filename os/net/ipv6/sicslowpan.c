@@ -105,8 +105,27 @@ static uint16_t ip_ucast_udp_ok_count;
 static uint16_t ip_ucast_udp_noack_count;
 static uint16_t ip_ucast_udp_error_count;
 
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+static uint32_t iphc_template_hit_count;
+static uint32_t iphc_template_miss_count;
+#endif
+
+void print_log_sicslowpan()
+{
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  LOG_HCK("iphc_hit %lu iphc_miss %lu |\n",
+          iphc_template_hit_count,
+          iphc_template_miss_count);
+#endif
+}
+
 void reset_log_sicslowpan()
 {
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  iphc_template_hit_count = 0;
+  iphc_template_miss_count = 0;
+#endif
+
   ip_ucast_transmission_count = 0;
   ip_ucast_ok_count = 0;
   ip_ucast_noack_count = 0;
@@ -734,6 +753,119 @@ compress_addr_64(uint8_t bitpos, uip_ipaddr_t *ipaddr, uip_lladdr_t *lladdr)
   }
 }
 
+/*--------------------------------------------------------------------*/
+static uint8_t
+compress_hop_limit(void)
+{
+  /*
+   * Hop limit
+   * if 1: compress, encoding is 01
+   * if 64: compress, encoding is 10
+   * if 255: compress, encoding is 11
+   * else do not compress
+   */
+  switch(UIP_IP_BUF->ttl) {
+    case 1:
+      return SICSLOWPAN_IPHC_TTL_1;
+    case 64:
+      return SICSLOWPAN_IPHC_TTL_64;
+    case 255:
+      return SICSLOWPAN_IPHC_TTL_255;
+    default:
+      *hc06_ptr = UIP_IP_BUF->ttl;
+      hc06_ptr += 1;
+      return SICSLOWPAN_IPHC_TTL_I;
+  }
+}
+/*--------------------------------------------------------------------*/
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+#ifndef HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE
+#define HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE 4
+#endif
+/* Longest inline part covered by a template: CID byte is kept separately,
+ * TF (4) + NH (1) before the hop limit, SRC (16) + DST (16) after it. */
+#define IPHC_TEMPLATE_TF_NH_MAX_LEN 5
+#define IPHC_TEMPLATE_ADDR_MAX_LEN  32
+
+/* Cached IPHC encoding of everything that precedes the transport header
+ * except the hop limit. Keyed by the L2 next hop, both IP addresses,
+ * the version/TC/flow word and the next header: all of them feed the
+ * context lookups and compress_addr_64() decisions. Address contexts are
+ * only set up in sicslowpan_init(), so a template never goes stale. */
+struct iphc_template {
+  linkaddr_t link_destaddr;
+  uip_ipaddr_t srcipaddr;
+  uip_ipaddr_t destipaddr;
+  uint8_t vtc_flow[4];
+  uint8_t proto;
+  uint8_t used;
+  uint8_t iphc0; /* without hop limit bits */
+  uint8_t iphc1;
+  uint8_t cid;
+  uint8_t tf_nh_len;
+  uint8_t addr_len;
+  uint8_t tf_nh[IPHC_TEMPLATE_TF_NH_MAX_LEN];
+  uint8_t addr[IPHC_TEMPLATE_ADDR_MAX_LEN];
+};
+static struct iphc_template iphc_templates[HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE];
+static uint8_t iphc_template_victim;
+/*--------------------------------------------------------------------*/
+static int
+iphc_template_match(const struct iphc_template *t, const linkaddr_t *link_destaddr)
+{
+  return t->used
+    && t->proto == UIP_IP_BUF->proto
+    && memcmp(t->vtc_flow, &UIP_IP_BUF->vtc, sizeof(t->vtc_flow)) == 0
+    && uip_ipaddr_cmp(&t->destipaddr, &UIP_IP_BUF->destipaddr)
+    && uip_ipaddr_cmp(&t->srcipaddr, &UIP_IP_BUF->srcipaddr)
+    && linkaddr_cmp(&t->link_destaddr, link_destaddr);
+}
+/*--------------------------------------------------------------------*/
+static struct iphc_template *
+iphc_template_lookup(const linkaddr_t *link_destaddr)
+{
+  int i;
+  for(i = 0; i < HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE; i++) {
+    if(iphc_template_match(&iphc_templates[i], link_destaddr)) {
+      return &iphc_templates[i];
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+static void
+iphc_template_store(const linkaddr_t *link_destaddr, uint8_t iphc0, uint8_t iphc1,
+                    const uint8_t *tf_nh, uint8_t tf_nh_len,
+                    const uint8_t *addr, uint8_t addr_len)
+{
+  struct iphc_template *t;
+
+  if(tf_nh_len > IPHC_TEMPLATE_TF_NH_MAX_LEN
+     || addr_len > IPHC_TEMPLATE_ADDR_MAX_LEN) {
+    return;
+  }
+
+  /* Round-robin replacement: the working set is the parent, the root
+   * and a handful of link-local neighbors */
+  t = &iphc_templates[iphc_template_victim];
+  iphc_template_victim = (iphc_template_victim + 1) % HCK_SICSLOWPAN_IPHC_TEMPLATE_CACHE_SIZE;
+
+  linkaddr_copy(&t->link_destaddr, link_destaddr);
+  uip_ipaddr_copy(&t->srcipaddr, &UIP_IP_BUF->srcipaddr);
+  uip_ipaddr_copy(&t->destipaddr, &UIP_IP_BUF->destipaddr);
+  memcpy(t->vtc_flow, &UIP_IP_BUF->vtc, sizeof(t->vtc_flow));
+  t->proto = UIP_IP_BUF->proto;
+  t->iphc0 = iphc0 & ~SICSLOWPAN_IPHC_TTL_255;
+  t->iphc1 = iphc1;
+  t->cid = PACKETBUF_IPHC_BUF[2];
+  t->tf_nh_len = tf_nh_len;
+  memcpy(t->tf_nh, tf_nh, tf_nh_len);
+  t->addr_len = addr_len;
+  memcpy(t->addr, addr, addr_len);
+  t->used = 1;
+}
+#endif /* HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE */
+
 /*-------------------------------------------------------------------- */
 /* Uncompress addresses based on a prefix and a postfix with zeroes in
  * between. If the postfix is zero in length it will use the link address
@@ -778,84 +910,22 @@ uncompress_addr(uip_ipaddr_t *ipaddr, uint8_t const prefix[],
 
 /*--------------------------------------------------------------------*/
 /**
- * \brief Compress IP/UDP header
- *
- * This function is called by the 6lowpan code to create a compressed
- * 6lowpan packet in the packetbuf buffer from a full IPv6 packet in the
- * uip_buf buffer.
- *
- *
- * IPHC (RFC 6282)\n
- * http://tools.ietf.org/html/
- *
- * \note We do not support ISA100_UDP header compression
+ * \brief Encode the IPHC fields of the IPv6 header in uip_buf
  *
- * For LOWPAN_UDP compression, we either compress both ports or none.
- * General format with LOWPAN_UDP compression is
- * \verbatim
- *                      1                   2                   3
- *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * |0|1|1|TF |N|HLI|C|S|SAM|M|D|DAM| SCI   | DCI   | comp. IPv6 hdr|
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | compressed IPv6 fields .....                                  |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | LOWPAN_UDP    | non compressed UDP fields ...                 |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * | L4 data ...                                                   |
- * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- * \endverbatim
- * \note The context number 00 is reserved for the link local prefix.
- * For unicast addresses, if we cannot compress the prefix, we neither
- * compress the IID.
- * \param link_destaddr L2 destination address, needed to compress IP
- * dest
- * \return 1 if success, else 0
+ * Writes the CID byte, TF, NH, hop limit and both addresses at hc06_ptr
+ * and adds their bits to *iphc0_ptr and *iphc1_ptr; see
+ * compress_hdr_iphc().
  */
-static int
-compress_hdr_iphc(linkaddr_t *link_destaddr)
+static void
+compress_iphc_fields(linkaddr_t *link_destaddr, uint8_t *iphc0_ptr, uint8_t *iphc1_ptr)
 {
-  uint8_t tmp, iphc0, iphc1, *next_hdr, *next_nhc;
-  int ext_hdr_len;
-  struct uip_udp_hdr *udp_buf;
-
-  if(LOG_DBG_ENABLED) {
-    uint16_t ndx;
-    LOG_DBG("compression: before (%d): ", UIP_IP_BUF->len[1]);
-    for(ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
-      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
-      LOG_DBG_("%02x", data);
-    }
-    LOG_DBG_("\n");
-  }
-
-/* Macro used only internally, during header compression. Checks if there
- * is sufficient space in packetbuf before writing any further. */
-#define CHECK_BUFFER_SPACE(writelen) do { \
-  if(hc06_ptr + (writelen) >= PACKETBUF_PAYLOAD_END) { \
-    LOG_WARN("Not enough packetbuf space to compress header (%u bytes, %u left). Aborting.\n", \
-                (unsigned)(writelen), (unsigned)(PACKETBUF_PAYLOAD_END - hc06_ptr)); \
-    return 0; \
-  } \
-} while(0);
-
-  hc06_ptr = PACKETBUF_IPHC_BUF + 2;
-
-  /* Check if there is enough space for the compressed IPv6 header, in the
-   * worst case (least compressed case). Extension headers and transport
-   * layer will be checked when they are compressed. */
-  CHECK_BUFFER_SPACE(38);
-
-  /*
-   * As we copy some bit-length fields, in the IPHC encoding bytes,
-   * we sometimes use |=
-   * If the field is 0, and the current bit value in memory is 1,
-   * this does not work. We therefore reset the IPHC encoding here
-   */
-
-  iphc0 = SICSLOWPAN_DISPATCH_IPHC;
-  iphc1 = 0;
-  PACKETBUF_IPHC_BUF[2] = 0; /* might not be used - but needs to be cleared */
+  uint8_t tmp;
+  uint8_t iphc0 = *iphc0_ptr;
+  uint8_t iphc1 = *iphc1_ptr;
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  uint8_t *tf_nh_start, *addr_start;
+  uint8_t tf_nh_len;
+#endif
 
   /*
    * Address handling needs to be made first since it might
@@ -875,6 +945,10 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     hc06_ptr++;
   }
 
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  tf_nh_start = hc06_ptr;
+#endif
+
   /*
    * Traffic class, flow label
    * If flow label is 0, compress it. If traffic class is 0, compress it
@@ -932,28 +1006,15 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     hc06_ptr += 1;
   }
 
-  /*
-   * Hop limit
-   * if 1: compress, encoding is 01
-   * if 64: compress, encoding is 10
-   * if 255: compress, encoding is 11
-   * else do not compress
-   */
-  switch(UIP_IP_BUF->ttl) {
-    case 1:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_1;
-      break;
-    case 64:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_64;
-      break;
-    case 255:
-      iphc0 |= SICSLOWPAN_IPHC_TTL_255;
-      break;
-    default:
-      *hc06_ptr = UIP_IP_BUF->ttl;
-      hc06_ptr += 1;
-      break;
-  }
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  tf_nh_len = hc06_ptr - tf_nh_start;
+#endif
+
+  iphc0 |= compress_hop_limit();
+
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  addr_start = hc06_ptr;
+#endif
 
   /* source address - cannot be multicast */
   if(uip_is_addr_unspecified(&UIP_IP_BUF->srcipaddr)) {
@@ -1038,6 +1099,124 @@ compress_hdr_iphc(linkaddr_t *link_destaddr)
     }
   }
 
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  iphc_template_store(link_destaddr, iphc0, iphc1,
+                      tf_nh_start, tf_nh_len,
+                      addr_start, hc06_ptr - addr_start);
+#endif /* HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE */
+
+  *iphc0_ptr = iphc0;
+  *iphc1_ptr = iphc1;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Compress IP/UDP header
+ *
+ * This function is called by the 6lowpan code to create a compressed
+ * 6lowpan packet in the packetbuf buffer from a full IPv6 packet in the
+ * uip_buf buffer.
+ *
+ *
+ * IPHC (RFC 6282)\n
+ * http://tools.ietf.org/html/
+ *
+ * \note We do not support ISA100_UDP header compression
+ *
+ * For LOWPAN_UDP compression, we either compress both ports or none.
+ * General format with LOWPAN_UDP compression is
+ * \verbatim
+ *                      1                   2                   3
+ *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |0|1|1|TF |N|HLI|C|S|SAM|M|D|DAM| SCI   | DCI   | comp. IPv6 hdr|
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | compressed IPv6 fields .....                                  |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | LOWPAN_UDP    | non compressed UDP fields ...                 |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * | L4 data ...                                                   |
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ * \note The context number 00 is reserved for the link local prefix.
+ * For unicast addresses, if we cannot compress the prefix, we neither
+ * compress the IID.
+ * \param link_destaddr L2 destination address, needed to compress IP
+ * dest
+ * \return 1 if success, else 0
+ */
+static int
+compress_hdr_iphc(linkaddr_t *link_destaddr)
+{
+  uint8_t iphc0, iphc1, *next_hdr, *next_nhc;
+  int ext_hdr_len;
+  struct uip_udp_hdr *udp_buf;
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  struct iphc_template *iphc_tmpl;
+#endif
+
+  if(LOG_DBG_ENABLED) {
+    uint16_t ndx;
+    LOG_DBG("compression: before (%d): ", UIP_IP_BUF->len[1]);
+    for(ndx = 0; ndx < UIP_IP_BUF->len[1] + 40; ndx++) {
+      uint8_t data = ((uint8_t *) (UIP_IP_BUF))[ndx];
+      LOG_DBG_("%02x", data);
+    }
+    LOG_DBG_("\n");
+  }
+
+/* Macro used only internally, during header compression. Checks if there
+ * is sufficient space in packetbuf before writing any further. */
+#define CHECK_BUFFER_SPACE(writelen) do { \
+  if(hc06_ptr + (writelen) >= PACKETBUF_PAYLOAD_END) { \
+    LOG_WARN("Not enough packetbuf space to compress header (%u bytes, %u left). Aborting.\n", \
+                (unsigned)(writelen), (unsigned)(PACKETBUF_PAYLOAD_END - hc06_ptr)); \
+    return 0; \
+  } \
+} while(0);
+
+  hc06_ptr = PACKETBUF_IPHC_BUF + 2;
+
+  /* Check if there is enough space for the compressed IPv6 header, in the
+   * worst case (least compressed case). Extension headers and transport
+   * layer will be checked when they are compressed. */
+  CHECK_BUFFER_SPACE(38);
+
+  /*
+   * As we copy some bit-length fields, in the IPHC encoding bytes,
+   * we sometimes use |=
+   * If the field is 0, and the current bit value in memory is 1,
+   * this does not work. We therefore reset the IPHC encoding here
+   */
+
+  iphc0 = SICSLOWPAN_DISPATCH_IPHC;
+  iphc1 = 0;
+  PACKETBUF_IPHC_BUF[2] = 0; /* might not be used - but needs to be cleared */
+
+#if HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE
+  iphc_tmpl = iphc_template_lookup(link_destaddr);
+  if(iphc_tmpl != NULL) {
+    /* Same next hop, addresses, TC/FL and next header as a recent packet:
+     * replay the cached encoding and only patch the hop limit */
+    iphc_template_hit_count++;
+    iphc0 = iphc_tmpl->iphc0;
+    iphc1 = iphc_tmpl->iphc1;
+    if(iphc1 & SICSLOWPAN_IPHC_CID) {
+      PACKETBUF_IPHC_BUF[2] = iphc_tmpl->cid;
+      hc06_ptr++;
+    }
+    memcpy(hc06_ptr, iphc_tmpl->tf_nh, iphc_tmpl->tf_nh_len);
+    hc06_ptr += iphc_tmpl->tf_nh_len;
+    iphc0 |= compress_hop_limit();
+    memcpy(hc06_ptr, iphc_tmpl->addr, iphc_tmpl->addr_len);
+    hc06_ptr += iphc_tmpl->addr_len;
+  } else {
+    iphc_template_miss_count++;
+    compress_iphc_fields(link_destaddr, &iphc0, &iphc1);
+  }
+#else /* HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE */
+  compress_iphc_fields(link_destaddr, &iphc0, &iphc1);
+#endif /* HCK_MOD_SICSLOWPAN_IPHC_TEMPLATE_CACHE */
+
   uncomp_hdr_len = UIP_IPH_LEN;
 
   /* Start of ext hdr compression or UDP compression */
@@ -60,6 +60,7 @@ void mc_callback_new_time_source(const struct tsch_neighbor *old, const struct t
 #endif
 /*--------------------------------------------------------------------*/
 
+void print_log_sicslowpan();
 void reset_log_sicslowpan();
 
 /**
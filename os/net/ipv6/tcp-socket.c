@@ -56,6 +56,88 @@ call_event(struct tcp_socket *s, tcp_socket_event_t event)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+/*
+ * The output stream is a list of segments: application data that is
+ * only referenced, and runs of bytes copied into the output buffer.
+ * Outgoing TCP segments are gathered from them straight into uip_buf.
+ */
+static int
+queue_segment(struct tcp_socket *s, const uint8_t *data, uint16_t len)
+{
+  struct tcp_socket_segment *last;
+
+  if(s->output_segment_count > 0) {
+    last = &s->output_segments[s->output_segment_count - 1];
+    if(data == NULL && last->data == NULL) {
+      last->len += len;
+      return 1;
+    }
+  }
+  if(s->output_segment_count == HCK_TCP_SOCKET_SEGMENTS) {
+    return 0;
+  }
+  s->output_segments[s->output_segment_count].data = data;
+  s->output_segments[s->output_segment_count].len = len;
+  s->output_segment_count++;
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+static void
+gather(struct tcp_socket *s, uint8_t *dst, uint16_t len)
+{
+  const struct tcp_socket_segment *seg;
+  const uint8_t *buffered;
+  uint16_t n;
+
+  buffered = s->output_data_ptr;
+  for(seg = s->output_segments; len > 0; seg++) {
+    n = MIN(len, seg->len);
+    if(seg->data != NULL) {
+      memcpy(dst, seg->data, n);
+    } else {
+      memcpy(dst, buffered, n);
+      buffered += seg->len;
+    }
+    dst += n;
+    len -= n;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+drop_acked(struct tcp_socket *s, uint16_t len)
+{
+  struct tcp_socket_segment *seg;
+  uint16_t buffered;
+  uint16_t n;
+
+  buffered = 0;
+  seg = s->output_segments;
+  while(len > 0 && s->output_segment_count > 0) {
+    n = MIN(len, seg->len);
+    if(seg->data != NULL) {
+      seg->data += n;
+      s->output_ref_len -= n;
+    } else {
+      buffered += n;
+    }
+    seg->len -= n;
+    len -= n;
+    if(seg->len == 0) {
+      s->output_segment_count--;
+      memmove(&s->output_segments[0], &s->output_segments[1],
+              s->output_segment_count * sizeof(*seg));
+    }
+  }
+
+  if(buffered > 0) {
+    memmove(&s->output_data_ptr[0], &s->output_data_ptr[buffered],
+            s->output_data_len - buffered);
+    s->output_data_len -= buffered;
+  }
+}
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
+/*---------------------------------------------------------------------------*/
 static void
 senddata(struct tcp_socket *s)
 {
@@ -64,7 +146,13 @@ senddata(struct tcp_socket *s)
   if(s->output_senddata_len > 0) {
     len = MIN(s->output_senddata_len, len);
     s->output_data_send_nxt = len;
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+    /* Gathered where uip_send() would copy it to */
+    gather(s, uip_appdata, len);
+    uip_send(uip_appdata, len);
+#else /* HCK_MOD_TCP_SOCKET_SEND_REF */
     uip_send(s->output_data_ptr, len);
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -75,6 +163,20 @@ acked(struct tcp_socket *s)
     /* Copy the data in the outputbuf down and update outputbufptr and
        outputbuf_lastsent */
 
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+    if(tcp_socket_queuelen(s) < s->output_data_send_nxt) {
+      PRINTF("tcp: acked assertion failed queued (%d) < s->output_data_send_nxt (%d)\n",
+             tcp_socket_queuelen(s),
+             s->output_data_send_nxt);
+      tcp_markconn(uip_conn, NULL);
+      uip_abort();
+      call_event(s, TCP_SOCKET_ABORTED);
+      relisten(s);
+      return;
+    }
+    drop_acked(s, s->output_data_send_nxt);
+    s->output_senddata_len = tcp_socket_queuelen(s);
+#else /* HCK_MOD_TCP_SOCKET_SEND_REF */
     if(s->output_data_send_nxt > 0) {
       memmove(&s->output_data_ptr[0],
               &s->output_data_ptr[s->output_data_send_nxt],
@@ -92,6 +194,7 @@ acked(struct tcp_socket *s)
     }
     s->output_data_len -= s->output_data_send_nxt;
     s->output_senddata_len = s->output_data_len;
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
     s->output_data_send_nxt = 0;
 
     call_event(s, TCP_SOCKET_DATA_SENT);
@@ -216,7 +319,7 @@ appcall(void *state)
     senddata(s);
   }
 
-  if(s->output_data_len == 0 && s->flags & TCP_SOCKET_FLAGS_CLOSING) {
+  if(tcp_socket_queuelen(s) == 0 && s->flags & TCP_SOCKET_FLAGS_CLOSING) {
     s->flags &= ~TCP_SOCKET_FLAGS_CLOSING;
     uip_close();
     s->c = NULL;
@@ -275,6 +378,11 @@ tcp_socket_register(struct tcp_socket *s, void *ptr,
   s->input_data_ptr = input_databuf;
   s->input_data_maxlen = input_databuf_len;
   s->output_data_len = 0;
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+  s->output_segment_count = 0;
+  s->output_data_send_nxt = 0;
+  s->output_ref_len = 0;
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
   s->output_data_ptr = output_databuf;
   s->output_data_maxlen = output_databuf_len;
   s->input_callback = input_callback;
@@ -350,18 +458,66 @@ tcp_socket_send(struct tcp_socket *s,
 
   len = MIN(datalen, s->output_data_maxlen - s->output_data_len);
 
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+  if(len > 0 && !queue_segment(s, NULL, len)) {
+    return 0;
+  }
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
   memmove(&s->output_data_ptr[s->output_data_len], data, len);
   s->output_data_len += len;
 
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+  /* Pieces queued back to back leave in one segment unless some data
+     is already in flight */
+  if(s->output_data_send_nxt == 0) {
+    s->output_senddata_len = tcp_socket_queuelen(s);
+  }
+#else /* HCK_MOD_TCP_SOCKET_SEND_REF */
   if(s->output_senddata_len == 0) {
     s->output_senddata_len = s->output_data_len;
   }
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
 
   tcpip_poll_tcp(s->c);
 
   return len;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+int
+tcp_socket_send_ref(struct tcp_socket *s,
+                    const uint8_t *data, int datalen)
+{
+  int len;
+
+  if(s == NULL) {
+    return -1;
+  }
+
+  len = MIN(datalen, 0xffff - s->output_data_maxlen - s->output_ref_len);
+  if(len > 0) {
+    if(!queue_segment(s, data, len)) {
+      return -1;
+    }
+    s->output_ref_len += len;
+  }
+
+  if(s->output_data_send_nxt == 0) {
+    s->output_senddata_len = tcp_socket_queuelen(s);
+  }
+
+  tcpip_poll_tcp(s->c);
+
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+int
+tcp_socket_free_segments(struct tcp_socket *s)
+{
+  return HCK_TCP_SOCKET_SEGMENTS - s->output_segment_count;
+}
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
+/*---------------------------------------------------------------------------*/
 int
 tcp_socket_send_str(struct tcp_socket *s,
              const char *str)
@@ -404,6 +560,10 @@ tcp_socket_max_sendlen(struct tcp_socket *s)
 int
 tcp_socket_queuelen(struct tcp_socket *s)
 {
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+  return s->output_data_len + s->output_ref_len;
+#else /* HCK_MOD_TCP_SOCKET_SEND_REF */
   return s->output_data_len;
+#endif /* HCK_MOD_TCP_SOCKET_SEND_REF */
 }
 /*---------------------------------------------------------------------------*/
@@ -80,6 +80,22 @@ typedef void (* tcp_socket_event_callback_t)(struct tcp_socket *s,
                                              void *ptr,
                                              tcp_socket_event_t event);
 
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+/* Pieces of the output stream, referenced or buffered */
+#ifdef HCK_TCP_SOCKET_CONF_SEGMENTS
+#define HCK_TCP_SOCKET_SEGMENTS HCK_TCP_SOCKET_CONF_SEGMENTS
+#else
+#define HCK_TCP_SOCKET_SEGMENTS 8
+#endif
+
+/* The next len bytes of the output stream: application data if data
+ * is set, the next len bytes of the output buffer otherwise */
+struct tcp_socket_segment {
+  const uint8_t *data;
+  uint16_t len;
+};
+#endif
+
 struct tcp_socket {
   struct tcp_socket *next;
 
@@ -99,6 +115,11 @@ struct tcp_socket {
   uint16_t output_data_send_nxt;
   uint16_t output_senddata_len;
   uint16_t output_data_max_seg;
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+  struct tcp_socket_segment output_segments[HCK_TCP_SOCKET_SEGMENTS];
+  uint8_t output_segment_count;
+  uint16_t output_ref_len;
+#endif
 
   uint8_t flags;
   uint16_t listen_port;
@@ -229,6 +250,32 @@ int tcp_socket_send(struct tcp_socket *s,
                     const uint8_t *dataptr,
                     int datalen);
 
+#if HCK_MOD_TCP_SOCKET_SEND_REF
+/**
+ * \brief      Send data on a connected TCP socket without copying it
+ * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
+ * \param dataptr A pointer to the data to be sent
+ * \param datalen The length of the data to be sent
+ * \retval -1  If no segment is left to reference the data
+ * \return     The number of bytes that were queued
+ *
+ *             The data is queued after the data sent before, and
+ *             copied straight into the outgoing TCP segments. It
+ *             must stay unchanged until tcp_socket_queuelen() no
+ *             longer counts it, as retransmissions read it again.
+ */
+int tcp_socket_send_ref(struct tcp_socket *s,
+                        const uint8_t *dataptr,
+                        int datalen);
+
+/**
+ * \brief      The number of tcp_socket_send() and tcp_socket_send_ref() calls that can be queued
+ * \param s    A pointer to a TCP socket
+ * \return     The number of free output segments, at least
+ */
+int tcp_socket_free_segments(struct tcp_socket *s);
+#endif
+
 /**
  * \brief      Send a string on a connected TCP socket
  * \param s    A pointer to a TCP socket that must have been previously registered with tcp_socket_register()
@@ -73,6 +73,10 @@
 /* Per-neighbor link statistics table */
 NBR_TABLE(struct link_stats, link_stats);
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+uint16_t link_stats_generation;
+#endif
+
 /* Called at a period of FRESHNESS_HALF_LIFE */
 struct ctimer periodic_timer;
 
@@ -156,6 +160,9 @@ link_stats_packet_sent(const linkaddr_t *lladdr, int status, int numtx)
     /* Add the neighbor */
     stats = nbr_table_add_lladdr(link_stats, lladdr, NBR_TABLE_REASON_LINK_STATS, NULL);
     if(stats != NULL) {
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+      link_stats_generation++;
+#endif
 #if LINK_STATS_INIT_ETX_FROM_RSSI
       stats->etx = guess_etx_from_rssi(stats);
 #else /* LINK_STATS_INIT_ETX_FROM_RSSI */
@@ -231,6 +238,9 @@ link_stats_input_callback(const linkaddr_t *lladdr)
     /* Add the neighbor */
     stats = nbr_table_add_lladdr(link_stats, lladdr, NBR_TABLE_REASON_LINK_STATS, NULL);
     if(stats != NULL) {
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+      link_stats_generation++;
+#endif
       /* Initialize */
       stats->rssi = packet_rssi;
 #if LINK_STATS_INIT_ETX_FROM_RSSI
@@ -301,6 +311,9 @@ void
 link_stats_reset(void)
 {
   struct link_stats *stats;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  link_stats_generation++;
+#endif
   stats = nbr_table_head(link_stats);
   while(stats != NULL) {
     nbr_table_remove(link_stats, stats);
@@ -92,6 +92,13 @@ struct link_stats {
 #endif
 };
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+/* Bumped whenever an entry is (re)created or the table is reset. Users
+ * caching a metric derived from an entry compare it to tell whether the
+ * entry they read it from is still the same. */
+extern uint16_t link_stats_generation;
+#endif
+
 /* Returns the neighbor's link statistics */
 const struct link_stats *link_stats_from_lladdr(const linkaddr_t *lladdr);
 /* Returns the address of the neighbor */
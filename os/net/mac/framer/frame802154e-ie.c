@@ -73,6 +73,9 @@ enum ieee802154e_payload_ie_id {
 enum ieee802154e_mlme_short_subie_id {
 #if HCK_MOD_TSCH_PIGGYBACKING_EB_IE_32BITS
   MLME_SHORT_IE_HCK_PIGGYBACKING = 0x10,
+#endif
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  MLME_SHORT_IE_HCK_LINK_BLACKLIST = 0x11,
 #endif
   MLME_SHORT_IE_TSCH_SYNCHRONIZATION = 0x1a,
   MLME_SHORT_IE_TSCH_SLOFTRAME_AND_LINK,
@@ -294,6 +297,36 @@ frame80215e_create_ie_eb_hck_piggybacking(uint8_t *buf, int len,
 }
 #endif
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/* MLME sub-IE. Per-link channel blacklist. Used in EBs */
+int
+frame80215e_create_ie_eb_hck_link_blacklist(uint8_t *buf, int len,
+    struct ieee802154_ies *ies)
+{
+  int i;
+  int ie_len;
+  if(ies == NULL || ies->ie_lcb_num_entries > HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES) {
+    return -1;
+  }
+  ie_len = 6 + 8 * ies->ie_lcb_num_entries;
+  if(len >= 2 + ie_len) {
+    WRITE16(buf+2, ies->ie_lcb_rx_map);
+    WRITE16(buf+4, ies->ie_lcb_rx_next_map);
+    WRITE16(buf+6, ies->ie_lcb_rx_next_epoch);
+    for(i = 0; i < ies->ie_lcb_num_entries; i++) {
+      WRITE16(buf+8+8*i, ies->ie_lcb_entry_id[i]);
+      WRITE16(buf+10+8*i, ies->ie_lcb_entry_map[i]);
+      WRITE16(buf+12+8*i, ies->ie_lcb_entry_next_map[i]);
+      WRITE16(buf+14+8*i, ies->ie_lcb_entry_next_epoch[i]);
+    }
+    create_mlme_short_ie_descriptor(buf, MLME_SHORT_IE_HCK_LINK_BLACKLIST, ie_len);
+    return 2 + ie_len;
+  } else {
+    return -1;
+  }
+}
+#endif
+
 /* MLME sub-IE. TSCH slotframe and link. Used in EBs: initial schedule */
 int
 frame80215e_create_ie_tsch_slotframe_and_link(uint8_t *buf, int len,
@@ -507,6 +540,28 @@ frame802154e_parse_mlme_short_ie(const uint8_t *buf, int len,
         return len;
       }
       break;
+#endif
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+    case MLME_SHORT_IE_HCK_LINK_BLACKLIST:
+      if(len >= 6 && (len - 6) % 8 == 0
+         && (len - 6) / 8 <= HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES) {
+        if(ies != NULL) {
+          int i;
+          ies->ie_lcb_present = 1;
+          READ16(buf, ies->ie_lcb_rx_map);
+          READ16(buf+2, ies->ie_lcb_rx_next_map);
+          READ16(buf+4, ies->ie_lcb_rx_next_epoch);
+          ies->ie_lcb_num_entries = (len - 6) / 8;
+          for(i = 0; i < ies->ie_lcb_num_entries; i++) {
+            READ16(buf+6+8*i, ies->ie_lcb_entry_id[i]);
+            READ16(buf+8+8*i, ies->ie_lcb_entry_map[i]);
+            READ16(buf+10+8*i, ies->ie_lcb_entry_next_map[i]);
+            READ16(buf+12+8*i, ies->ie_lcb_entry_next_epoch[i]);
+          }
+        }
+        return len;
+      }
+      break;
 #endif
   }
   return -1;
@@ -51,6 +51,13 @@
 
 #define FRAME802154E_IE_MAX_LINKS       4
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/* Number of children an EB can carry a receive blacklist for */
+#ifndef HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES
+#define HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES 3
+#endif
+#endif
+
 /* Structures used for the Slotframe and Links information element */
 struct tsch_slotframe_and_links_link {
   uint16_t timeslot;
@@ -81,6 +88,19 @@ struct ieee802154_ies {
 #if HCK_MOD_TSCH_PIGGYBACKING_EB_IE_32BITS
   uint16_t ie_eb_piggybacking_info_1;
   uint16_t ie_eb_piggybacking_info_2;
+#endif
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  /* Receive blacklist of the sender (active, next and the epoch the next
+   * one takes effect), followed by the blacklists it set for its children */
+  uint8_t ie_lcb_present;
+  uint16_t ie_lcb_rx_map;
+  uint16_t ie_lcb_rx_next_map;
+  uint16_t ie_lcb_rx_next_epoch;
+  uint8_t ie_lcb_num_entries;
+  uint16_t ie_lcb_entry_id[HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES];
+  uint16_t ie_lcb_entry_map[HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES];
+  uint16_t ie_lcb_entry_next_map[HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES];
+  uint16_t ie_lcb_entry_next_epoch[HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES];
 #endif
   uint8_t ie_tsch_synchronization_offset;
   struct tsch_asn_t ie_asn;
@@ -145,6 +165,12 @@ int frame80215e_create_ie_eb_hck_piggybacking(uint8_t *buf, int len,
     struct ieee802154_ies *ies);
 #endif
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/* MLME sub-IE. Per-link channel blacklist. Used in EBs */
+int frame80215e_create_ie_eb_hck_link_blacklist(uint8_t *buf, int len,
+    struct ieee802154_ies *ies);
+#endif
+
 /* Parse all Information Elements of a frame */
 int frame802154e_parse_information_elements(const uint8_t *buf, uint8_t buf_size,
     struct ieee802154_ies *ies);
@@ -332,6 +332,10 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   }
 #endif /* TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK */
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  tsch_stats_lcb_fill_eb_ies(&ies);
+#endif
+
   p = packetbuf_dataptr();
 
   ie_len = frame80215e_create_ie_tsch_synchronization(p,
@@ -381,6 +385,18 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
   p += ie_len;
   packetbuf_set_datalen(packetbuf_datalen() + ie_len);
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  /* Placed last, its length varies and the IEs before it are updated in place */
+  ie_len = frame80215e_create_ie_eb_hck_link_blacklist(p,
+                                                       packetbuf_remaininglen(),
+                                                       &ies);
+  if(ie_len < 0) {
+    return -1;
+  }
+  p += ie_len;
+  packetbuf_set_datalen(packetbuf_datalen() + ie_len);
+#endif
+
 #if 0
   /* Payload IE list termination: optional */
   ie_len = frame80215e_create_ie_payload_list_termination(p,
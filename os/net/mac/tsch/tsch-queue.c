@@ -98,6 +98,13 @@ struct tsch_neighbor *n_eb;
 static struct ctimer ost_select_N_timer;
 #endif
 
+#if HCK_MOD_RPL_CONTROL_SHAPER
+#if !HCK_FORMATION_PACKET_TYPE_INFO
+#error "HCK_MOD_RPL_CONTROL_SHAPER requires HCK_FORMATION_PACKET_TYPE_INFO (hck_current_packet_type)"
+#endif
+uint32_t tsch_queue_ctrl_merged_count;
+#endif
+
 /*---------------------------------------------------------------------------*/
 #if WITH_QUICK6 && QUICK6_CRITICALITY_BASED_PACKET_SELECTION
 /* Remove specific packet from ringbuf and return pointer address of the packet 
@@ -108,48 +115,71 @@ quick6_tsch_queue_remove_specific_packet_from_queue(struct tsch_neighbor *n, str
 /*---------------------------------------------------------------------------*/
 #if HCK_MOD_TSCH_OFFLOAD_UCAST_PACKET_FOR_NON_RPL_NBR \
     || HCK_MOD_TSCH_OFFLOAD_UCAST_PACKET_FOR_RPL_NBR
-void
-tsch_queue_change_attr_of_packets_in_queue(struct tsch_neighbor *target_nbr, 
-                                           uint16_t sf_handle, uint16_t timeslot)
+static void
+change_attr_of_packets_in_queue(struct tsch_neighbor *target_nbr,
+                                uint16_t sf_handle, uint16_t timeslot)
 {
-  if(target_nbr == NULL) {
-    /* we do not have packets to change */
-    return;
-  }
-
   int16_t get_index = 0;
   uint8_t num_elements = 0;
 
-  if(!tsch_is_locked()) {
-
-    if(sf_handle == TSCH_SCHED_UNICAST_SF_HANDLE) {
-      tsch_queue_backoff_reset(target_nbr);
+  if(sf_handle == TSCH_SCHED_UNICAST_SF_HANDLE) {
+    tsch_queue_backoff_reset(target_nbr);
 #if WITH_QUICK6 && QUICK6_PER_SLOTFRAME_BACKOFF
-      quick6_tsch_queue_cssf_backoff_reset(target_nbr);
+    quick6_tsch_queue_cssf_backoff_reset(target_nbr);
 #endif
-    }
+  }
+
+  get_index = ringbufindex_peek_get(&target_nbr->tx_ringbuf);
+  num_elements = ringbufindex_elements(&target_nbr->tx_ringbuf);
 
-    get_index = ringbufindex_peek_get(&target_nbr->tx_ringbuf);
-    num_elements = ringbufindex_elements(&target_nbr->tx_ringbuf);
+  if(get_index == -1) {
+    return;
+  }
+  
+  uint8_t i;
+  for(i = get_index; i < get_index + num_elements; i++) {
+    int16_t index;
 
-    if(get_index == -1) {
-      return;
+    if(i >= ringbufindex_size(&target_nbr->tx_ringbuf)) { /* default size: 16 */
+      index = i - ringbufindex_size(&target_nbr->tx_ringbuf);
+    } else {
+      index = i;
     }
-    
-    uint8_t i;
-    for(i = get_index; i < get_index + num_elements; i++) {
-      int16_t index;
 
-      if(i >= ringbufindex_size(&target_nbr->tx_ringbuf)) { /* default size: 16 */
-        index = i - ringbufindex_size(&target_nbr->tx_ringbuf);
-      } else {
-        index = i;
-      }
+    queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
+    queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
+  }
+}
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+static void
+change_attr_request_apply(const struct tsch_request *req)
+{
+  struct tsch_neighbor *n = tsch_queue_get_nbr(&req->addr);
+  if(n != NULL) {
+    change_attr_of_packets_in_queue(n, req->arg1, req->arg2);
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
+void
+tsch_queue_change_attr_of_packets_in_queue(struct tsch_neighbor *target_nbr, 
+                                           uint16_t sf_handle, uint16_t timeslot)
+{
+  if(target_nbr == NULL) {
+    /* we do not have packets to change */
+    return;
+  }
 
-      queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME, sf_handle);
-      queuebuf_update_attr(target_nbr->tx_array[index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT, timeslot);
-    }
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+  /* Packets and backoff are also updated by slot operation, let it apply the change */
+  tsch_request_post(change_attr_request_apply, tsch_queue_get_nbr_address(target_nbr),
+                    sf_handle, timeslot);
+#else
+  if(!tsch_is_locked()) {
+    change_attr_of_packets_in_queue(target_nbr, sf_handle, timeslot);
   }
+#endif
 }
 #endif
 /*---------------------------------------------------------------------------*/
@@ -329,6 +359,20 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
   return n;
 }
 /*---------------------------------------------------------------------------*/
+/* Get the first TSCH neighbor */
+struct tsch_neighbor *
+tsch_queue_first_nbr(void)
+{
+  return (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+}
+/*---------------------------------------------------------------------------*/
+/* Get the next TSCH neighbor */
+struct tsch_neighbor *
+tsch_queue_next_nbr(struct tsch_neighbor *neighbor)
+{
+  return (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, neighbor);
+}
+/*---------------------------------------------------------------------------*/
 /* Get a TSCH neighbor */
 struct tsch_neighbor *
 tsch_queue_get_nbr(const linkaddr_t *addr)
@@ -454,6 +498,53 @@ tsch_queue_remove_nbr(struct tsch_neighbor *n)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_RPL_CONTROL_SHAPER && !(WITH_QUICK6 && QUICK6_DUPLICATE_PACKET_MANAGEMENT)
+/* Returns the ringbuf index of the oldest packet of the given type in the queue, -1 if none */
+static int16_t
+tsch_queue_find_packet_of_type(const struct tsch_neighbor *n, uint8_t type)
+{
+  int16_t get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+  int16_t num_elements = ringbufindex_elements(&n->tx_ringbuf);
+  int16_t i;
+
+  if(get_index == -1) {
+    return -1;
+  }
+  for(i = 0; i < num_elements; i++) {
+    int16_t index = (get_index + i) % ringbufindex_size(&n->tx_ringbuf);
+    if(n->tx_array[index]->hck_packet_type == type) {
+      return index;
+    }
+  }
+  return -1;
+}
+/*---------------------------------------------------------------------------*/
+/* Replace a queued packet of the same type as p with p, keeping its position in the ringbuf.
+ * Done under the TSCH lock so that the slot operation is not using the stale packet. */
+static int
+tsch_queue_replace_packet_of_type(struct tsch_neighbor *n, struct tsch_packet *p)
+{
+  int16_t index;
+  struct tsch_packet *stale_packet;
+
+  if(!tsch_get_lock()) {
+    return 0;
+  }
+  index = tsch_queue_find_packet_of_type(n, p->hck_packet_type);
+  if(index == -1) {
+    tsch_release_lock();
+    return 0;
+  }
+  stale_packet = n->tx_array[index];
+  n->tx_array[index] = p;
+  tsch_release_lock();
+
+  tsch_queue_free_packet(stale_packet);
+  tsch_queue_ctrl_merged_count++;
+  return 1;
+}
+#endif
+/*---------------------------------------------------------------------------*/
 /* Add packet to neighbor queue. Use same lockfree implementation as ringbuf.c (put is atomic) */
 struct tsch_packet *
 tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
@@ -591,11 +682,20 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
       } else {
         put_index = ringbufindex_peek_put(&n->tx_ringbuf);
       }
+#elif HCK_MOD_RPL_CONTROL_SHAPER
+      /* A newer multicast DIO supersedes a stale one still waiting in the queue */
+      uint8_t shaper_merge = hck_current_packet_type == HCK_PACKET_TYPE_M_DIO
+                             && tsch_queue_find_packet_of_type(n, HCK_PACKET_TYPE_M_DIO) != -1;
+      put_index = ringbufindex_peek_put(&n->tx_ringbuf);
 #else
       put_index = ringbufindex_peek_put(&n->tx_ringbuf);
 #endif
 
+#if !(WITH_QUICK6 && QUICK6_DUPLICATE_PACKET_MANAGEMENT) && HCK_MOD_RPL_CONTROL_SHAPER
+      if(put_index != -1 || shaper_merge) {
+#else
       if(put_index != -1) {
+#endif
         p = memb_alloc(&packet_memb);
         if(p != NULL) {
           /* Enqueue packet */
@@ -649,12 +749,24 @@ tsch_queue_add_packet(const linkaddr_t *addr, uint8_t max_transmissions,
 #endif
 
             /* Add to ringbuf (actual add committed through atomic operation) */
-            n->tx_array[put_index] = p;
 #if WITH_QUICK6 && QUICK6_DUPLICATE_PACKET_MANAGEMENT
+            n->tx_array[put_index] = p;
             if(!quick6_same_type_packet_exist_or_not) {
               ringbufindex_put(&n->tx_ringbuf);
             }
+#elif HCK_MOD_RPL_CONTROL_SHAPER
+            if(!(shaper_merge && tsch_queue_replace_packet_of_type(n, p))) {
+              if(put_index == -1) {
+                /* The stale packet left the queue meanwhile and there is no room for p */
+                queuebuf_free(p->qb);
+                memb_free(&packet_memb, p);
+                return NULL;
+              }
+              n->tx_array[put_index] = p;
+              ringbufindex_put(&n->tx_ringbuf);
+            }
 #else
+            n->tx_array[put_index] = p;
             ringbufindex_put(&n->tx_ringbuf);
 #endif
             LOG_DBG("packet is added put_index %u, packet %p\n",
@@ -719,6 +831,34 @@ tsch_queue_nbr_packet_count(const struct tsch_neighbor *n)
   return -1;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_RPL_CONTROL_SHAPER
+/* Returns the number of packets of a given type currently in the queue */
+int
+tsch_queue_nbr_packet_type_count(const struct tsch_neighbor *n, uint8_t type)
+{
+  int16_t get_index;
+  int16_t num_elements;
+  int16_t i;
+  int count = 0;
+
+  if(n == NULL) {
+    return -1;
+  }
+  get_index = ringbufindex_peek_get(&n->tx_ringbuf);
+  num_elements = ringbufindex_elements(&n->tx_ringbuf);
+  if(get_index == -1) {
+    return 0;
+  }
+  for(i = 0; i < num_elements; i++) {
+    int16_t index = (get_index + i) % ringbufindex_size(&n->tx_ringbuf);
+    if(n->tx_array[index]->hck_packet_type == type) {
+      count++;
+    }
+  }
+  return count;
+}
+#endif
+/*---------------------------------------------------------------------------*/
 #if WITH_QUICK6 && QUICK6_CRITICALITY_BASED_PACKET_SELECTION
 /* Remove specific packet from ringbuf and return pointer address of the packet 
  * To completely remove the packet, run tsch_queue_free_packet() after this. */
@@ -1107,6 +1247,13 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
         }
 #endif
 
+#if HCK_MOD_TSCH_RX_SKIP
+        /* The receiver is not listening on this occurrence of the cell */
+        if(!n->is_broadcast && !tsch_schedule_rx_skip_is_awake(&n->rx_skip, link)) {
+          return NULL;
+        }
+#endif
+
 #if TSCH_WITH_LINK_SELECTOR
 #if WITH_OST && OST_ON_DEMAND_PROVISION
         if(link->slotframe_handle > SSQ_SCHEDULE_HANDLE_OFFSET && link->link_options == LINK_OPTION_TX) {
@@ -53,6 +53,11 @@
 extern struct tsch_neighbor *n_broadcast;
 extern struct tsch_neighbor *n_eb;
 
+#if HCK_MOD_RPL_CONTROL_SHAPER
+/* Number of stale control packets replaced in place by a newer one */
+extern uint32_t tsch_queue_ctrl_merged_count;
+#endif
+
 /********** Functions *********/
 #if WITH_TRGB
 struct tsch_packet *tsch_queue_get_packet_for_trgb(struct tsch_neighbor **n, struct tsch_link *link, 
@@ -94,6 +99,17 @@ void quick6_tsch_queue_update_all_cssf_backoff_windows(const linkaddr_t *dest_ad
  * \param addr The link-layer address of the neighbor to be added
  */
 struct tsch_neighbor *tsch_queue_add_nbr(const linkaddr_t *addr);
+/**
+ * \brief Get the first TSCH neighbor
+ * \return The first neighbor queue, NULL if there are none
+ */
+struct tsch_neighbor *tsch_queue_first_nbr(void);
+/**
+ * \brief Get the next TSCH neighbor
+ * \param neighbor The previous neighbor queue
+ * \return The next neighbor queue, NULL if there are no more
+ */
+struct tsch_neighbor *tsch_queue_next_nbr(struct tsch_neighbor *neighbor);
 /**
  * \brief Get a TSCH neighbor
  * \param addr The link-layer address of the neighbor we are looking for
@@ -136,6 +152,15 @@ int tsch_queue_global_packet_count(void);
  * \return The number of packets in the neighbor's queue
  */
 int tsch_queue_nbr_packet_count(const struct tsch_neighbor *n);
+#if HCK_MOD_RPL_CONTROL_SHAPER
+/**
+ * \brief Returns the number of packets of a given HCK_PACKET_TYPE in a neighbor queue
+ * \param n The neighbor we are interested in
+ * \param type The packet type (see tsch-types.h)
+ * \return The number of matching packets, -1 if n is NULL
+ */
+int tsch_queue_nbr_packet_type_count(const struct tsch_neighbor *n, uint8_t type);
+#endif
 /**
  * \brief Remove first packet from a neighbor queue. The packet is stored in a separate
  * dequeued packet list, for later processing.
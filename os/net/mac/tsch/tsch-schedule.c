@@ -714,6 +714,9 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         l->slotframe_handle = slotframe->handle;
         l->timeslot = timeslot;
         l->channel_offset = channel_offset;
+#if HCK_MOD_TSCH_RX_SKIP
+        l->rx_skip.seen = 0;
+#endif
         l->data = NULL;
         if(address == NULL) {
           address = &linkaddr_null;
@@ -824,6 +827,9 @@ alice_tsch_schedule_add_link(struct tsch_slotframe *slotframe,
         l->slotframe_handle = slotframe->handle;
         l->timeslot = timeslot;
         l->channel_offset = channel_offset;
+#if HCK_MOD_TSCH_RX_SKIP
+        l->rx_skip.seen = 0;
+#endif
         l->data = NULL;
         if(address == NULL) {
           address = &linkaddr_null;
@@ -1840,4 +1846,88 @@ ost_tsch_schedule_get_slotframe_head(void)
 }
 #endif
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_TSCH_RX_SKIP
+#ifdef ALICE_TIME_VARYING_SCHEDULING
+/* ALICE re-creates its unicast links every slotframe, the receiver
+ * keeps a single state for the whole slotframe instead */
+static struct tsch_rx_skip alice_rx_skip;
+#endif
+/*---------------------------------------------------------------------------*/
+struct tsch_rx_skip *
+tsch_schedule_rx_skip_of_link(struct tsch_link *link)
+{
+#ifdef ALICE_TIME_VARYING_SCHEDULING
+  return &alice_rx_skip;
+#else
+  return &link->rx_skip;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_schedule_rx_skip_mark(struct tsch_rx_skip *s)
+{
+  s->last_asn = tsch_current_asn.ls4b;
+  s->seen = 1;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_schedule_rx_skip_is_awake(const struct tsch_rx_skip *s, const struct tsch_link *link)
+{
+  struct tsch_slotframe *sf;
+  uint32_t idle_cycles;
+  uint8_t level = HCK_TSCH_RX_SKIP_MAX_LEVEL;
+
+  if(link->slotframe_handle != HCK_TSCH_RX_SKIP_SF_HANDLE) {
+    return 1;
+  }
+  sf = tsch_schedule_get_slotframe_by_handle(link->slotframe_handle);
+  if(sf == NULL) {
+    return 1;
+  }
+
+  /* Both ends derive the level from the ASN of the same ACKed frame.
+   * The receiver may have heard more recently than the sender knows
+   * (lost ACK), which only gives it a lower level, i.e. more wake-ups */
+  if(s->seen) {
+    idle_cycles = (tsch_current_asn.ls4b - s->last_asn) / sf->size.val;
+    if(idle_cycles / HCK_TSCH_RX_SKIP_IDLE_CYCLES < HCK_TSCH_RX_SKIP_MAX_LEVEL) {
+      level = idle_cycles / HCK_TSCH_RX_SKIP_IDLE_CYCLES;
+    }
+  }
+
+  /* At level L, only every 2^L-th occurrence of the cell is used */
+  return (TSCH_ASN_DIVISION(tsch_current_asn, sf->size) & ((1 << level) - 1)) == 0;
+}
+#endif /* HCK_MOD_TSCH_RX_SKIP */
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+uint16_t
+tsch_schedule_get_slots_to_next_tx(const linkaddr_t *addr)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint16_t timeslot;
+  uint16_t slots;
+  uint16_t best = 0;
+
+  for(sf = list_head(slotframe_list); sf != NULL; sf = list_item_next(sf)) {
+    timeslot = TSCH_ASN_MOD(tsch_current_asn, sf->size);
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if((l->link_options & LINK_OPTION_TX)
+         && l->link_type != LINK_TYPE_ADVERTISING_ONLY
+         && (linkaddr_cmp(&l->addr, addr)
+             || linkaddr_cmp(&l->addr, &tsch_broadcast_address))) {
+        slots = l->timeslot > timeslot ? l->timeslot - timeslot
+                                       : sf->size.val - timeslot + l->timeslot;
+        if(best == 0 || slots < best) {
+          best = slots;
+        }
+      }
+    }
+  }
+
+  return best;
+}
+#endif /* HCK_MOD_COAP_NOTIFY_COALESCING */
+/*---------------------------------------------------------------------------*/
 /** @} */
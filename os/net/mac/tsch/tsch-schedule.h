@@ -180,6 +180,58 @@ struct tsch_slotframe *tsch_schedule_slotframe_head(void);
  */
 struct tsch_slotframe *tsch_schedule_slotframe_next(struct tsch_slotframe *sf);
 
+#if HCK_MOD_TSCH_RX_SKIP
+/* Slotframe whose Rx cells are skipped when idle (none with the
+ * 6TiSCH minimal schedule, which has shared cells only) */
+#ifndef HCK_TSCH_RX_SKIP_SF_HANDLE
+#ifdef TSCH_SCHED_UNICAST_SF_HANDLE
+#define HCK_TSCH_RX_SKIP_SF_HANDLE TSCH_SCHED_UNICAST_SF_HANDLE
+#else
+#define HCK_TSCH_RX_SKIP_SF_HANDLE 0xffff
+#endif
+#endif
+/* Idle slotframe cycles after which the receiver skips one more
+ * occurrence out of two */
+#ifndef HCK_TSCH_RX_SKIP_IDLE_CYCLES
+#define HCK_TSCH_RX_SKIP_IDLE_CYCLES 8
+#endif
+/* At most, the receiver listens every 2^HCK_TSCH_RX_SKIP_MAX_LEVEL cycles */
+#ifndef HCK_TSCH_RX_SKIP_MAX_LEVEL
+#define HCK_TSCH_RX_SKIP_MAX_LEVEL 2
+#endif
+
+/**
+ * \brief The receiver-side Rx-skip state of a link
+ * \param link The Rx link
+ * \return The state to check and update for this link
+ */
+struct tsch_rx_skip *tsch_schedule_rx_skip_of_link(struct tsch_link *link);
+/**
+ * \brief Record an ACKed unicast exchange at the current ASN
+ * \param s The state of the Rx link (receiver) or of the neighbor (sender)
+ */
+void tsch_schedule_rx_skip_mark(struct tsch_rx_skip *s);
+/**
+ * \brief Is the receiver listening on the current occurrence of a link?
+ * Deterministic in the ASN and in the last ACKed exchange, so that
+ * the sender can predict it.
+ * \param s The state of the Rx link (receiver) or of the neighbor (sender)
+ * \param link The link of the current slot
+ * \return 1 if the cell is used, 0 if it is skipped
+ */
+int tsch_schedule_rx_skip_is_awake(const struct tsch_rx_skip *s, const struct tsch_link *link);
+#endif
+
+#if HCK_MOD_COAP_NOTIFY_COALESCING
+/**
+ * \brief Timeslots from the current ASN to the next Tx link usable
+ * towards a neighbor, i.e. dedicated to it or shared
+ * \param addr The MAC address of the neighbor
+ * \return The number of timeslots (1 for the next one), 0 if there is no such link
+ */
+uint16_t tsch_schedule_get_slots_to_next_tx(const linkaddr_t *addr);
+#endif
+
 #if WITH_OST && OST_ON_DEMAND_PROVISION
 struct ost_ssq_schedule_t {
   struct tsch_link link;
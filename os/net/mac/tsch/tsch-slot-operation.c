@@ -81,6 +81,14 @@
 #include "lib/random.h"
 #endif
 
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+#include <string.h>
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+#include "sys/energest.h"
+#endif
+
 #include "sys/log.h"
 /* TSCH debug macros, i.e. to set LEDs or GPIOs on various TSCH
  * timeslot events */
@@ -247,6 +255,23 @@ static int burst_link_scheduled_count = 0;
 static int burst_link_tx = 0;
 static int burst_link_rx = 0;
 #endif
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+#if !MODIFIED_TSCH_DEFAULT_BURST_TRANSMISSION || !TSCH_DBT_HOLD_CURRENT_NBR \
+    || !HCK_FORMATION_PACKET_TYPE_INFO || !HCK_MOD_TSCH_PIGGYBACKING_HEADER_IE_32BITS
+#error "TSCH_DBT_MULTI_CELL_RESERVATION requires MODIFIED_TSCH_DEFAULT_BURST_TRANSMISSION, TSCH_DBT_HOLD_CURRENT_NBR and header IE piggybacking"
+#endif
+#if WITH_DRA || WITH_OST
+#error "TSCH_DBT_MULTI_CELL_RESERVATION uses the lower byte of the second header IE field, also used by DRA and OST"
+#endif
+/* Burst cells reserved at both ends and not started yet */
+static uint8_t dbt_reserved_slots = 0;
+/* Burst cells requested by the current Tx packet (0: no burst request) */
+static uint8_t dbt_tx_requested_len = 0;
+/* Burst cells requested by the current Rx packet */
+static uint8_t dbt_rx_requested_len = 0;
+/* Upper bound of the next request: increased on grant, halved on deny */
+static uint8_t dbt_request_limit = TSCH_BURST_MAX_LEN - 1;
+#endif
 #endif
 /* Counts the length of the current burst */
 int tsch_current_burst_count = 0;
@@ -275,6 +300,27 @@ static uint16_t hck_curr_passed_timeslots_except_first_slot;
 static uint16_t hck_timeslot_diff_at_the_end;
 #endif
 
+#if HCK_LOG_TSCH_SLOT_ENERGY
+#if !ENERGEST_CONF_ON
+#error "HCK_LOG_TSCH_SLOT_ENERGY requires energest (simple-energest module)"
+#endif
+/* Outcome of the current cell, set by tsch_tx_slot/tsch_rx_slot */
+static uint8_t slot_energy_outcome;
+/* Energest radio time (listen + transmit) at the start of the current slot */
+static uint64_t slot_energy_radio_start;
+#endif
+
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/* Only the unicast slotframe follows per-link blacklists: both ends of its
+ * cells know who the receiver is, shared and broadcast cells do not */
+#ifndef HCK_TSCH_LINK_BLACKLIST_SLOTFRAME_HANDLE
+#ifdef TSCH_SCHED_UNICAST_SF_HANDLE
+#define HCK_TSCH_LINK_BLACKLIST_SLOTFRAME_HANDLE TSCH_SCHED_UNICAST_SF_HANDLE
+#else
+#define HCK_TSCH_LINK_BLACKLIST_SLOTFRAME_HANDLE 2
+#endif
+#endif
+#endif
 
 /*---------------------------------------------------------------------------*/
 struct tsch_asn_t tsch_last_valid_asn;
@@ -1326,6 +1372,69 @@ tsch_release_lock(void)
   tsch_locked = 0;
 }
 
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+/* Requests to mutate TSCH state, posted from process context and applied by
+ * the slot operation at the end of a slot. The process is the only producer
+ * and the slot operation the only consumer while associated, so the ring
+ * needs no lock. */
+static struct tsch_request request_array[HCK_TSCH_REQUEST_QUEUE_LEN];
+static struct ringbufindex request_ringbuf = { HCK_TSCH_REQUEST_QUEUE_LEN - 1, 0, 0 };
+
+uint32_t tsch_request_post_count;
+uint32_t tsch_request_full_count;
+
+/* Apply all pending requests, in order */
+static void
+tsch_request_apply_pending(void)
+{
+  int16_t index;
+
+  while((index = ringbufindex_peek_get(&request_ringbuf)) != -1) {
+    request_array[index].apply(&request_array[index]);
+    ringbufindex_get(&request_ringbuf);
+  }
+}
+
+int
+tsch_request_post(void (*apply)(const struct tsch_request *),
+                  const linkaddr_t *addr, uint16_t arg1, uint16_t arg2)
+{
+  struct tsch_request local;
+  int16_t index;
+
+  local.apply = apply;
+  linkaddr_copy(&local.addr, addr);
+  local.arg1 = arg1;
+  local.arg2 = arg2;
+
+  if(!tsch_is_associated) {
+    /* No slot operation running: we are the consumer, apply in place */
+    tsch_request_apply_pending();
+    apply(&local);
+    return 1;
+  }
+
+  index = ringbufindex_peek_put(&request_ringbuf);
+  if(index == -1) {
+    /* Ring full: fall back to the lock, under which slot operation is
+     * stopped and we can be the consumer, keeping requests in order */
+    tsch_request_full_count++;
+    if(!tsch_get_lock()) {
+      return 0;
+    }
+    tsch_request_apply_pending();
+    apply(&local);
+    tsch_release_lock();
+    return 1;
+  }
+
+  request_array[index] = local;
+  ringbufindex_put(&request_ringbuf);
+  tsch_request_post_count++;
+  return 1;
+}
+#endif /* HCK_MOD_TSCH_LOCKFREE_HANDOFF */
+
 /*---------------------------------------------------------------------------*/
 /* Channel hopping utility functions */
 
@@ -1370,6 +1479,37 @@ tsch_calculate_channel(struct tsch_asn_t *asn, uint16_t channel_offset)
   return tsch_hopping_sequence[index_of_offset];
 }
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/**
+ * Same as tsch_calculate_channel, but a channel in the blacklist is replaced
+ * by the next entry of the hopping sequence that is not. Both ends of a link
+ * apply the same blacklist and get the same channel.
+ *
+ * \param asn A given ASN
+ * \param channel_offset Given channel offset
+ * \param blacklist Bitmap of channels to avoid, bit 0 being TSCH_STATS_FIRST_CHANNEL
+ * \return The resulting channel
+ */
+static uint8_t
+tsch_calculate_channel_with_blacklist(struct tsch_asn_t *asn, uint16_t channel_offset,
+                                      uint16_t blacklist)
+{
+  uint16_t index_of_0, index_of_offset;
+  uint8_t i;
+  index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
+  index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    uint8_t channel = tsch_hopping_sequence[(index_of_offset + i) % tsch_hopping_sequence_length.val];
+    uint8_t index = tsch_stats_channel_to_index(channel);
+    if(index >= TSCH_STATS_NUM_CHANNELS || (blacklist & (1 << index)) == 0) {
+      return channel;
+    }
+  }
+  /* Everything is blacklisted, keep the regular channel */
+  return tsch_hopping_sequence[index_of_offset];
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 /* Timing utility functions */
 
@@ -1435,116 +1575,497 @@ tsch_schedule_slot_operation(struct rtimer *tm, rtimer_clock_t ref_time, rtimer_
     } \
   } while(0);
 /*---------------------------------------------------------------------------*/
-/* Get EB, broadcast or unicast packet to be sent, and target neighbor. */
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+/* Number of cells to reserve right after the current one for a burst
+ * to n: bounded by the queued packets, the free cells of our schedule
+ * and the adaptive request limit. 0 if no burst should be requested. */
+static uint8_t
+dbt_reservation_request_length(struct tsch_neighbor *n, uint8_t do_wait_for_ack)
+{
+  uint16_t time_to_earliest_schedule = 0;
+  int len;
+
+  if(!do_wait_for_ack || burst_link_scheduled || dbt_reserved_slots > 0) {
+    return 0;
+  }
+
+  len = MIN(tsch_queue_nbr_packet_count(n) - 1, (int)dbt_request_limit);
+  len = MIN(len, TSCH_BURST_MAX_LEN - 1 - tsch_current_burst_count);
+#if TSCH_DBT_QUEUE_AWARENESS
+  /* consider current packet: ringbufindex_elements(&dequeued_ringbuf) + 1 */
+  len = MIN(len, ((int)TSCH_DEQUEUED_ARRAY_SIZE - 1) - (ringbufindex_elements(&dequeued_ringbuf) + 1));
+#endif
+  if(len <= 0
+     || !tsch_schedule_get_next_timeslot_available_or_not(&tsch_current_asn, &time_to_earliest_schedule)) {
+    return 0;
+  }
+  if(time_to_earliest_schedule > 0) {
+    /* No link within the next time_to_earliest_schedule - 1 cells */
+    len = MIN(len, time_to_earliest_schedule - 1);
+  }
+  return (uint8_t)len;
+}
+/*---------------------------------------------------------------------------*/
+/* Grant the requested burst if all its cells are free and can be
+ * buffered. All or nothing: the EACK only carries the frame pending bit,
+ * so the sender cannot learn a partial grant. */
+static uint8_t
+dbt_reservation_grant(uint16_t time_to_earliest_schedule, int empty_space)
+{
+  if(dbt_rx_requested_len == 0
+     || (time_to_earliest_schedule > 0 && time_to_earliest_schedule - 1 < dbt_rx_requested_len)
+     || empty_space < dbt_rx_requested_len) {
+    ++tsch_dbt_reservation_deny_count;
+    return 0;
+  }
+  dbt_reserved_slots = dbt_rx_requested_len;
+  ++tsch_dbt_reservation_count;
+  tsch_dbt_reservation_cell_count += dbt_reserved_slots;
+  return 1;
+}
+#endif /* TSCH_DBT_MULTI_CELL_RESERVATION */
+/*---------------------------------------------------------------------------*/
+/* Shared-cell policies: packet selection on Tx links and the information
+ * piggybacked to header/EB IEs. The variant compiled in (WITH_DRA, WITH_TRGB
+ * or WITH_QUICK6) and the plain 6TiSCH minimal behavior are each described
+ * by a policy. Only one variant is ever compiled in: with
+ * HCK_MOD_TSCH_SHARED_CELL_POLICY an image carries that variant plus the
+ * minimal policy as a fallback, otherwise the compiled policy is called
+ * directly. Falling back to minimal replaces the packet selection, the
+ * piggybacked information and the per-slot Quick6/TRGB handling; the
+ * variant slotframes and their ASN bookkeeping (e.g. DRA) stay as built. */
+struct tsch_shared_cell_policy {
+  const char *name;
+  /* Get the packet to send on a Tx link, and its neighbor (by reference) */
+  struct tsch_packet *(*select_packet)(struct tsch_link *link, struct tsch_neighbor **target_neighbor);
+#if HCK_FORMATION_PACKET_TYPE_INFO
+  /* Fill in the 32 bits piggybacked to the header IE or EB IE of p */
+  void (*tx_info)(struct tsch_packet *p, uint8_t is_eb, uint16_t *info_1, uint16_t *info_2);
+  /* Process the 32 bits piggybacked to a received frame (0 if none) */
+  void (*rx_info)(const frame802154_t *frame, const linkaddr_t *source, uint16_t info_1, uint16_t info_2);
+#endif
+};
+
+#define SHARED_CELL_WITH_MINIMAL_POLICY \
+  (HCK_MOD_TSCH_SHARED_CELL_POLICY || (!WITH_DRA && !WITH_TRGB && !WITH_QUICK6))
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+/* Selection timestamps. RTIMER_NOW() by default; a platform may provide a
+ * finer free-running 32-bit counter (e.g. DWT->CYCCNT on Cortex-M) to
+ * resolve the indirect call itself. */
+#ifdef HCK_TSCH_SHARED_CELL_SELECT_TIMING_CONF_NOW
+typedef uint32_t shared_cell_select_time_t;
+#define SHARED_CELL_SELECT_NOW() HCK_TSCH_SHARED_CELL_SELECT_TIMING_CONF_NOW()
+#define SHARED_CELL_SELECT_DIFF(a, b) ((uint32_t)((a) - (b)))
+#else
+typedef rtimer_clock_t shared_cell_select_time_t;
+#define SHARED_CELL_SELECT_NOW() RTIMER_NOW()
+#define SHARED_CELL_SELECT_DIFF(a, b) ((uint32_t)RTIMER_CLOCK_DIFF(a, b))
+#endif
+/* Set first thing in each select_packet hook, to split the dispatch through
+ * the policy pointer from the selection itself */
+static shared_cell_select_time_t shared_cell_select_entered;
+#define SHARED_CELL_SELECT_ENTERED() (shared_cell_select_entered = SHARED_CELL_SELECT_NOW())
+#else
+#define SHARED_CELL_SELECT_ENTERED()
+#endif
+/*---------------------------------------------------------------------------*/
+#if SHARED_CELL_WITH_MINIMAL_POLICY || !WITH_TRGB
 static struct tsch_packet *
-get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
+minimal_select_packet(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
 {
   struct tsch_packet *p = NULL;
   struct tsch_neighbor *n = NULL;
 
-  /* Is this a Tx link? */
-  if(link->link_options & LINK_OPTION_TX) {
+  SHARED_CELL_SELECT_ENTERED();
 
-#if WITH_TRGB
-    if(link->slotframe_handle == TRGB_SLOTFRAME_HANDLE) { /* Common shared cell only */
-      /* First, initialize current TRGB cell type and operation */
-      trgb_current_cell = TRGB_CELL_NULL;
-      trgb_current_operation = TRGB_OPERATION_NULL;
-
-      /* Second, determine current TRGB cell type based on ASN */
-      if((tsch_current_asn.ls4b % 3) == TRGB_CELL_RED) {
-        trgb_current_cell = TRGB_CELL_RED;
-      } else if((tsch_current_asn.ls4b % 3) == TRGB_CELL_GREEN) {
-        trgb_current_cell = TRGB_CELL_GREEN;
-      } else if((tsch_current_asn.ls4b % 3) == TRGB_CELL_BLUE) {
-        trgb_current_cell = TRGB_CELL_BLUE;
+  /* is it for advertisement of EB? */
+  if(link->link_type == LINK_TYPE_ADVERTISING || link->link_type == LINK_TYPE_ADVERTISING_ONLY) {
+    /* fetch EB packets */
+    n = n_eb;
+    p = tsch_queue_get_packet_for_nbr(n, link);
+  }
+  if(link->link_type != LINK_TYPE_ADVERTISING_ONLY) {
+    /* NORMAL link or no EB to send, pick a data packet */
+    if(p == NULL) {
+      /* Get neighbor queue associated to the link and get packet from it */
+      n = tsch_queue_get_nbr(&link->addr);
+      p = tsch_queue_get_packet_for_nbr(n, link);
+      /* if it is a broadcast slot and there were no broadcast packets, pick any unicast packet */
+      if(p == NULL && n == n_broadcast) {
+        p = tsch_queue_get_unicast_packet_for_any(&n, link);
       }
+    }
+  }
 
-      /* Third, compare trgb_my_tx_cell with the current cell type 
-         and determine trgb_current_operation */
-      if(trgb_current_cell == TRGB_CELL_RED) { /* RED cell */
-        trgb_current_operation = TRGB_OPERATION_RED; /* RED cell is always available */
-      } else { /* GREEN or BLUE cell */
-        if(trgb_my_tx_cell == TRGB_CELL_NULL) {
-          trgb_current_operation = TRGB_OPERATION_GREEN_OR_BLUE_UNAVAILABLE; /* Do Rx operation */
-        } else {
-          if(trgb_current_cell == TRGB_CELL_GREEN) {
-            if(trgb_my_tx_cell == TRGB_CELL_GREEN) {
-              trgb_current_operation = TRGB_OPERATION_GREEN_TX;
-            } else if(trgb_my_tx_cell == TRGB_CELL_BLUE) {
-              trgb_current_operation = TRGB_OPERATION_GREEN_RX;
-            }
-          } else if(trgb_current_cell == TRGB_CELL_BLUE) {
-            if(trgb_my_tx_cell == TRGB_CELL_BLUE) {
-              trgb_current_operation = TRGB_OPERATION_BLUE_TX;
-            } else if(trgb_my_tx_cell == TRGB_CELL_GREEN) {
-              trgb_current_operation = TRGB_OPERATION_BLUE_RX;
-            }
+  *target_neighbor = n;
+  return p;
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if HCK_FORMATION_PACKET_TYPE_INFO && SHARED_CELL_WITH_MINIMAL_POLICY
+static void
+minimal_tx_info(struct tsch_packet *p, uint8_t is_eb, uint16_t *info_1, uint16_t *info_2)
+{
+  *info_1 = (formation_tx_packet_type << 8) + 0; /* Store packet type */
+  *info_2 = 0; /* Store nothing */
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if HCK_FORMATION_PACKET_TYPE_INFO && (SHARED_CELL_WITH_MINIMAL_POLICY || WITH_QUICK6)
+static void
+minimal_rx_info(const frame802154_t *frame, const linkaddr_t *source, uint16_t info_1, uint16_t info_2)
+{
+}
+#endif
+/*---------------------------------------------------------------------------*/
+#if SHARED_CELL_WITH_MINIMAL_POLICY
+static const struct tsch_shared_cell_policy minimal_shared_cell_policy = {
+  .name = "minimal",
+  .select_packet = minimal_select_packet,
+#if HCK_FORMATION_PACKET_TYPE_INFO
+  .tx_info = minimal_tx_info,
+  .rx_info = minimal_rx_info,
+#endif
+};
+#endif
+/*---------------------------------------------------------------------------*/
+#if WITH_DRA
+#if HCK_FORMATION_PACKET_TYPE_INFO
+static void
+dra_tx_info(struct tsch_packet *p, uint8_t is_eb, uint16_t *info_1, uint16_t *info_2)
+{
+  uint8_t tx_dra_m = p->dra_m;
+  uint16_t tx_dra_seq = p->dra_seq;
+
+  *info_1 = (formation_tx_packet_type << 8) + tx_dra_m; /* Store packet type and dra m */
+  *info_2 = tx_dra_seq; /* Store dra seq */
+
+#if DRA_DBG
+  TSCH_LOG_ADD(tsch_log_message,
+      snprintf(log->message, sizeof(log->message),
+      "dra %s info %u %u %u %u", is_eb ? "txE" : "tx",
+                                 formation_tx_packet_type, 
+                                 tx_dra_m, 
+                                 *info_1, 
+                                 *info_2));
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static void
+dra_rx_info(const frame802154_t *frame, const linkaddr_t *source, uint16_t info_1, uint16_t info_2)
+{
+  rx_dra_m = (uint8_t)(info_1 & 0xFF);
+  rx_dra_seq = info_2;
+
+  if(current_link->slotframe_handle == DRA_SLOTFRAME_HANDLE) {
+#if DRA_DBG
+    TSCH_LOG_ADD(tsch_log_message,
+        snprintf(log->message, sizeof(log->message),
+        "dra rx info %u %u %u %u", formation_rx_packet_type, 
+                                   rx_dra_m, 
+                                   info_1, 
+                                   rx_dra_seq));
+#endif
+    /* Update nbr */
+    int dra_nbr_id = HCK_GET_NODE_ID_FROM_LINKADDR(source);
+    uint8_t dra_nbr_eb_1_bc_2_uc_3 = 0;
+    if(frame->fcf.frame_type == FRAME802154_BEACONFRAME) {
+      dra_nbr_eb_1_bc_2_uc_3 = 1;
+    } else {
+      if(!(frame->fcf.ack_required)) {
+        dra_nbr_eb_1_bc_2_uc_3 = 2;
+      } else {
+        dra_nbr_eb_1_bc_2_uc_3 = 3;
+      }
+    }
+    dra_receive_control_message(dra_nbr_id, rx_dra_m, rx_dra_seq, dra_nbr_eb_1_bc_2_uc_3);
+  }
+}
+#endif /* HCK_FORMATION_PACKET_TYPE_INFO */
+/*---------------------------------------------------------------------------*/
+static const struct tsch_shared_cell_policy dra_shared_cell_policy = {
+  .name = "dra",
+  .select_packet = minimal_select_packet,
+#if HCK_FORMATION_PACKET_TYPE_INFO
+  .tx_info = dra_tx_info,
+  .rx_info = dra_rx_info,
+#endif
+};
+#define COMPILED_SHARED_CELL_POLICY (&dra_shared_cell_policy)
+/*---------------------------------------------------------------------------*/
+#elif WITH_TRGB
+static struct tsch_packet *
+trgb_select_packet(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
+{
+  struct tsch_packet *p = NULL;
+  struct tsch_neighbor *n = NULL;
+
+  SHARED_CELL_SELECT_ENTERED();
+
+  if(link->slotframe_handle == TRGB_SLOTFRAME_HANDLE) { /* Common shared cell only */
+    /* First, initialize current TRGB cell type and operation */
+    trgb_current_cell = TRGB_CELL_NULL;
+    trgb_current_operation = TRGB_OPERATION_NULL;
+
+    /* Second, determine current TRGB cell type based on ASN */
+    if((tsch_current_asn.ls4b % 3) == TRGB_CELL_RED) {
+      trgb_current_cell = TRGB_CELL_RED;
+    } else if((tsch_current_asn.ls4b % 3) == TRGB_CELL_GREEN) {
+      trgb_current_cell = TRGB_CELL_GREEN;
+    } else if((tsch_current_asn.ls4b % 3) == TRGB_CELL_BLUE) {
+      trgb_current_cell = TRGB_CELL_BLUE;
+    }
+
+    /* Third, compare trgb_my_tx_cell with the current cell type 
+       and determine trgb_current_operation */
+    if(trgb_current_cell == TRGB_CELL_RED) { /* RED cell */
+      trgb_current_operation = TRGB_OPERATION_RED; /* RED cell is always available */
+    } else { /* GREEN or BLUE cell */
+      if(trgb_my_tx_cell == TRGB_CELL_NULL) {
+        trgb_current_operation = TRGB_OPERATION_GREEN_OR_BLUE_UNAVAILABLE; /* Do Rx operation */
+      } else {
+        if(trgb_current_cell == TRGB_CELL_GREEN) {
+          if(trgb_my_tx_cell == TRGB_CELL_GREEN) {
+            trgb_current_operation = TRGB_OPERATION_GREEN_TX;
+          } else if(trgb_my_tx_cell == TRGB_CELL_BLUE) {
+            trgb_current_operation = TRGB_OPERATION_GREEN_RX;
+          }
+        } else if(trgb_current_cell == TRGB_CELL_BLUE) {
+          if(trgb_my_tx_cell == TRGB_CELL_BLUE) {
+            trgb_current_operation = TRGB_OPERATION_BLUE_TX;
+          } else if(trgb_my_tx_cell == TRGB_CELL_GREEN) {
+            trgb_current_operation = TRGB_OPERATION_BLUE_RX;
           }
         }
       }
+    }
 
-      /* Fourth, get packet and update trgb_current_operation */
-      if(trgb_current_operation == TRGB_OPERATION_RED) {
-        p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
-        if(p != NULL) {
-          trgb_current_operation = TRGB_OPERATION_RED_TX;
-        } else {
-          trgb_current_operation = TRGB_OPERATION_RED_RX;
-        }
-      } else if(trgb_current_operation == TRGB_OPERATION_GREEN_TX) {
-        p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
-        if(p == NULL) {
-          trgb_current_operation = TRGB_OPERATION_GREEN_TX_NO_PACKET;
-        }
-      } else if(trgb_current_operation == TRGB_OPERATION_BLUE_TX) {
-        p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
-        if(p == NULL) {
-          trgb_current_operation = TRGB_OPERATION_BLUE_TX_NO_PACKET;
-        }
+    /* Fourth, get packet and update trgb_current_operation */
+    if(trgb_current_operation == TRGB_OPERATION_RED) {
+      p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
+      if(p != NULL) {
+        trgb_current_operation = TRGB_OPERATION_RED_TX;
+      } else {
+        trgb_current_operation = TRGB_OPERATION_RED_RX;
+      }
+    } else if(trgb_current_operation == TRGB_OPERATION_GREEN_TX) {
+      p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
+      if(p == NULL) {
+        trgb_current_operation = TRGB_OPERATION_GREEN_TX_NO_PACKET;
       }
+    } else if(trgb_current_operation == TRGB_OPERATION_BLUE_TX) {
+      p = tsch_queue_get_packet_for_trgb(&n, link, trgb_current_cell);
+      if(p == NULL) {
+        trgb_current_operation = TRGB_OPERATION_BLUE_TX_NO_PACKET;
+      }
+    }
 
-      /* The final value of trgb_current_operation should be one of the belows 
-       * TRGB_OPERATION_RED_TX
-       * TRGB_OPERATION_RED_RX
-       * TRGB_OPERATION_GREEN_OR_BLUE_UNAVAILABLE
-       * TRGB_OPERATION_GREEN_TX
-       * TRGB_OPERATION_GREEN_RX
-       * TRGB_OPERATION_GREEN_TX_NO_PACKET
-       * TRGB_OPERATION_BLUE_TX
-       * TRGB_OPERATION_BLUE_RX
-       * TRGB_OPERATION_BLUE_TX_NO_PACKET
-       */
+    /* The final value of trgb_current_operation should be one of the belows 
+     * TRGB_OPERATION_RED_TX
+     * TRGB_OPERATION_RED_RX
+     * TRGB_OPERATION_GREEN_OR_BLUE_UNAVAILABLE
+     * TRGB_OPERATION_GREEN_TX
+     * TRGB_OPERATION_GREEN_RX
+     * TRGB_OPERATION_GREEN_TX_NO_PACKET
+     * TRGB_OPERATION_BLUE_TX
+     * TRGB_OPERATION_BLUE_RX
+     * TRGB_OPERATION_BLUE_TX_NO_PACKET
+     */
 
 #if TRGB_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "TRGB get pkt %u %u", trgb_current_cell, trgb_current_operation));
+      TSCH_LOG_ADD(tsch_log_message,
+          snprintf(log->message, sizeof(log->message),
+          "TRGB get pkt %u %u", trgb_current_cell, trgb_current_operation));
 #endif
-    }
+  }
 
-#else /* WITH_TRGB */
+  *target_neighbor = n;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+#if HCK_FORMATION_PACKET_TYPE_INFO
+static void
+trgb_tx_info(struct tsch_packet *p, uint8_t is_eb, uint16_t *info_1, uint16_t *info_2)
+{
+  *info_1 = (formation_tx_packet_type << 8) + (uint8_t)trgb_my_tx_cell; /* Store packet type and trgb_my_tx_cell */
+  *info_2 = (trgb_parent_id << 8) + 0; /* Store trgb_parent_id */
 
-    /* is it for advertisement of EB? */
-    if(link->link_type == LINK_TYPE_ADVERTISING || link->link_type == LINK_TYPE_ADVERTISING_ONLY) {
-      /* fetch EB packets */
-      n = n_eb;
-      p = tsch_queue_get_packet_for_nbr(n, link);
-    }
-    if(link->link_type != LINK_TYPE_ADVERTISING_ONLY) {
-      /* NORMAL link or no EB to send, pick a data packet */
-      if(p == NULL) {
-        /* Get neighbor queue associated to the link and get packet from it */
-        n = tsch_queue_get_nbr(&link->addr);
-        p = tsch_queue_get_packet_for_nbr(n, link);
-        /* if it is a broadcast slot and there were no broadcast packets, pick any unicast packet */
-        if(p == NULL && n == n_broadcast) {
-          p = tsch_queue_get_unicast_packet_for_any(&n, link);
-        }
+#if TRGB_DBG
+  TSCH_LOG_ADD(tsch_log_message,
+      snprintf(log->message, sizeof(log->message),
+      "TRGB %s info %u %u %u", is_eb ? "txE" : "tx",
+                               formation_tx_packet_type, 
+                               trgb_my_tx_cell, 
+                               trgb_parent_id));
+#endif
+}
+/*---------------------------------------------------------------------------*/
+static void
+trgb_rx_info(const frame802154_t *frame, const linkaddr_t *source, uint16_t info_1, uint16_t info_2)
+{
+  trgb_received_tx_cell = (uint8_t)(info_1 & 0xFF);
+  trgb_received_parent_id = (uint8_t)((info_2 >> 8) & 0xFF);
+
+  struct tsch_neighbor *trgb_n = tsch_queue_get_nbr(source);
+  rpl_instance_t *trgb_instance = rpl_get_default_instance();
+
+  if(trgb_n != NULL 
+    && trgb_n->is_time_source
+    && trgb_instance != NULL 
+    && trgb_instance->current_dag->preferred_parent != NULL
+    && HCK_GET_NODE_ID_FROM_LINKADDR(rpl_get_parent_lladdr(trgb_instance->current_dag->preferred_parent)) 
+       == HCK_GET_NODE_ID_FROM_LINKADDR(source)) {
+    if(formation_rx_packet_type == HCK_PACKET_TYPE_EB
+      || formation_rx_packet_type == HCK_PACKET_TYPE_M_DIO) {
+      if(trgb_received_tx_cell == TRGB_CELL_GREEN) {
+        trgb_my_tx_cell = TRGB_CELL_BLUE;
+      } else if(trgb_received_tx_cell == TRGB_CELL_BLUE) {
+        trgb_my_tx_cell = TRGB_CELL_GREEN;
+      } else {
+        trgb_my_tx_cell = TRGB_CELL_NULL;
       }
+      trgb_grandP_id = trgb_received_parent_id;
     }
+  }
 
-#endif /* WITH_TRGB */
+#if TRGB_DBG
+  TSCH_LOG_ADD(tsch_log_message,
+      snprintf(log->message, sizeof(log->message),
+      "TRGB rx info %u %u %u %u", formation_rx_packet_type, 
+                                  trgb_received_tx_cell, 
+                                  trgb_received_parent_id,
+                                  trgb_my_tx_cell));
+#endif
+}
+#endif /* HCK_FORMATION_PACKET_TYPE_INFO */
+/*---------------------------------------------------------------------------*/
+static const struct tsch_shared_cell_policy trgb_shared_cell_policy = {
+  .name = "trgb",
+  .select_packet = trgb_select_packet,
+#if HCK_FORMATION_PACKET_TYPE_INFO
+  .tx_info = trgb_tx_info,
+  .rx_info = trgb_rx_info,
+#endif
+};
+#define COMPILED_SHARED_CELL_POLICY (&trgb_shared_cell_policy)
+/*---------------------------------------------------------------------------*/
+#elif WITH_QUICK6
+#if HCK_FORMATION_PACKET_TYPE_INFO
+static void
+quick6_tx_info(struct tsch_packet *p, uint8_t is_eb, uint16_t *info_1, uint16_t *info_2)
+{
+  *info_1 = (formation_tx_packet_type << 8) + (uint8_t)quick6_tx_current_offset; /* Store packet type and chosen offset */
+  *info_2 = 0; /* Store nothing */
+
+#if QUICK6_DBG
+  TSCH_LOG_ADD(tsch_log_message,
+      snprintf(log->message, sizeof(log->message),
+      "Q6 %s info %u %u", is_eb ? "txE" : "tx", formation_tx_packet_type, quick6_tx_current_offset));
+#endif
+}
+#endif /* HCK_FORMATION_PACKET_TYPE_INFO */
+/*---------------------------------------------------------------------------*/
+/* The received offset is decoded by slot operation, since it also applies
+ * to the Rx timing of the Quick6 slotframe */
+static const struct tsch_shared_cell_policy quick6_shared_cell_policy = {
+  .name = "quick6",
+  .select_packet = minimal_select_packet,
+#if HCK_FORMATION_PACKET_TYPE_INFO
+  .tx_info = quick6_tx_info,
+  .rx_info = minimal_rx_info,
+#endif
+};
+#define COMPILED_SHARED_CELL_POLICY (&quick6_shared_cell_policy)
+/*---------------------------------------------------------------------------*/
+#else /* WITH_DRA */
+#define COMPILED_SHARED_CELL_POLICY (&minimal_shared_cell_policy)
+#endif /* WITH_DRA */
+
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+/* Every policy this image includes: the compiled variant, which comes
+ * first and is used at boot, and minimal */
+static const struct tsch_shared_cell_policy *const shared_cell_policies[] = {
+#if WITH_DRA
+  &dra_shared_cell_policy,
+#elif WITH_TRGB
+  &trgb_shared_cell_policy,
+#elif WITH_QUICK6
+  &quick6_shared_cell_policy,
+#endif
+  &minimal_shared_cell_policy,
+};
+static const struct tsch_shared_cell_policy *volatile shared_cell_policy = COMPILED_SHARED_CELL_POLICY;
+#define SHARED_CELL_POLICY shared_cell_policy
+#else
+#define SHARED_CELL_POLICY COMPILED_SHARED_CELL_POLICY
+#endif
+/* Whether the per-slot handling of the compiled variant (Quick6 offsets,
+ * TRGB channel hopping) applies, i.e. minimal has not been selected */
+#define SHARED_CELL_VARIANT_ACTIVE() (SHARED_CELL_POLICY == COMPILED_SHARED_CELL_POLICY)
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+int
+tsch_shared_cell_policy_select(const char *name)
+{
+  int i;
+
+  if(name == NULL || tsch_is_associated) {
+    return 0;
+  }
+  for(i = 0; i < sizeof(shared_cell_policies) / sizeof(shared_cell_policies[0]); i++) {
+    if(!strcmp(name, shared_cell_policies[i]->name)) {
+      shared_cell_policy = shared_cell_policies[i];
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_shared_cell_policy_current(void)
+{
+  return shared_cell_policy->name;
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_shared_cell_policy_get(int index)
+{
+  if(index < 0 || index >= sizeof(shared_cell_policies) / sizeof(shared_cell_policies[0])) {
+    return NULL;
+  }
+  return shared_cell_policies[index]->name;
+}
+#endif /* HCK_MOD_TSCH_SHARED_CELL_POLICY */
+/*---------------------------------------------------------------------------*/
+/* Get EB, broadcast or unicast packet to be sent, and target neighbor. */
+static struct tsch_packet *
+get_packet_and_neighbor_for_link(struct tsch_link *link, struct tsch_neighbor **target_neighbor)
+{
+  struct tsch_packet *p = NULL;
+  struct tsch_neighbor *n = NULL;
+
+  /* Is this a Tx link? */
+  if(link->link_options & LINK_OPTION_TX) {
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+    shared_cell_select_time_t select_start = SHARED_CELL_SELECT_NOW();
+#endif
+
+    p = SHARED_CELL_POLICY->select_packet(link, &n);
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+    uint32_t select_ticks = SHARED_CELL_SELECT_DIFF(SHARED_CELL_SELECT_NOW(), select_start);
+    uint32_t dispatch_ticks = SHARED_CELL_SELECT_DIFF(shared_cell_select_entered, select_start);
+    tsch_shared_cell_select_count++;
+    tsch_shared_cell_select_ticks_sum += select_ticks;
+    if(select_ticks > tsch_shared_cell_select_ticks_max) {
+      tsch_shared_cell_select_ticks_max = select_ticks;
+    }
+    tsch_shared_cell_dispatch_ticks_sum += dispatch_ticks;
+    if(dispatch_ticks > tsch_shared_cell_dispatch_ticks_max) {
+      tsch_shared_cell_dispatch_ticks_max = dispatch_ticks;
+    }
+#endif
   }
 
   /* return nbr (by reference) */
@@ -1674,6 +2195,44 @@ tsch_radio_off(enum tsch_radio_state_off_cmd command)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_LOG_TSCH_SLOT_ENERGY
+/* Time of one energest type so far, including the period under way. Reads
+ * only: energest_flush() from interrupt context would race with the
+ * flushes of process context */
+static uint64_t
+slot_energy_type_time(energest_type_t type, ENERGEST_TIME_T now)
+{
+  uint64_t time = energest_type_time(type);
+  if(energest_current_mode[type] != 0) {
+    time += (ENERGEST_TIME_T)(now - energest_current_time[type]);
+  }
+  return time;
+}
+/*---------------------------------------------------------------------------*/
+/* Radio time so far, as accounted by energest */
+static uint64_t
+slot_energy_radio_time(void)
+{
+  ENERGEST_TIME_T now = ENERGEST_CURRENT_TIME();
+  return slot_energy_type_time(ENERGEST_TYPE_LISTEN, now)
+    + slot_energy_type_time(ENERGEST_TYPE_TRANSMIT, now);
+}
+/*---------------------------------------------------------------------------*/
+/* Charge the radio time of the slot that just ended to its slotframe and outcome */
+static void
+slot_energy_account(const struct tsch_link *link, int is_burst)
+{
+  uint8_t se_class = link->slotframe_handle <= HCK_TSCH_SLOT_ENERGY_MAX_HANDLE ?
+                     link->slotframe_handle : HCK_TSCH_SLOT_ENERGY_CLASS_OTHER;
+  if(is_burst) {
+    se_class = HCK_TSCH_SLOT_ENERGY_CLASS_BURST;
+  }
+  tsch_slot_energy_count[se_class][slot_energy_outcome]++;
+  tsch_slot_energy_ticks[se_class][slot_energy_outcome] +=
+    (uint32_t)(slot_energy_radio_time() - slot_energy_radio_start);
+}
+#endif
+/*---------------------------------------------------------------------------*/
 #if WITH_OST && OST_ON_DEMAND_PROVISION
 uint8_t
 ost_reserved_ssq(uint16_t nbr_id)
@@ -1741,6 +2300,10 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
   TSCH_DEBUG_TX_EVENT();
 
+#if HCK_LOG_TSCH_SLOT_ENERGY
+  slot_energy_outcome = TSCH_SLOT_ENERGY_TX_ERR;
+#endif
+
   /* First check if we have space to store a newly dequeued packet (in case of
    * successful Tx or Drop) */
   dequeued_index = ringbufindex_peek_put(&dequeued_ringbuf);
@@ -1779,6 +2342,13 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       do_wait_for_ack = !current_neighbor->is_broadcast;
 
 #if WITH_QUICK6
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+      if(current_link->slotframe_handle == QUICK6_SLOTFRAME_HANDLE
+         && !SHARED_CELL_VARIANT_ACTIVE()) {
+        /* Minimal policy: no offset-based prioritization */
+        quick6_tx_current_offset = QUICK6_OFFSET_0;
+      } else
+#endif
       if(current_link->slotframe_handle == QUICK6_SLOTFRAME_HANDLE) {
         /* Baseline: simple random assignment */
         quick6_tx_current_offset = random_rand() % QUICK6_NUM_OF_OFFSETS; /* 0, 1, 2, 3, 4 */
@@ -1846,87 +2416,20 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
 #if HCK_FORMATION_PACKET_TYPE_INFO
       formation_tx_packet_type = current_packet->hck_packet_type;
-#if !WITH_DRA && !WITH_TRGB && !WITH_QUICK6
-      if(formation_tx_packet_type != HCK_PACKET_TYPE_EB) {
-        uint16_t hckim_header_formation_tx_info_1 = 0; /* Store packet type */
-        uint16_t hckim_header_formation_tx_info_2 = 0; /* Store nothing */
-
-        hckim_header_formation_tx_info_1 = (formation_tx_packet_type << 8) + 0;
-
-        frame802154_t formation_tx_frame;
-        int formation_hdr_len;
-        formation_hdr_len = frame802154_parse((uint8_t *)packet, packet_len, &formation_tx_frame);
-        ((uint8_t *)(packet))[formation_hdr_len + 2] = (uint8_t)(hckim_header_formation_tx_info_1 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 3] = (uint8_t)((hckim_header_formation_tx_info_1 >> 8) & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 4] = (uint8_t)(hckim_header_formation_tx_info_2 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 5] = (uint8_t)((hckim_header_formation_tx_info_2 >> 8) & 0xFF);
-      } else {
-        /* Piggybacking to EB will be performed at EB update below */
-      }
-#elif WITH_DRA
-      if(formation_tx_packet_type != HCK_PACKET_TYPE_EB) {
-        uint16_t hckim_header_formation_tx_info_1 = 0; /* Store packet type and dra m */
-        uint16_t hckim_header_formation_tx_info_2 = 0; /* Store dra seq */
-
-        uint8_t tx_dra_m = current_packet->dra_m;
-        uint16_t tx_dra_seq = current_packet->dra_seq;
-        
-        hckim_header_formation_tx_info_1 = (formation_tx_packet_type << 8) + tx_dra_m;
-        hckim_header_formation_tx_info_2 = tx_dra_seq;
-
-        frame802154_t formation_tx_frame;
-        int formation_hdr_len;
-        formation_hdr_len = frame802154_parse((uint8_t *)packet, packet_len, &formation_tx_frame);
-        ((uint8_t *)(packet))[formation_hdr_len + 2] = (uint8_t)(hckim_header_formation_tx_info_1 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 3] = (uint8_t)((hckim_header_formation_tx_info_1 >> 8) & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 4] = (uint8_t)(hckim_header_formation_tx_info_2 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 5] = (uint8_t)((hckim_header_formation_tx_info_2 >> 8) & 0xFF);
-
-#if DRA_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "dra tx info %u %u %u %u", formation_tx_packet_type, 
-                                  tx_dra_m, 
-                                  hckim_header_formation_tx_info_1, 
-                                  hckim_header_formation_tx_info_2));
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+      dbt_tx_requested_len = 0;
 #endif
-      } else {
-        /* Piggybacking to EB will be performed at EB update below */
-      }
-
-#elif WITH_TRGB
       if(formation_tx_packet_type != HCK_PACKET_TYPE_EB) {
-        uint16_t hckim_header_formation_tx_info_1 = 0; /* Store packet type and trgb_my_tx_cell */
-        uint16_t hckim_header_formation_tx_info_2 = 0; /* Store trgb_parent_id */
+        uint16_t hckim_header_formation_tx_info_1 = 0; /* Store packet type and policy information */
+        uint16_t hckim_header_formation_tx_info_2 = 0; /* Store policy information */
 
-        hckim_header_formation_tx_info_1 = (formation_tx_packet_type << 8) + (uint8_t)trgb_my_tx_cell;
-        hckim_header_formation_tx_info_2 = (trgb_parent_id << 8) + 0;
-
-        frame802154_t formation_tx_frame;
-        int formation_hdr_len;
-        formation_hdr_len = frame802154_parse((uint8_t *)packet, packet_len, &formation_tx_frame);
-        ((uint8_t *)(packet))[formation_hdr_len + 2] = (uint8_t)(hckim_header_formation_tx_info_1 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 3] = (uint8_t)((hckim_header_formation_tx_info_1 >> 8) & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 4] = (uint8_t)(hckim_header_formation_tx_info_2 & 0xFF);
-        ((uint8_t *)(packet))[formation_hdr_len + 5] = (uint8_t)((hckim_header_formation_tx_info_2 >> 8) & 0xFF);
+        SHARED_CELL_POLICY->tx_info(current_packet, 0, &hckim_header_formation_tx_info_1, &hckim_header_formation_tx_info_2);
 
-#if TRGB_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "TRGB tx info %u %u %u", formation_tx_packet_type, 
-                                        trgb_my_tx_cell, 
-                                        trgb_parent_id));
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+        /* Lower byte of info 2: number of burst cells requested */
+        dbt_tx_requested_len = dbt_reservation_request_length(current_neighbor, do_wait_for_ack);
+        hckim_header_formation_tx_info_2 |= dbt_tx_requested_len;
 #endif
-      } else {
-        /* Piggybacking to EB will be performed at EB update below */
-      }
-
-#elif WITH_QUICK6
-      if(formation_tx_packet_type != HCK_PACKET_TYPE_EB) {
-        uint16_t hckim_header_formation_tx_info_1 = 0; /* Store packet type and chosen offset */
-        uint16_t hckim_header_formation_tx_info_2 = 0; /* Store nothing */
-
-        hckim_header_formation_tx_info_1 = (formation_tx_packet_type << 8) + (uint8_t)quick6_tx_current_offset;
 
         frame802154_t formation_tx_frame;
         int formation_hdr_len;
@@ -1935,22 +2438,27 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
         ((uint8_t *)(packet))[formation_hdr_len + 3] = (uint8_t)((hckim_header_formation_tx_info_1 >> 8) & 0xFF);
         ((uint8_t *)(packet))[formation_hdr_len + 4] = (uint8_t)(hckim_header_formation_tx_info_2 & 0xFF);
         ((uint8_t *)(packet))[formation_hdr_len + 5] = (uint8_t)((hckim_header_formation_tx_info_2 >> 8) & 0xFF);
-
-#if QUICK6_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "Q6 tx info %u %u", formation_tx_packet_type, quick6_tx_current_offset));
-#endif
       } else {
         /* Piggybacking to EB will be performed at EB update below */
       }
-
-#endif /* !WITH_DRA && !WITH_TRGB && !WITH_QUICK6 */
 #endif /* HCK_FORMATION_PACKET_TYPE_INFO */
 
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
       /* Unicast. More packets in queue for the neighbor? */
       burst_link_requested = 0;
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+      /* The burst length was requested through the header IE above,
+         only the first packet of a burst sets the frame pending bit */
+      if(dbt_tx_requested_len > 0) {
+        burst_link_requested = 1;
+        tsch_packet_set_frame_pending(packet, packet_len);
+#if ENABLE_MODIFIED_DBT_LOG
+        TSCH_LOG_ADD(tsch_log_message,
+            snprintf(log->message, sizeof(log->message),
+            "sched dbt tx res req %u", dbt_tx_requested_len));
+#endif
+      }
+#else /* TSCH_DBT_MULTI_CELL_RESERVATION */
       if(do_wait_for_ack
              && tsch_current_burst_count + 1 < TSCH_BURST_MAX_LEN
              && tsch_queue_nbr_packet_count(current_neighbor) > 1) {
@@ -1998,6 +2506,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #endif
 #endif
       }
+#endif /* TSCH_DBT_MULTI_CELL_RESERVATION */
 #endif
 
       /* read seqno from payload */
@@ -2087,57 +2596,10 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 #if HCK_MOD_TSCH_PIGGYBACKING_EB_IE_32BITS /* Coordinator/non-coordinator: update information in EB before transmission */
 #if HCK_FORMATION_PACKET_TYPE_INFO
         formation_tx_packet_type = current_packet->hck_packet_type;
-#if !WITH_DRA && !WITH_TRGB && !WITH_QUICK6
         uint16_t hckim_eb_formation_tx_info_1 = 0;
         uint16_t hckim_eb_formation_tx_info_2 = 0;
 
-        hckim_eb_formation_tx_info_1 = (formation_tx_packet_type << 8) + 0;
-#elif WITH_DRA
-        uint16_t hckim_eb_formation_tx_info_1 = 0;
-        uint16_t hckim_eb_formation_tx_info_2 = 0;
-
-        uint8_t tx_dra_m = current_packet->dra_m;
-        uint16_t tx_dra_seq = current_packet->dra_seq;
-
-        hckim_eb_formation_tx_info_1 = (formation_tx_packet_type << 8) + tx_dra_m;
-        hckim_eb_formation_tx_info_2 = tx_dra_seq;
-
-#if DRA_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "dra txE info %u %u %u %u", formation_tx_packet_type, 
-                                  tx_dra_m, 
-                                  hckim_eb_formation_tx_info_1,
-                                  hckim_eb_formation_tx_info_2));
-#endif
-
-#elif WITH_TRGB
-        uint16_t hckim_eb_formation_tx_info_1 = 0;
-        uint16_t hckim_eb_formation_tx_info_2 = 0;
-
-        hckim_eb_formation_tx_info_1 = (formation_tx_packet_type << 8) + trgb_my_tx_cell;
-        hckim_eb_formation_tx_info_2 = (trgb_parent_id << 8) + 0;
-
-#if TRGB_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "TRGB txE info %u %u %u", formation_tx_packet_type, 
-                                        trgb_my_tx_cell, 
-                                        trgb_parent_id));
-#endif
-
-#elif WITH_QUICK6
-        uint16_t hckim_eb_formation_tx_info_1 = 0;
-        uint16_t hckim_eb_formation_tx_info_2 = 0;
-
-        hckim_eb_formation_tx_info_1 = (formation_tx_packet_type << 8) + (uint8_t)quick6_tx_current_offset;
-
-#if QUICK6_DBG
-        TSCH_LOG_ADD(tsch_log_message,
-            snprintf(log->message, sizeof(log->message),
-            "Q6 txE info %u %u", formation_tx_packet_type, quick6_tx_current_offset));
-#endif
-#endif /* !WITH_DRA && !WITH_TRGB && !WITH_QUICK6 */
+        SHARED_CELL_POLICY->tx_info(current_packet, 1, &hckim_eb_formation_tx_info_1, &hckim_eb_formation_tx_info_2);
 
         if(packet_ready && tsch_hck_packet_update_eb(packet, packet_len, current_packet->tsch_sync_ie_offset,
                                                     hckim_eb_formation_tx_info_1, hckim_eb_formation_tx_info_2)) {
@@ -2473,6 +2935,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                     burst_link_tx = 1;
                     burst_link_rx = 0;
 #endif
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+                    dbt_reserved_slots = dbt_tx_requested_len;
+                    if(dbt_request_limit < TSCH_BURST_MAX_LEN - 1) {
+                      ++dbt_request_limit;
+                    }
+#endif
 #if MODIFIED_TSCH_DEFAULT_BURST_TRANSMISSION
                   } else {
 #if ENABLE_MODIFIED_DBT_LOG
@@ -2481,6 +2949,10 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                         "sched dbt tx fail %d", burst_link_scheduled));
 #endif
                     burst_link_scheduled = 0;
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+                    /* Denied: ask for fewer cells next time */
+                    dbt_request_limit = MAX(1, dbt_request_limit / 2);
+#endif
                   }
 #endif
                 }
@@ -2507,6 +2979,35 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     current_packet->transmissions++;
     current_packet->ret = mac_tx_status;
 
+#if HCK_MOD_TSCH_RX_SKIP
+    if(!current_neighbor->is_broadcast
+       && current_link->slotframe_handle == HCK_TSCH_RX_SKIP_SF_HANDLE) {
+      if(mac_tx_status == MAC_TX_OK) {
+        tsch_schedule_rx_skip_mark(&current_neighbor->rx_skip);
+      } else if(mac_tx_status == MAC_TX_NOACK) {
+        /* The receiver may have lost its state (e.g. link re-created):
+           fall back to the occurrences it always listens on */
+        current_neighbor->rx_skip.seen = 0;
+      }
+    }
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+    switch(mac_tx_status) {
+    case MAC_TX_OK:
+      slot_energy_outcome = TSCH_SLOT_ENERGY_TX_OK;
+      break;
+    case MAC_TX_NOACK:
+      slot_energy_outcome = TSCH_SLOT_ENERGY_TX_NOACK;
+      break;
+    case MAC_TX_COLLISION:
+      slot_energy_outcome = TSCH_SLOT_ENERGY_TX_BUSY;
+      break;
+    default:
+      break;
+    }
+#endif
+
 #if WITH_QUICK6
     if(current_link->slotframe_handle == QUICK6_SLOTFRAME_HANDLE 
       && current_packet->ret == MAC_TX_OK) {
@@ -2601,6 +3102,13 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       tsch_stats_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
     }
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+    /* Per-neighbor and per-channel Tx failure rate, on unicast cells */
+    if(current_link->slotframe_handle == HCK_TSCH_LINK_BLACKLIST_SLOTFRAME_HANDLE) {
+      tsch_stats_lcb_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
+    }
+#endif
+
     /* Log every tx attempt */
     TSCH_LOG_ADD(tsch_log_tx,
         log->tx.mac_tx_status = mac_tx_status;
@@ -2752,6 +3260,10 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 
   TSCH_DEBUG_RX_EVENT();
 
+#if HCK_LOG_TSCH_SLOT_ENERGY
+  slot_energy_outcome = TSCH_SLOT_ENERGY_RX_IDLE;
+#endif
+
   input_index = ringbufindex_peek_put(&input_ringbuf);
   if(input_index == -1) {
     /* hckim log */
@@ -2842,6 +3354,11 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #endif
 
     }
+#if HCK_LOG_TSCH_SLOT_ENERGY
+    if(packet_seen) {
+      slot_energy_outcome = TSCH_SLOT_ENERGY_RX_BAD;
+    }
+#endif
     if(!packet_seen) {
 #if WITH_A3
       NETSTACK_RADIO.get_value(RADIO_PARAM_RSSI, &a3_rx_rssi);
@@ -2973,189 +3490,39 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
             rx_count++;
 
 #if HCK_FORMATION_PACKET_TYPE_INFO
-#if !WITH_DRA && !WITH_TRGB && !WITH_QUICK6
             formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-            uint16_t hckim_formation_rx_info_1 = 0; /* Store packet type */
+            uint16_t hckim_formation_rx_info_1 = 0; /* Store packet type and policy information */
+            uint16_t hckim_formation_rx_info_2 = 0; /* Store policy information */
 
-            if(frame.fcf.frame_type != FRAME802154_BEACONFRAME) {
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
+            if(frame.fcf.ie_list_present) {
+              struct ieee802154_ies formation_ies;
+              frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
 
+              if(frame.fcf.frame_type != FRAME802154_BEACONFRAME) {
                 hckim_formation_rx_info_1 = (int)formation_ies.ie_header_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-              }
-            } else { /* EB case */
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_eb_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_EB;
-              }
-            }
-#elif WITH_DRA
-            formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-            uint16_t hckim_formation_rx_info_1 = 0; /* Store packet type and dra m */
-            uint16_t hckim_formation_rx_info_2 = 0; /* Store dra seq */
-
-            rx_dra_m = 0; 
-            rx_dra_seq = 0;
-
-            if(frame.fcf.frame_type != FRAME802154_BEACONFRAME) {
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_header_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                rx_dra_m = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-
-                hckim_formation_rx_info_2 = (int)formation_ies.ie_header_piggybacking_info_2;
-                rx_dra_seq = hckim_formation_rx_info_2;
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-              }
-            } else { /* EB case */
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-                
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_eb_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                rx_dra_m = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-
-                hckim_formation_rx_info_2 = (int)formation_ies.ie_eb_piggybacking_info_2;
-                rx_dra_seq = hckim_formation_rx_info_2;
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_EB;
-              }
-            }
-            if(current_link->slotframe_handle == DRA_SLOTFRAME_HANDLE) {
-#if DRA_DBG
-            TSCH_LOG_ADD(tsch_log_message,
-                snprintf(log->message, sizeof(log->message),
-                "dra rx info %u %u %u %u", formation_rx_packet_type, 
-                                      rx_dra_m, 
-                                      hckim_formation_rx_info_1, 
-                                      rx_dra_seq));
-#endif
-              /* Update nbr */
-              int dra_nbr_id = HCK_GET_NODE_ID_FROM_LINKADDR(&source_address);
-              uint8_t dra_nbr_eb_1_bc_2_uc_3 = 0;
-              if(frame.fcf.frame_type == FRAME802154_BEACONFRAME) {
-                dra_nbr_eb_1_bc_2_uc_3 = 1;
-              } else {
-                if(!(frame.fcf.ack_required)) {
-                  dra_nbr_eb_1_bc_2_uc_3 = 2;
-                } else {
-                  dra_nbr_eb_1_bc_2_uc_3 = 3;
-                }
-              }
-              dra_receive_control_message(dra_nbr_id, rx_dra_m, rx_dra_seq, dra_nbr_eb_1_bc_2_uc_3);
-            }
-#elif WITH_TRGB
-            formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-            uint16_t hckim_formation_rx_info_1 = 0; /* Store packet type and trgb_tx_cell */
-            uint16_t hckim_formation_rx_info_2 = 0; /* Store trgb_parent_id */
-
-            trgb_received_tx_cell = 0;
-            trgb_received_parent_id = 0;
-
-            if(frame.fcf.frame_type != FRAME802154_BEACONFRAME) {
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_header_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                trgb_received_tx_cell = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-
                 hckim_formation_rx_info_2 = (int)formation_ies.ie_header_piggybacking_info_2;
-                trgb_received_parent_id = (uint8_t)((hckim_formation_rx_info_2 >> 8) & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-              }
-            } else { /* EB case */
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-                
+              } else { /* EB case */
                 hckim_formation_rx_info_1 = (int)formation_ies.ie_eb_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                trgb_received_tx_cell = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-
                 hckim_formation_rx_info_2 = (int)formation_ies.ie_eb_piggybacking_info_2;
-                trgb_received_parent_id = (uint8_t)((hckim_formation_rx_info_2 >> 8) & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_EB;
               }
+              formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
+            } else if(frame.fcf.frame_type == FRAME802154_BEACONFRAME) {
+              formation_rx_packet_type = HCK_PACKET_TYPE_EB;
             }
 
-            struct tsch_neighbor *trgb_n = tsch_queue_get_nbr(&source_address);
-            rpl_instance_t *trgb_instance = rpl_get_default_instance();
-
-            if(trgb_n != NULL 
-              && trgb_n->is_time_source
-              && trgb_instance != NULL 
-              && trgb_instance->current_dag->preferred_parent != NULL
-              && HCK_GET_NODE_ID_FROM_LINKADDR(rpl_get_parent_lladdr(trgb_instance->current_dag->preferred_parent)) 
-                 == HCK_GET_NODE_ID_FROM_LINKADDR(&source_address)) {
-              if(formation_rx_packet_type == HCK_PACKET_TYPE_EB
-                || formation_rx_packet_type == HCK_PACKET_TYPE_M_DIO) {
-                if(trgb_received_tx_cell == TRGB_CELL_GREEN) {
-                  trgb_my_tx_cell = TRGB_CELL_BLUE;
-                } else if(trgb_received_tx_cell == TRGB_CELL_BLUE) {
-                  trgb_my_tx_cell = TRGB_CELL_GREEN;
-                } else {
-                  trgb_my_tx_cell = TRGB_CELL_NULL;
-                }
-                trgb_grandP_id = trgb_received_parent_id;
-              }
-            }
+            SHARED_CELL_POLICY->rx_info(&frame, &source_address, hckim_formation_rx_info_1, hckim_formation_rx_info_2);
 
-#if TRGB_DBG
-            TSCH_LOG_ADD(tsch_log_message,
-                snprintf(log->message, sizeof(log->message),
-                "TRGB rx info %u %u %u %u", formation_rx_packet_type, 
-                                            trgb_received_tx_cell, 
-                                            trgb_received_parent_id,
-                                            trgb_my_tx_cell));
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+            /* Lower byte of info 2: number of burst cells requested */
+            dbt_rx_requested_len = frame.fcf.frame_type != FRAME802154_BEACONFRAME ?
+                                   (uint8_t)(hckim_formation_rx_info_2 & 0xFF) : 0;
 #endif
-#elif WITH_QUICK6
-            formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-            quick6_rx_current_offset = QUICK6_OFFSET_NULL;
-
-            uint16_t hckim_formation_rx_info_1 = 0; /* Store packet type and rx offset */
-
-            if(frame.fcf.frame_type != FRAME802154_BEACONFRAME) {
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
-
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_header_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                quick6_rx_current_offset = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_NULL;
-                quick6_rx_current_offset = QUICK6_OFFSET_NULL;
-              }
-            } else { /* EB case */
-              if(frame.fcf.ie_list_present) {
-                struct ieee802154_ies formation_ies;
-                frame802154e_parse_information_elements(frame.payload, frame.payload_len, &formation_ies);
 
-                hckim_formation_rx_info_1 = (int)formation_ies.ie_eb_piggybacking_info_1;
-                formation_rx_packet_type = (uint8_t)((hckim_formation_rx_info_1 >> 8) & 0xFF);
-                quick6_rx_current_offset = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
-              } else {
-                formation_rx_packet_type = HCK_PACKET_TYPE_EB;
-                quick6_rx_current_offset = QUICK6_OFFSET_NULL;
-              }
+#if WITH_QUICK6
+            if(frame.fcf.ie_list_present) {
+              quick6_rx_current_offset = (uint8_t)(hckim_formation_rx_info_1 & 0xFF);
+            } else {
+              quick6_rx_current_offset = QUICK6_OFFSET_NULL;
             }
 
             if(current_link->slotframe_handle == QUICK6_SLOTFRAME_HANDLE) {
@@ -3170,8 +3537,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                 snprintf(log->message, sizeof(log->message),
                 "Q6 rx info %u %u", formation_rx_packet_type, quick6_rx_current_offset));
 #endif
-
-#endif /* !WITH_DRA && !WITH_TRGB && !WITH_QUICK6 */
+#endif /* WITH_QUICK6 */
 #endif /* HCK_FORMATION_PACKET_TYPE_INFO */
 
             estimated_drift = RTIMER_CLOCK_DIFF(expected_rx_time, rx_start_time);
@@ -3217,6 +3583,11 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if MODIFIED_TSCH_DEFAULT_BURST_TRANSMISSION
               /* Schedule a burst link iff the frame pending bit was set */
               int frame_pending_bit_set_or_not = tsch_packet_get_frame_pending(current_input->payload, current_input->len);
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+              if(dbt_reserved_slots > 0) {
+                /* Within a reserved burst: keep it until its last cell */
+              } else
+#endif
               if(frame_pending_bit_set_or_not) {
 
 #if TSCH_DBT_QUEUE_AWARENESS
@@ -3247,7 +3618,15 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #endif
 
                   uint16_t time_to_earliest_schedule = 0;
-                  if(tsch_schedule_get_next_timeslot_available_or_not(&tsch_current_asn, &time_to_earliest_schedule)) {
+                  if(tsch_schedule_get_next_timeslot_available_or_not(&tsch_current_asn, &time_to_earliest_schedule)
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+#if TSCH_DBT_QUEUE_AWARENESS
+                     && dbt_reservation_grant(time_to_earliest_schedule, dbt_min_empty_space_of_ringbuf_or_queue)
+#else
+                     && dbt_reservation_grant(time_to_earliest_schedule, TSCH_BURST_MAX_LEN)
+#endif
+#endif
+                    ) {
                     burst_link_scheduled = 1;
 #if ENABLE_MODIFIED_DBT_LOG
                     TSCH_LOG_ADD(tsch_log_message,
@@ -3363,8 +3742,18 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               tsch_schedule_keepalive(0);
             }
 
+#if HCK_MOD_TSCH_RX_SKIP
+            if(frame.fcf.ack_required
+               && current_link->slotframe_handle == HCK_TSCH_RX_SKIP_SF_HANDLE) {
+              tsch_schedule_rx_skip_mark(tsch_schedule_rx_skip_of_link(current_link));
+            }
+#endif
+
             /* Add current input to ringbuf */
             ringbufindex_put(&input_ringbuf);
+#if HCK_LOG_TSCH_SLOT_ENERGY
+            slot_energy_outcome = TSCH_SLOT_ENERGY_RX_OK;
+#endif
 
             /* If the neighbor is known, update its stats */
             if(n != NULL) {
@@ -3644,6 +4033,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 #if TSCH_DBT_HOLD_CURRENT_NBR
         burst_link_tx = 0;
         burst_link_rx = 0;
+#endif
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+        dbt_reserved_slots = 0;
 #endif
         TSCH_LOG_ADD(tsch_log_message,
                         snprintf(log->message, sizeof(log->message),
@@ -3896,6 +4288,17 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 #endif
 #endif /* TSCH_SCHEDULE_CONF_WITH_6TISCH_MINIMAL */
       is_active_slot = current_packet != NULL || (current_link->link_options & LINK_OPTION_RX);
+#if HCK_MOD_TSCH_RX_SKIP
+      /* Nothing to send, and no sender expects us to listen on this occurrence */
+      if(is_active_slot && current_packet == NULL
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+         && !burst_link_scheduled
+#endif
+         && !tsch_schedule_rx_skip_is_awake(tsch_schedule_rx_skip_of_link(current_link), current_link)) {
+        is_active_slot = 0;
+        tsch_rx_skip_count++;
+      }
+#endif
       if(is_active_slot) {
 
 #if WITH_OST
@@ -3961,12 +4364,22 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         tsch_current_timeslot = current_link->timeslot; // hckim
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
         if(burst_link_scheduled) {
-          /* Reset burst_link_scheduled flag. Will be set again if burst continue. */
-          burst_link_scheduled = 0;
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+          /* Consume one reserved cell, the burst stays scheduled
+             at both ends until its last cell */
+          if(dbt_reserved_slots > 0) {
+            --dbt_reserved_slots;
+          }
+          if(dbt_reserved_slots == 0)
+#endif
+          {
+            /* Reset burst_link_scheduled flag. Will be set again if burst continue. */
+            burst_link_scheduled = 0;
 #if TSCH_DBT_HOLD_CURRENT_NBR
-          burst_link_tx = 0;
-          burst_link_rx = 0;
+            burst_link_tx = 0;
+            burst_link_rx = 0;
 #endif
+          }
           is_burst_slot = 1;
         } else 
 #endif
@@ -3975,10 +4388,34 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
           tsch_current_channel_offset = tsch_get_channel_offset(current_link, current_packet);
           tsch_current_channel = tsch_calculate_channel(&tsch_current_asn, tsch_current_channel_offset);
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+          if(current_link->slotframe_handle == HCK_TSCH_LINK_BLACKLIST_SLOTFRAME_HANDLE) {
+            uint16_t lcb_map = 0;
+            if(current_packet != NULL) {
+              lcb_map = tsch_stats_lcb_get_tx_map(current_neighbor, &tsch_current_asn);
+            } else if(current_link->link_options & LINK_OPTION_RX) {
+              lcb_map = tsch_stats_lcb_get_rx_map(&tsch_current_asn);
+            }
+            if(lcb_map != 0) {
+              uint8_t lcb_channel = tsch_calculate_channel_with_blacklist(&tsch_current_asn,
+                                                                         tsch_current_channel_offset, lcb_map);
+              if(lcb_channel != tsch_current_channel) {
+                if(current_packet != NULL) {
+                  ++tsch_lcb_tx_remap_count;
+                } else {
+                  ++tsch_lcb_rx_remap_count;
+                }
+                tsch_current_channel = lcb_channel;
+              }
+            }
+          }
+#endif
+
 #if WITH_TRGB
           trgb_skip_slot = 0;
 
-          if(current_link->slotframe_handle == TRGB_SLOTFRAME_HANDLE) { /* TRGB: common shared cell only */
+          if(current_link->slotframe_handle == TRGB_SLOTFRAME_HANDLE
+             && SHARED_CELL_VARIANT_ACTIVE()) { /* TRGB: common shared cell only */
             /* calulcate ASFN */
             uint64_t trgb_asfn = 0;
             struct tsch_slotframe *cs_sf = tsch_schedule_get_slotframe_by_handle(TRGB_SLOTFRAME_HANDLE);
@@ -4075,6 +4512,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 #endif
 
         NETSTACK_RADIO.set_value(RADIO_PARAM_CHANNEL, tsch_current_channel);
+#if HCK_LOG_TSCH_SLOT_ENERGY
+        slot_energy_radio_start = slot_energy_radio_time();
+#endif
         /* Turn the radio on already here if configured so; necessary for radios with slow startup */
         tsch_radio_on(TSCH_RADIO_CMD_ON_START_OF_TIMESLOT);
         /* Decide whether it is a TX/RX/IDLE or OFF slot */
@@ -4106,6 +4546,13 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 #endif
           PT_SPAWN(&slot_operation_pt, &slot_rx_pt, tsch_rx_slot(&slot_rx_pt, t));
         }
+#if HCK_LOG_TSCH_SLOT_ENERGY
+#if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
+        slot_energy_account(current_link, is_burst_slot);
+#else
+        slot_energy_account(current_link, 0);
+#endif
+#endif
 #if WITH_TSCH_DEFAULT_BURST_TRANSMISSION
         if(is_burst_slot) {
           is_burst_slot = 0;
@@ -4135,6 +4582,9 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         burst_link_tx = 0;
         burst_link_rx = 0;
 #endif
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+        dbt_reserved_slots = 0;
+#endif
 #endif
       }
 
@@ -4170,6 +4620,14 @@ ost_donothing:
     TSCH_ASN_INC(tsch_current_asn, hck_curr_passed_timeslots_except_first_slot);
 #endif
 
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+    /* The slot is over and the next link is not selected yet: apply the
+     * requests of process context, unless it is inside a locked section */
+    if(!tsch_locked) {
+      tsch_request_apply_pending();
+    }
+#endif
+
     /* End of slot operation, schedule next slot or resynchronize */
 
     if(tsch_is_coordinator) {
@@ -4223,6 +4681,9 @@ ost_donothing:
           burst_link_tx = 0;
           burst_link_rx = 0;
 #endif
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+          dbt_reserved_slots = 0;
+#endif
 
           TSCH_LOG_ADD(tsch_log_message,
                           snprintf(log->message, sizeof(log->message),
@@ -83,6 +83,49 @@ int tsch_get_lock(void);
  * Releases the TSCH lock.
  */
 void tsch_release_lock(void);
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+#include "net/linkaddr.h"
+
+#ifdef HCK_TSCH_CONF_REQUEST_QUEUE_LEN
+#define HCK_TSCH_REQUEST_QUEUE_LEN HCK_TSCH_CONF_REQUEST_QUEUE_LEN
+#else
+#define HCK_TSCH_REQUEST_QUEUE_LEN 8
+#endif
+#if (HCK_TSCH_REQUEST_QUEUE_LEN & (HCK_TSCH_REQUEST_QUEUE_LEN - 1)) != 0
+#error HCK_TSCH_REQUEST_QUEUE_LEN must be power of two
+#endif
+
+/* A mutation of TSCH state requested from process context */
+struct tsch_request {
+  void (*apply)(const struct tsch_request *req);
+  linkaddr_t addr;
+  uint16_t arg1;
+  uint16_t arg2;
+};
+
+extern uint32_t tsch_request_post_count;
+extern uint32_t tsch_request_full_count;
+
+/**
+ * Hand a mutation of TSCH queues over to slot operation instead of taking
+ * the TSCH lock. To be called from process context only. Only for
+ * mutations whose caller needs no result and that do not call back into
+ * upper layers: neighbor add/remove, queue flush and packet replacement
+ * return results or run MAC sent callbacks, and keep the lock. The request is
+ * applied at the end of the current or next slot, or in place when not
+ * associated. apply runs in interrupt context and must look up its target
+ * again from addr, as it may have been removed meanwhile.
+ *
+ * \param apply the function applying the request
+ * \param addr the address of the target neighbor
+ * \param arg1 first request argument
+ * \param arg2 second request argument
+ * \return 1 if the request was queued or applied, 0 otherwise
+ */
+int tsch_request_post(void (*apply)(const struct tsch_request *),
+                      const linkaddr_t *addr, uint16_t arg1, uint16_t arg2);
+#endif /* HCK_MOD_TSCH_LOCKFREE_HANDOFF */
+
 /**
  * Set global time before starting slot operation, with a rtimer time and an ASN
  *
@@ -96,5 +139,28 @@ void tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
  */
 void tsch_slot_operation_start(void);
 
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+/**
+ * Select the shared-cell policy used by slot operation: the compiled
+ * variant or the minimal fallback. Refused while associated, as all nodes
+ * of a network must run the same policy.
+ *
+ * \param name the policy name, see tsch_shared_cell_policy_get()
+ * \return 1 if the policy was selected, 0 otherwise
+ */
+int tsch_shared_cell_policy_select(const char *name);
+/**
+ * Get the name of the shared-cell policy in use
+ */
+const char *tsch_shared_cell_policy_current(void);
+/**
+ * Get the name of a shared-cell policy available in this image
+ *
+ * \param index the policy index, starting from 0
+ * \return the policy name, or NULL if index is out of range
+ */
+const char *tsch_shared_cell_policy_get(int index);
+#endif /* HCK_MOD_TSCH_SHARED_CELL_POLICY */
+
 #endif /* __TSCH_SLOT_OPERATION_H__ */
 /** @} */
@@ -38,6 +38,10 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/netstack.h"
 #include "dev/radio.h"
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+#include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/uip-ds6-route.h"
+#endif
 
 /* Log configuration */
 #include "sys/log.h"
@@ -234,3 +238,365 @@ periodic(void *ptr)
 /*---------------------------------------------------------------------------*/
 #endif /* TSCH_STATS_ON */
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/*---------------------------------------------------------------------------*/
+
+/* How often blacklists are re-evaluated and Tx failure rates decayed */
+#ifndef HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL
+#define HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL (8 * CLOCK_SECOND)
+#endif
+
+/* A channel is blacklisted above this Tx failure rate... */
+#ifndef HCK_TSCH_LINK_BLACKLIST_BAD_FAIL
+#define HCK_TSCH_LINK_BLACKLIST_BAD_FAIL (TSCH_STATS_BINARY_SCALING_FACTOR / 2)
+#endif
+
+/* ...and released once it has decayed below this one */
+#ifndef HCK_TSCH_LINK_BLACKLIST_GOOD_FAIL
+#define HCK_TSCH_LINK_BLACKLIST_GOOD_FAIL (TSCH_STATS_BINARY_SCALING_FACTOR / 4)
+#endif
+
+/* An epoch lasts 2^EPOCH_SHIFT timeslots */
+#ifndef HCK_TSCH_LINK_BLACKLIST_EPOCH_SHIFT
+#define HCK_TSCH_LINK_BLACKLIST_EPOCH_SHIFT 9
+#endif
+
+/* A new blacklist takes effect this many epochs after it was decided.
+ * By default, two of the longest EB periods: long enough for a child to
+ * get it even after missing one EB, and for two hops of EBs to carry it */
+#ifdef HCK_TSCH_LINK_BLACKLIST_ACTIVATION_EPOCHS
+#define LCB_ACTIVATION_EPOCHS() HCK_TSCH_LINK_BLACKLIST_ACTIVATION_EPOCHS
+#else
+#define LCB_ACTIVATION_EPOCHS() lcb_eb_periods_to_epochs(2)
+#endif
+
+/* A child that has not heard an EB of its time source for this many of
+ * the longest EB periods drops its blacklist */
+#ifndef HCK_TSCH_LINK_BLACKLIST_RESYNC_EBS
+#define HCK_TSCH_LINK_BLACKLIST_RESYNC_EBS 3
+#endif
+
+/* A parent drops the blacklist of a child after this many consecutive
+ * unicast Tx failures toward it */
+#ifndef HCK_TSCH_LINK_BLACKLIST_RESYNC_TX_FAILS
+#define HCK_TSCH_LINK_BLACKLIST_RESYNC_TX_FAILS 8
+#endif
+
+/* Channels of the hopping sequence that are never blacklisted on a link */
+#ifndef HCK_TSCH_LINK_BLACKLIST_MIN_CHANNELS
+#define HCK_TSCH_LINK_BLACKLIST_MIN_CHANNELS 2
+#endif
+
+#define LCB_EPOCH(asn) ((uint16_t)((asn)->ls4b >> HCK_TSCH_LINK_BLACKLIST_EPOCH_SHIFT))
+
+/* Our own receive blacklist, as decided by our time source */
+static uint16_t lcb_rx_map;
+static uint16_t lcb_rx_next_map;
+static uint16_t lcb_rx_next_epoch;
+/* Epoch of the last EB of our time source */
+static uint16_t lcb_ts_eb_epoch;
+
+static struct ctimer lcb_periodic_timer;
+
+static void lcb_periodic(void *);
+
+/*---------------------------------------------------------------------------*/
+/* A number of the longest EB periods, in epochs, rounded up, plus the
+ * epoch under way */
+static uint16_t
+lcb_eb_periods_to_epochs(uint8_t periods)
+{
+  uint32_t eb_period_ms = (uint32_t)TSCH_MAX_EB_PERIOD * 1000 / CLOCK_SECOND;
+  uint32_t slots = periods * eb_period_ms * 1000 / tsch_timing_us[tsch_ts_timeslot_length];
+  return (slots >> HCK_TSCH_LINK_BLACKLIST_EPOCH_SHIFT) + 2;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+lcb_effective_map(uint16_t map, uint16_t next_map, uint16_t next_epoch,
+                  const struct tsch_asn_t *asn)
+{
+  if(next_map != map && (int16_t)(LCB_EPOCH(asn) - next_epoch) >= 0) {
+    return next_map;
+  }
+  return map;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+lcb_count_channels(uint16_t map)
+{
+  uint8_t count = 0;
+  while(map) {
+    map &= map - 1;
+    count++;
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+lcb_hopping_sequence_map(void)
+{
+  uint16_t map = 0;
+  uint8_t i;
+  for(i = 0; i < tsch_hopping_sequence_length.val; i++) {
+    uint8_t index = tsch_stats_channel_to_index(tsch_hopping_sequence[i]);
+    if(index < TSCH_STATS_NUM_CHANNELS) {
+      map |= 1 << index;
+    }
+  }
+  return map;
+}
+/*---------------------------------------------------------------------------*/
+/* Are we the preferred parent of this neighbor, i.e., its time source? */
+static int
+lcb_is_child(const struct tsch_neighbor *n)
+{
+  const linkaddr_t *lladdr = tsch_queue_get_nbr_address(n);
+  const uip_ipaddr_t *ipaddr;
+
+  if(lladdr == NULL) {
+    return 0;
+  }
+  ipaddr = uip_ds6_nbr_ipaddr_from_lladdr((const uip_lladdr_t *)lladdr);
+  return ipaddr != NULL && uip_ds6_route_is_nexthop(ipaddr) == 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Receive blacklist for a child, from our Tx failure rates toward it */
+static uint16_t
+lcb_decide(const struct tsch_neighbor *n, uint16_t hopping_map)
+{
+  uint16_t map = 0;
+  uint8_t i;
+
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++) {
+    uint16_t bit = 1 << i;
+    if((hopping_map & bit) == 0) {
+      continue;
+    }
+    if(n->lcb_tx_fail[i] > HCK_TSCH_LINK_BLACKLIST_BAD_FAIL
+       || ((n->lcb_rx_map & bit) && n->lcb_tx_fail[i] > HCK_TSCH_LINK_BLACKLIST_GOOD_FAIL)) {
+      map |= bit;
+    }
+  }
+
+  /* Release the least bad channels until enough of the sequence is left */
+  while(map != 0
+        && lcb_count_channels(hopping_map & ~map) < HCK_TSCH_LINK_BLACKLIST_MIN_CHANNELS) {
+    uint8_t best = TSCH_STATS_NUM_CHANNELS;
+    for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++) {
+      if((map & (1 << i))
+         && (best == TSCH_STATS_NUM_CHANNELS || n->lcb_tx_fail[i] < n->lcb_tx_fail[best])) {
+        best = i;
+      }
+    }
+    map &= ~(1 << best);
+  }
+
+  return map;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_lcb_init(void)
+{
+  lcb_rx_map = 0;
+  lcb_rx_next_map = 0;
+  lcb_rx_next_epoch = 0;
+  lcb_ts_eb_epoch = 0;
+  ctimer_set(&lcb_periodic_timer, HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL, lcb_periodic, NULL);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_lcb_tx_packet(struct tsch_neighbor *n, uint8_t mac_status, uint8_t channel)
+{
+  uint8_t index = tsch_stats_channel_to_index(channel);
+
+  if(n != NULL && !n->is_broadcast && index < TSCH_STATS_NUM_CHANNELS) {
+    uint16_t new_fail_value = (mac_status == MAC_TX_OK ? 0 : 1);
+    new_fail_value *= TSCH_STATS_BINARY_SCALING_FACTOR;
+    TSCH_STATS_EWMA_UPDATE(n->lcb_tx_fail[index], new_fail_value);
+    if(mac_status == MAC_TX_OK) {
+      n->lcb_tx_fail_run = 0;
+    } else if(n->lcb_tx_fail_run < 0xff) {
+      n->lcb_tx_fail_run++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_stats_lcb_get_tx_map(const struct tsch_neighbor *n, const struct tsch_asn_t *asn)
+{
+  if(n == NULL || n->is_broadcast) {
+    return 0;
+  }
+  return lcb_effective_map(n->lcb_rx_map, n->lcb_rx_next_map, n->lcb_rx_next_epoch, asn);
+}
+/*---------------------------------------------------------------------------*/
+uint16_t
+tsch_stats_lcb_get_rx_map(const struct tsch_asn_t *asn)
+{
+  return lcb_effective_map(lcb_rx_map, lcb_rx_next_map, lcb_rx_next_epoch, asn);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_lcb_fill_eb_ies(struct ieee802154_ies *ies)
+{
+  struct tsch_neighbor *ts = tsch_queue_get_time_source();
+  struct tsch_neighbor *n;
+
+  ies->ie_lcb_rx_map = lcb_rx_map;
+  ies->ie_lcb_rx_next_map = lcb_rx_next_map;
+  ies->ie_lcb_rx_next_epoch = lcb_rx_next_epoch;
+  ies->ie_lcb_num_entries = 0;
+
+  /* lcb_periodic keeps at most MAX_ENTRIES children with a blacklist,
+   * so a child that is not listed has none */
+  for(n = tsch_queue_first_nbr(); n != NULL; n = tsch_queue_next_nbr(n)) {
+    if(n->is_broadcast || n == ts
+       || (n->lcb_rx_map == 0 && n->lcb_rx_next_map == 0 && !n->lcb_resync)) {
+      continue;
+    }
+    if(ies->ie_lcb_num_entries >= HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES) {
+      break;
+    }
+    ies->ie_lcb_entry_id[ies->ie_lcb_num_entries] =
+      HCK_GET_NODE_ID_FROM_LINKADDR(tsch_queue_get_nbr_address(n));
+    ies->ie_lcb_entry_map[ies->ie_lcb_num_entries] = n->lcb_rx_map;
+    ies->ie_lcb_entry_next_map[ies->ie_lcb_num_entries] = n->lcb_rx_next_map;
+    ies->ie_lcb_entry_next_epoch[ies->ie_lcb_num_entries] = n->lcb_rx_next_epoch;
+    ies->ie_lcb_num_entries++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_lcb_eb_input(const linkaddr_t *src, const struct ieee802154_ies *ies)
+{
+  struct tsch_neighbor *ts = tsch_queue_get_time_source();
+  linkaddr_t *ts_addr = tsch_queue_get_nbr_address(ts);
+  uint16_t my_id = HCK_GET_NODE_ID_FROM_LINKADDR(&linkaddr_node_addr);
+  uint8_t i;
+
+  /* Only the time source decides for us, and we only need its own
+   * blacklist to send to it */
+  if(!ies->ie_lcb_present || ts_addr == NULL || !linkaddr_cmp(src, ts_addr)) {
+    return;
+  }
+
+  ts->lcb_rx_map = ies->ie_lcb_rx_map;
+  ts->lcb_rx_next_map = ies->ie_lcb_rx_next_map;
+  ts->lcb_rx_next_epoch = ies->ie_lcb_rx_next_epoch;
+  lcb_ts_eb_epoch = LCB_EPOCH(&tsch_current_asn);
+
+  /* An entry is adopted as is: one whose epoch has already passed, e.g.
+   * after we missed the EBs announcing it, takes effect at once */
+  for(i = 0; i < ies->ie_lcb_num_entries; i++) {
+    if(ies->ie_lcb_entry_id[i] == my_id) {
+      lcb_rx_map = ies->ie_lcb_entry_map[i];
+      lcb_rx_next_map = ies->ie_lcb_entry_next_map[i];
+      lcb_rx_next_epoch = ies->ie_lcb_entry_next_epoch[i];
+      return;
+    }
+  }
+
+  /* Not listed: the time source has no blacklist for us (e.g. we have
+   * just switched to it). Drop ours with the usual delay, so that our
+   * children learn about it before it happens. */
+  if(lcb_rx_next_map != 0) {
+    lcb_rx_next_map = 0;
+    lcb_rx_next_epoch = LCB_EPOCH(&tsch_current_asn) + LCB_ACTIVATION_EPOCHS();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Called every HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL ticks */
+static void
+lcb_periodic(void *ptr)
+{
+  struct tsch_asn_t now;
+  struct tsch_neighbor *ts;
+  struct tsch_neighbor *n;
+  uint16_t hopping_map;
+  uint8_t num_entries = 0;
+  uint8_t i;
+
+  if(!tsch_is_associated) {
+    lcb_rx_map = 0;
+    lcb_rx_next_map = 0;
+    ctimer_set(&lcb_periodic_timer, HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL, lcb_periodic, NULL);
+    return;
+  }
+
+  TSCH_ASN_COPY(now, tsch_current_asn);
+  ts = tsch_queue_get_time_source();
+  hopping_map = lcb_hopping_sequence_map();
+
+  lcb_rx_map = lcb_effective_map(lcb_rx_map, lcb_rx_next_map, lcb_rx_next_epoch, &now);
+
+  /* Without EBs from our time source, we cannot tell whether it changed
+   * our blacklist: fall back to the plain hopping sequence, as it does
+   * once its frames to us keep failing */
+  if(ts != NULL && (lcb_rx_map != 0 || lcb_rx_next_map != 0)
+     && (uint16_t)(LCB_EPOCH(&now) - lcb_ts_eb_epoch)
+        > lcb_eb_periods_to_epochs(HCK_TSCH_LINK_BLACKLIST_RESYNC_EBS)) {
+    lcb_rx_map = 0;
+    lcb_rx_next_map = 0;
+    tsch_lcb_resync_count++;
+  }
+
+  /* Activate due blacklists and forget those of former children */
+  for(n = tsch_queue_first_nbr(); n != NULL; n = tsch_queue_next_nbr(n)) {
+    if(n->is_broadcast) {
+      continue;
+    }
+    n->lcb_rx_map = lcb_effective_map(n->lcb_rx_map, n->lcb_rx_next_map, n->lcb_rx_next_epoch, &now);
+    if(n != ts) {
+      if(n->lcb_resync && (int16_t)(LCB_EPOCH(&now) - n->lcb_rx_next_epoch) >= 0) {
+        n->lcb_resync = 0;
+      }
+      if(!lcb_is_child(n)) {
+        n->lcb_rx_map = 0;
+        n->lcb_rx_next_map = 0;
+        n->lcb_resync = 0;
+      } else if((n->lcb_rx_map != 0 || n->lcb_rx_next_map != 0)
+                && n->lcb_tx_fail_run >= HCK_TSCH_LINK_BLACKLIST_RESYNC_TX_FAILS) {
+        /* The child may have missed the change: both fall back to the
+         * plain hopping sequence at once, and we announce it */
+        n->lcb_rx_map = 0;
+        n->lcb_rx_next_map = 0;
+        n->lcb_rx_next_epoch = LCB_EPOCH(&now) + LCB_ACTIVATION_EPOCHS();
+        n->lcb_resync = 1;
+        n->lcb_tx_fail_run = 0;
+        tsch_lcb_resync_count++;
+      }
+      if(n->lcb_rx_map != 0 || n->lcb_rx_next_map != 0 || n->lcb_resync) {
+        num_entries++;
+      }
+    }
+  }
+
+  /* Decide the next blacklist of each child, then decay the failure rates
+   * so that a blacklisted channel, no longer used, is eventually retried */
+  for(n = tsch_queue_first_nbr(); n != NULL; n = tsch_queue_next_nbr(n)) {
+    if(n->is_broadcast) {
+      continue;
+    }
+    /* One change at a time: wait until the pending one is active */
+    if(n != ts && n->lcb_rx_next_map == n->lcb_rx_map && !n->lcb_resync && lcb_is_child(n)) {
+      uint16_t map = lcb_decide(n, hopping_map);
+      if(map != n->lcb_rx_map
+         && (n->lcb_rx_map != 0 || num_entries < HCK_TSCH_LINK_BLACKLIST_MAX_ENTRIES)) {
+        if(n->lcb_rx_map == 0) {
+          num_entries++;
+        }
+        n->lcb_rx_next_map = map;
+        n->lcb_rx_next_epoch = LCB_EPOCH(&now) + LCB_ACTIVATION_EPOCHS();
+        tsch_lcb_update_count++;
+      }
+    }
+    for(i = 0; i < TSCH_STATS_NUM_CHANNELS; i++) {
+      TSCH_STATS_EWMA_UPDATE(n->lcb_tx_fail[i], 0);
+    }
+  }
+
+  ctimer_set(&lcb_periodic_timer, HCK_TSCH_LINK_BLACKLIST_UPDATE_INTERVAL, lcb_periodic, NULL);
+}
+/*---------------------------------------------------------------------------*/
+#endif /* HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST */
+/*---------------------------------------------------------------------------*/
@@ -218,6 +218,33 @@ tsch_stats_index_to_channel(uint8_t channel_index)
   return channel_index + TSCH_STATS_FIRST_CHANNEL;
 }
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+/*
+ * Per-link channel blacklist. A parent tracks the unicast Tx failure
+ * rate toward each neighbor and channel, decides the receive blacklist
+ * of its children from it and announces it in its EBs. A child adopts
+ * its time source's decision, applies it to its own Rx cells and
+ * repeats it in its EBs for its own children. A blacklisted channel is
+ * replaced by the next usable entry of the hopping sequence, and
+ * changes take effect at an epoch boundary announced in advance.
+ */
+struct ieee802154_ies; /* Forward declaration */
+
+void tsch_stats_lcb_init(void);
+
+void tsch_stats_lcb_tx_packet(struct tsch_neighbor *, uint8_t mac_status, uint8_t channel);
+
+/* Blacklist to apply when sending to a neighbor, safe in interrupt context */
+uint16_t tsch_stats_lcb_get_tx_map(const struct tsch_neighbor *, const struct tsch_asn_t *asn);
+
+/* Blacklist to apply to our own Rx cells, safe in interrupt context */
+uint16_t tsch_stats_lcb_get_rx_map(const struct tsch_asn_t *asn);
+
+void tsch_stats_lcb_fill_eb_ies(struct ieee802154_ies *ies);
+
+void tsch_stats_lcb_eb_input(const linkaddr_t *src, const struct ieee802154_ies *ies);
+#endif
+
 
 #endif /* __TSCH_STATS_H__ */
 /** @} */
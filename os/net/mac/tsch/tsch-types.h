@@ -120,6 +120,15 @@ enum QUICK6_PACKET_CRITICALITY {
 /** \brief 802.15.4e link types. LINK_TYPE_ADVERTISING_ONLY is an extra one: for EB-only links. */
 enum link_type { LINK_TYPE_NORMAL, LINK_TYPE_ADVERTISING, LINK_TYPE_ADVERTISING_ONLY };
 
+#if HCK_MOD_TSCH_RX_SKIP
+/** \brief Last acknowledged unicast exchange on the Rx-skip slotframe,
+ * kept per Rx link by the receiver and per neighbor by the sender */
+struct tsch_rx_skip {
+  uint32_t last_asn; /* ls4b of the ASN of the last exchange */
+  uint8_t seen; /* 0 until the first exchange: treated as idle for ever */
+};
+#endif
+
 /** \brief An IEEE 802.15.4-2015 TSCH link (also called cell or slot) */
 struct tsch_link {
   /* Links are stored as a list: "next" must be the first field */
@@ -146,6 +155,10 @@ struct tsch_link {
   /* Type of link. NORMAL = 0. ADVERTISING = 1, and indicates
      the link may be used to send an Enhanced beacon. */
   enum link_type link_type;
+#if HCK_MOD_TSCH_RX_SKIP
+  /* Last unicast frame received on this link */
+  struct tsch_rx_skip rx_skip;
+#endif
   /* Any other data for upper layers */
   void *data;
 };
@@ -214,6 +227,18 @@ struct tsch_neighbor {
 #endif
   uint8_t tx_links_count; /* How many links do we have to this neighbor? */
   uint8_t dedicated_tx_links_count; /* How many dedicated links do we have to this neighbor? */
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  uint16_t lcb_tx_fail[16]; /* EWMA of unicast Tx failure toward this neighbor, per 2.4 GHz channel (11..26) */
+  uint16_t lcb_tx_bad_map; /* Channels we report as bad toward this neighbor in our EBs */
+  uint16_t lcb_rx_map; /* Receive blacklist advertised by this neighbor, currently active */
+  uint16_t lcb_rx_next_map; /* Receive blacklist advertised by this neighbor, active from lcb_rx_next_epoch */
+  uint16_t lcb_rx_next_epoch;
+  uint8_t lcb_tx_fail_run; /* Consecutive unicast Tx failures toward this neighbor */
+  uint8_t lcb_resync; /* Blacklist dropped after a resync, announced until lcb_rx_next_epoch */
+#endif
+#if HCK_MOD_TSCH_RX_SKIP
+  struct tsch_rx_skip rx_skip; /* Last unicast frame to this neighbor that was ACKed */
+#endif
   /* Array for the ringbuf. Contains pointers to packets.
    * Its size must be a power of two to allow for atomic put */
   struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
@@ -68,6 +68,11 @@
 #include "net/routing/rpl-classic/rpl-private.h"
 #endif
 
+#if HCK_LOG_TSCH_SLOT_ENERGY
+#include <stdio.h>
+#include <string.h>
+#endif
+
 #if FRAME802154_VERSION < FRAME802154_IEEE802154_2015
 #error TSCH: FRAME802154_VERSION must be at least FRAME802154_IEEE802154_2015
 #endif
@@ -406,6 +411,36 @@ uint16_t tsch_input_ringbuf_available_count;
 uint16_t tsch_dequeued_ringbuf_full_count;
 uint16_t tsch_dequeued_ringbuf_available_count;
 
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+uint32_t tsch_dbt_reservation_count;
+uint32_t tsch_dbt_reservation_cell_count;
+uint32_t tsch_dbt_reservation_deny_count;
+#endif
+
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+uint32_t tsch_lcb_tx_remap_count;
+uint32_t tsch_lcb_rx_remap_count;
+uint32_t tsch_lcb_update_count;
+uint32_t tsch_lcb_resync_count;
+#endif
+
+#if HCK_MOD_TSCH_RX_SKIP
+uint32_t tsch_rx_skip_count;
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+uint32_t tsch_slot_energy_count[HCK_TSCH_SLOT_ENERGY_CLASSES][TSCH_SLOT_ENERGY_OUTCOMES];
+uint32_t tsch_slot_energy_ticks[HCK_TSCH_SLOT_ENERGY_CLASSES][TSCH_SLOT_ENERGY_OUTCOMES];
+#endif
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+uint32_t tsch_shared_cell_select_count;
+uint32_t tsch_shared_cell_select_ticks_sum;
+uint32_t tsch_shared_cell_select_ticks_max;
+uint32_t tsch_shared_cell_dispatch_ticks_sum;
+uint32_t tsch_shared_cell_dispatch_ticks_max;
+#endif
+
 /* hckim measure cell utilization during association */
 uint32_t tsch_scheduled_eb_sf_cell_count;
 uint32_t tsch_scheduled_common_sf_cell_count;
@@ -457,6 +492,80 @@ uint32_t tsch_ost_pp_sf_bst_rx_operation_count;
 uint16_t alice_early_packet_drop_count;
 #endif
 
+#if HCK_LOG_TSCH_SLOT_ENERGY
+/*---------------------------------------------------------------------------*/
+static uint8_t *
+slot_energy_write32(uint8_t *p, uint32_t v)
+{
+  p[0] = v & 0xff;
+  p[1] = (v >> 8) & 0xff;
+  p[2] = (v >> 16) & 0xff;
+  p[3] = (v >> 24) & 0xff;
+  return p + 4;
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_slot_energy_serialize(uint8_t *buf, int buf_len)
+{
+  uint8_t *p = buf;
+  uint8_t c, o;
+  int len = 3 + 4 + HCK_TSCH_SLOT_ENERGY_CLASSES * TSCH_SLOT_ENERGY_OUTCOMES * 8;
+
+  if(buf == NULL || buf_len < len) {
+    return -1;
+  }
+  *p++ = 1; /* version */
+  *p++ = HCK_TSCH_SLOT_ENERGY_CLASSES;
+  *p++ = TSCH_SLOT_ENERGY_OUTCOMES;
+  p = slot_energy_write32(p, RTIMER_SECOND);
+  for(c = 0; c < HCK_TSCH_SLOT_ENERGY_CLASSES; c++) {
+    for(o = 0; o < TSCH_SLOT_ENERGY_OUTCOMES; o++) {
+      p = slot_energy_write32(p, tsch_slot_energy_count[c][o]);
+      p = slot_energy_write32(p, tsch_slot_energy_ticks[c][o]);
+    }
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+print_log_tsch_slot_energy(void)
+{
+  static uint8_t dump[3 + 4 + HCK_TSCH_SLOT_ENERGY_CLASSES * TSCH_SLOT_ENERGY_OUTCOMES * 8];
+  char hex[2 * 32 + 1];
+  int len, i, j;
+  uint8_t c;
+
+  /* One line per class in use: count and radio ticks per outcome */
+  for(c = 0; c < HCK_TSCH_SLOT_ENERGY_CLASSES; c++) {
+    uint32_t *n = tsch_slot_energy_count[c];
+    uint32_t *t = tsch_slot_energy_ticks[c];
+    if(n[TSCH_SLOT_ENERGY_RX_IDLE] + n[TSCH_SLOT_ENERGY_RX_OK] + n[TSCH_SLOT_ENERGY_RX_BAD]
+       + n[TSCH_SLOT_ENERGY_TX_OK] + n[TSCH_SLOT_ENERGY_TX_NOACK]
+       + n[TSCH_SLOT_ENERGY_TX_BUSY] + n[TSCH_SLOT_ENERGY_TX_ERR] == 0) {
+      continue;
+    }
+    LOG_HCK("se %u rxi %lu %lu rxo %lu %lu rxb %lu %lu txo %lu %lu txn %lu %lu txb %lu %lu txe %lu %lu |\n", 
+            c, 
+            n[TSCH_SLOT_ENERGY_RX_IDLE], t[TSCH_SLOT_ENERGY_RX_IDLE], 
+            n[TSCH_SLOT_ENERGY_RX_OK], t[TSCH_SLOT_ENERGY_RX_OK], 
+            n[TSCH_SLOT_ENERGY_RX_BAD], t[TSCH_SLOT_ENERGY_RX_BAD], 
+            n[TSCH_SLOT_ENERGY_TX_OK], t[TSCH_SLOT_ENERGY_TX_OK], 
+            n[TSCH_SLOT_ENERGY_TX_NOACK], t[TSCH_SLOT_ENERGY_TX_NOACK], 
+            n[TSCH_SLOT_ENERGY_TX_BUSY], t[TSCH_SLOT_ENERGY_TX_BUSY], 
+            n[TSCH_SLOT_ENERGY_TX_ERR], t[TSCH_SLOT_ENERGY_TX_ERR]);
+  }
+
+  /* Binary dump, hex-encoded, 32 bytes per line */
+  len = tsch_slot_energy_serialize(dump, sizeof(dump));
+  for(i = 0; i < len; i += 32) {
+    for(j = 0; j < 32 && i + j < len; j++) {
+      snprintf(&hex[2 * j], 3, "%02x", dump[i + j]);
+    }
+    LOG_HCK("se_bin %u %s |\n", i, hex);
+  }
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 void print_log_tsch()
 {
@@ -563,6 +672,69 @@ void print_log_tsch()
           tsch_unicast_sf_bst_rx_operation_count);
 #endif
 #endif
+
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  LOG_HCK("ctrl_merged %lu |\n", tsch_queue_ctrl_merged_count);
+#endif
+
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+  LOG_HCK("dbt_res %lu dbt_res_cells %lu dbt_res_deny %lu |\n", 
+          tsch_dbt_reservation_count, 
+          tsch_dbt_reservation_cell_count, 
+          tsch_dbt_reservation_deny_count);
+#endif
+
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  LOG_HCK("lcb_tx %lu lcb_rx %lu lcb_upd %lu lcb_rsy %lu |\n", 
+          tsch_lcb_tx_remap_count, 
+          tsch_lcb_rx_remap_count, 
+          tsch_lcb_update_count,
+          tsch_lcb_resync_count);
+#endif
+
+#if HCK_MOD_TSCH_RX_SKIP
+  LOG_HCK("rxs_skip %lu |\n", tsch_rx_skip_count);
+#endif
+
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+  LOG_HCK("aeb_rst %lu aeb_sup %lu |\n", 
+          tsch_adaptive_eb_reset_count, 
+          tsch_adaptive_eb_suppress_count);
+#endif
+
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+  LOG_HCK("req_post %lu req_full %lu |\n", 
+          tsch_request_post_count, 
+          tsch_request_full_count);
+#endif
+
+#if HCK_MOD_PROCESS_PRIORITY
+  {
+    static const char *const prio_names[PROCESS_PRIO_NUM] = { "app", "mac", "net", "log" };
+    uint8_t i;
+    for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+      LOG_HCK("prc_%s_srv %lu prc_%s_lsum %lu prc_%s_lmax %lu prc_%s_full %lu prc_%s_aged %lu |\n", 
+              prio_names[i], process_prio_stats[i].served, 
+              prio_names[i], process_prio_stats[i].latency_sum, 
+              prio_names[i], process_prio_stats[i].latency_max, 
+              prio_names[i], process_prio_stats[i].full, 
+              prio_names[i], process_prio_stats[i].aged);
+    }
+  }
+#endif
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+  LOG_HCK("scp_sel %lu scp_sel_sum %lu scp_sel_max %lu scp_dsp_sum %lu scp_dsp_max %lu |\n", 
+          tsch_shared_cell_select_count, 
+          tsch_shared_cell_select_ticks_sum, 
+          tsch_shared_cell_select_ticks_max, 
+          tsch_shared_cell_dispatch_ticks_sum, 
+          tsch_shared_cell_dispatch_ticks_max);
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+  print_log_tsch_slot_energy();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void reset_log_tsch()
@@ -618,6 +790,54 @@ void reset_log_tsch()
   tsch_dequeued_ringbuf_full_count = 0;
   tsch_dequeued_ringbuf_available_count = 0;
 
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  tsch_queue_ctrl_merged_count = 0;
+#endif
+
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+  tsch_dbt_reservation_count = 0;
+  tsch_dbt_reservation_cell_count = 0;
+  tsch_dbt_reservation_deny_count = 0;
+#endif
+
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  tsch_lcb_tx_remap_count = 0;
+  tsch_lcb_rx_remap_count = 0;
+  tsch_lcb_update_count = 0;
+  tsch_lcb_resync_count = 0;
+#endif
+
+#if HCK_MOD_TSCH_RX_SKIP
+  tsch_rx_skip_count = 0;
+#endif
+
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+  tsch_adaptive_eb_reset_count = 0;
+  tsch_adaptive_eb_suppress_count = 0;
+#endif
+
+#if HCK_MOD_TSCH_LOCKFREE_HANDOFF
+  tsch_request_post_count = 0;
+  tsch_request_full_count = 0;
+#endif
+
+#if HCK_MOD_PROCESS_PRIORITY
+  memset(process_prio_stats, 0, sizeof(process_prio_stats));
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+  memset(tsch_slot_energy_count, 0, sizeof(tsch_slot_energy_count));
+  memset(tsch_slot_energy_ticks, 0, sizeof(tsch_slot_energy_ticks));
+#endif
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+  tsch_shared_cell_select_count = 0;
+  tsch_shared_cell_select_ticks_sum = 0;
+  tsch_shared_cell_select_ticks_max = 0;
+  tsch_shared_cell_dispatch_ticks_sum = 0;
+  tsch_shared_cell_dispatch_ticks_max = 0;
+#endif
+
   /* hckim for measure cell utilization during association */
   tsch_scheduled_eb_sf_cell_count = 0;
   tsch_scheduled_common_sf_cell_count = 0;
@@ -728,6 +948,20 @@ uint8_t tsch_join_priority;
 static uint8_t tsch_packet_seqno;
 /* Current period for EB output */
 static clock_time_t tsch_current_eb_period;
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+#ifndef HCK_TSCH_ADAPTIVE_EB_IMIN
+#define HCK_TSCH_ADAPTIVE_EB_IMIN (CLOCK_SECOND)
+#endif
+#ifndef HCK_TSCH_ADAPTIVE_EB_K
+#define HCK_TSCH_ADAPTIVE_EB_K 3
+#endif
+/* Current trickle interval of EB output, doubles up to tsch_current_eb_period */
+static clock_time_t tsch_adaptive_eb_interval = HCK_TSCH_ADAPTIVE_EB_IMIN;
+/* EBs heard from neighbors in the current interval */
+static uint8_t tsch_adaptive_eb_heard;
+uint32_t tsch_adaptive_eb_reset_count;
+uint32_t tsch_adaptive_eb_suppress_count;
+#endif
 /* Current period for keepalive output */
 static clock_time_t tsch_current_ka_timeout;
 
@@ -875,9 +1109,29 @@ tsch_set_ka_timeout(uint32_t timeout)
 void
 tsch_set_eb_period(uint32_t period)
 {
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+  /* A shorter period means RPL reset its DIO trickle (e.g. on a
+   * multicast DIS from a joining node): restart EBs fast as well */
+  if(MIN(period, TSCH_MAX_EB_PERIOD) < tsch_current_eb_period) {
+    tsch_adaptive_eb_reset();
+  }
+#endif
   tsch_current_eb_period = MIN(period, TSCH_MAX_EB_PERIOD);
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+void
+tsch_adaptive_eb_reset(void)
+{
+  if(tsch_adaptive_eb_interval > HCK_TSCH_ADAPTIVE_EB_IMIN) {
+    tsch_adaptive_eb_interval = HCK_TSCH_ADAPTIVE_EB_IMIN;
+    tsch_adaptive_eb_reset_count++;
+    /* Cut the current interval short */
+    process_poll(&tsch_send_eb_process);
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
 static void
 tsch_reset(void)
 {
@@ -1164,6 +1418,16 @@ eb_input(struct input_packet *current_input)
       last_eb_nbr_jp = eb_ies.ie_join_priority;
     }
 
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+    tsch_stats_lcb_eb_input((linkaddr_t *)&frame.src_addr, &eb_ies);
+#endif
+
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+    if(tsch_adaptive_eb_heard < 0xff) {
+      tsch_adaptive_eb_heard++;
+    }
+#endif
+
 #if TSCH_AUTOSELECT_TIME_SOURCE
     if(!tsch_is_coordinator) {
       /* Maintain EB received counter for every neighbor */
@@ -1296,7 +1560,12 @@ tsch_tx_process_pending(void)
 #endif
 
     /* Put packet into packetbuf for packet_sent callback */
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+    /* The callbacks only look at attributes and addresses, skip copying the frame */
+    queuebuf_attr_to_packetbuf(p->qb);
+#else
     queuebuf_to_packetbuf(p->qb);
+#endif
     LOG_INFO("packet sent to ");
     LOG_INFO_LLADDR(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
     LOG_INFO_(", seqno %u, status %d, tx %d\n",
@@ -1785,6 +2054,55 @@ PROCESS_THREAD(tsch_process, ev, data)
   PROCESS_END();
 }
 
+/*---------------------------------------------------------------------------*/
+/* Enqueue an EB, if we may advertise and none is in queue already */
+static void
+tsch_send_eb(void)
+{
+  if(tsch_is_associated && tsch_current_eb_period > 0
+#ifdef TSCH_RPL_CHECK_DODAG_JOINED
+    /* Implementation section 6.3 of RFC 8180 */
+    && TSCH_RPL_CHECK_DODAG_JOINED()
+#endif /* TSCH_RPL_CHECK_DODAG_JOINED */
+    /* don't send when in leaf mode */
+    && !NETSTACK_ROUTING.is_in_leaf_mode()
+      ) {
+#if WITH_DRA
+    dra_my_eb_seq++;
+    dra_my_num_of_pkts++;
+#if DRA_DBG
+    LOG_HCK_DRA("dra send EB seq %u\n", dra_my_eb_seq);
+#endif
+#endif
+    /* Enqueue EB only if there isn't already one in queue */
+    if(tsch_queue_nbr_packet_count(n_eb) == 0) {
+      uint8_t hdr_len = 0;
+      uint8_t tsch_sync_ie_offset;
+      /* Prepare the EB packet and schedule it to be sent */
+      if(tsch_packet_create_eb(&hdr_len, &tsch_sync_ie_offset) > 0) {
+        struct tsch_packet *p;
+        /* Enqueue EB packet, for a single transmission only */
+        if(!(p = tsch_queue_add_packet(&tsch_eb_address, 1, NULL, NULL))) {
+          LOG_ERR("! could not enqueue EB packet\n");
+
+          ++tsch_eb_packet_qloss_count;
+          uint64_t tsch_eb_qloss_asn = tsch_calculate_current_asn();
+          LOG_HCK("eb_qloss %u | at %llx\n", tsch_eb_packet_qloss_count, tsch_eb_qloss_asn);
+        } else {
+          LOG_INFO("TSCH: enqueue EB packet %u %u\n",
+                   packetbuf_totlen(), packetbuf_hdrlen());
+
+          ++tsch_eb_packet_enqueue_count;
+          uint64_t tsch_eb_enqueue_asn = tsch_calculate_current_asn();
+          LOG_HCK("eb_enq %u | at %llx\n", tsch_eb_packet_enqueue_count, tsch_eb_enqueue_asn);
+
+          p->tsch_sync_ie_offset = tsch_sync_ie_offset;
+          p->header_len = hdr_len;
+        }
+      }
+    }
+  }
+}
 /*---------------------------------------------------------------------------*/
 /* A periodic process to send TSCH Enhanced Beacons (EB) */
 PROCESS_THREAD(tsch_send_eb_process, ev, data)
@@ -1800,58 +2118,55 @@ PROCESS_THREAD(tsch_send_eb_process, ev, data)
     etimer_reset(&eb_timer);
   }
 
+#if !HCK_MOD_TSCH_ADAPTIVE_EB
   /* Set an initial delay except for coordinator, which should send an EB asap */
   if(!tsch_is_coordinator) {
     etimer_set(&eb_timer, TSCH_EB_PERIOD ? random_rand() % TSCH_EB_PERIOD : 0);
     PROCESS_WAIT_UNTIL(etimer_expired(&eb_timer));
   }
+#endif
 
   while(1) {
-    unsigned long delay;
-
-    if(tsch_is_associated && tsch_current_eb_period > 0
-#ifdef TSCH_RPL_CHECK_DODAG_JOINED
-      /* Implementation section 6.3 of RFC 8180 */
-      && TSCH_RPL_CHECK_DODAG_JOINED()
-#endif /* TSCH_RPL_CHECK_DODAG_JOINED */
-      /* don't send when in leaf mode */
-      && !NETSTACK_ROUTING.is_in_leaf_mode()
-        ) {
-#if WITH_DRA
-      dra_my_eb_seq++;
-      dra_my_num_of_pkts++;
-#if DRA_DBG
-      LOG_HCK_DRA("dra send EB seq %u\n", dra_my_eb_seq);
-#endif
-#endif
-      /* Enqueue EB only if there isn't already one in queue */
-      if(tsch_queue_nbr_packet_count(n_eb) == 0) {
-        uint8_t hdr_len = 0;
-        uint8_t tsch_sync_ie_offset;
-        /* Prepare the EB packet and schedule it to be sent */
-        if(tsch_packet_create_eb(&hdr_len, &tsch_sync_ie_offset) > 0) {
-          struct tsch_packet *p;
-          /* Enqueue EB packet, for a single transmission only */
-          if(!(p = tsch_queue_add_packet(&tsch_eb_address, 1, NULL, NULL))) {
-            LOG_ERR("! could not enqueue EB packet\n");
-
-            ++tsch_eb_packet_qloss_count;
-            uint64_t tsch_eb_qloss_asn = tsch_calculate_current_asn();
-            LOG_HCK("eb_qloss %u | at %llx\n", tsch_eb_packet_qloss_count, tsch_eb_qloss_asn);
-          } else {
-            LOG_INFO("TSCH: enqueue EB packet %u %u\n",
-                     packetbuf_totlen(), packetbuf_hdrlen());
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+    static clock_time_t eb_time;
+    clock_time_t eb_imax = tsch_current_eb_period > 0 ? tsch_current_eb_period : TSCH_EB_PERIOD;
+
+    /* Trickle-style interval: EB at a random point of its second half,
+     * unless enough neighbors already advertised in it */
+    if(!tsch_is_associated) {
+      /* Advertise fast again once (re-)associated */
+      tsch_adaptive_eb_interval = HCK_TSCH_ADAPTIVE_EB_IMIN;
+    }
+    if(tsch_adaptive_eb_interval > eb_imax) {
+      tsch_adaptive_eb_interval = eb_imax;
+    }
+    tsch_adaptive_eb_heard = 0;
+    eb_time = tsch_adaptive_eb_interval / 2 + random_rand() % (tsch_adaptive_eb_interval / 2 + 1);
+    etimer_set(&eb_timer, eb_time);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL || etimer_expired(&eb_timer));
+    if(ev == PROCESS_EVENT_POLL) {
+      /* Reset by join activity: start over from the minimum interval */
+      continue;
+    }
 
-            ++tsch_eb_packet_enqueue_count;
-            uint64_t tsch_eb_enqueue_asn = tsch_calculate_current_asn();
-            LOG_HCK("eb_enq %u | at %llx\n", tsch_eb_packet_enqueue_count, tsch_eb_enqueue_asn);
+    if(tsch_adaptive_eb_heard < HCK_TSCH_ADAPTIVE_EB_K) {
+      tsch_send_eb();
+    } else {
+      tsch_adaptive_eb_suppress_count++;
+    }
 
-            p->tsch_sync_ie_offset = tsch_sync_ie_offset;
-            p->header_len = hdr_len;
-          }
-        }
-      }
+    etimer_set(&eb_timer, tsch_adaptive_eb_interval - eb_time);
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL || etimer_expired(&eb_timer));
+    if(ev == PROCESS_EVENT_POLL) {
+      continue;
     }
+
+    /* No join activity: back off exponentially, bounded at the loop start */
+    tsch_adaptive_eb_interval *= 2;
+#else /* HCK_MOD_TSCH_ADAPTIVE_EB */
+    unsigned long delay;
+
+    tsch_send_eb();
     if(tsch_current_eb_period > 0) {
       /* Next EB transmission with a random delay
        * within [tsch_current_eb_period*0.75, tsch_current_eb_period[ */
@@ -1862,6 +2177,7 @@ PROCESS_THREAD(tsch_send_eb_process, ev, data)
     }
     etimer_set(&eb_timer, delay);
     PROCESS_WAIT_UNTIL(etimer_expired(&eb_timer));
+#endif /* HCK_MOD_TSCH_ADAPTIVE_EB */
   }
   PROCESS_END();
 }
@@ -1983,6 +2299,9 @@ tsch_init(void)
 #endif
 
   tsch_stats_init();
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+  tsch_stats_lcb_init();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 /* Function send for TSCH-MAC, puts the packet in packetbuf in the MAC queue */
@@ -2191,6 +2510,10 @@ turn_on(void)
   if(tsch_is_initialized == 1 && tsch_is_started == 0) {
     tsch_is_started = 1;
     /* Process tx/rx callback and log messages whenever polled */
+#if HCK_MOD_PROCESS_PRIORITY
+    /* Drain the input and dequeued rings ahead of any other process */
+    process_set_priority(&tsch_pending_events_process, PROCESS_PRIO_MAC);
+#endif
     process_start(&tsch_pending_events_process, NULL);
     if(TSCH_EB_PERIOD > 0) {
       /* periodically send TSCH EBs */
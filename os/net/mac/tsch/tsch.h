@@ -113,6 +113,71 @@ extern uint16_t tsch_input_ringbuf_available_count;
 extern uint16_t tsch_dequeued_ringbuf_full_count;
 extern uint16_t tsch_dequeued_ringbuf_available_count;
 
+#if TSCH_DBT_MULTI_CELL_RESERVATION
+extern uint32_t tsch_dbt_reservation_count;
+extern uint32_t tsch_dbt_reservation_cell_count;
+extern uint32_t tsch_dbt_reservation_deny_count;
+#endif
+
+#if HCK_MOD_TSCH_LINK_CHANNEL_BLACKLIST
+extern uint32_t tsch_lcb_tx_remap_count;
+extern uint32_t tsch_lcb_rx_remap_count;
+extern uint32_t tsch_lcb_update_count;
+extern uint32_t tsch_lcb_resync_count;
+#endif
+
+#if HCK_MOD_TSCH_RX_SKIP
+extern uint32_t tsch_rx_skip_count;
+#endif
+
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+extern uint32_t tsch_adaptive_eb_reset_count;
+extern uint32_t tsch_adaptive_eb_suppress_count;
+#endif
+
+#if HCK_LOG_TSCH_SLOT_ENERGY
+/* Cells and energest radio time (rtimer ticks) per slotframe and outcome.
+ * Handles above HCK_TSCH_SLOT_ENERGY_MAX_HANDLE (e.g. OST) are summed up
+ * in CLASS_OTHER, DBT burst slots in CLASS_BURST whatever their handle. */
+#ifndef HCK_TSCH_SLOT_ENERGY_MAX_HANDLE
+#define HCK_TSCH_SLOT_ENERGY_MAX_HANDLE   3
+#endif
+#define HCK_TSCH_SLOT_ENERGY_CLASS_OTHER  (HCK_TSCH_SLOT_ENERGY_MAX_HANDLE + 1)
+#define HCK_TSCH_SLOT_ENERGY_CLASS_BURST  (HCK_TSCH_SLOT_ENERGY_MAX_HANDLE + 2)
+#define HCK_TSCH_SLOT_ENERGY_CLASSES      (HCK_TSCH_SLOT_ENERGY_MAX_HANDLE + 3)
+
+enum tsch_slot_energy_outcome {
+  TSCH_SLOT_ENERGY_RX_IDLE,   /* nothing on air */
+  TSCH_SLOT_ENERGY_RX_OK,     /* frame accepted */
+  TSCH_SLOT_ENERGY_RX_BAD,    /* frame seen but not accepted */
+  TSCH_SLOT_ENERGY_TX_OK,
+  TSCH_SLOT_ENERGY_TX_NOACK,
+  TSCH_SLOT_ENERGY_TX_BUSY,   /* CCA busy */
+  TSCH_SLOT_ENERGY_TX_ERR,
+  TSCH_SLOT_ENERGY_OUTCOMES,
+};
+
+extern uint32_t tsch_slot_energy_count[HCK_TSCH_SLOT_ENERGY_CLASSES][TSCH_SLOT_ENERGY_OUTCOMES];
+extern uint32_t tsch_slot_energy_ticks[HCK_TSCH_SLOT_ENERGY_CLASSES][TSCH_SLOT_ENERGY_OUTCOMES];
+
+/* Compact little-endian dump of the counters: version, number of classes,
+ * number of outcomes, RTIMER_SECOND (32 bits), then a (count, ticks) pair
+ * of 32 bits each per class and outcome. Returns the length, -1 if buf is
+ * too small. */
+int tsch_slot_energy_serialize(uint8_t *buf, int buf_len);
+#endif
+
+#if HCK_LOG_TSCH_SHARED_CELL_SELECT_TIMING
+/* Shared-cell policy packet selection time, and the part of it spent
+ * dispatching through the policy pointer, in rtimer ticks (or in units of
+ * HCK_TSCH_SHARED_CELL_SELECT_TIMING_CONF_NOW() if defined) */
+extern uint32_t tsch_shared_cell_select_count;
+extern uint32_t tsch_shared_cell_select_ticks_sum;
+extern uint32_t tsch_shared_cell_select_ticks_max;
+extern uint32_t tsch_shared_cell_dispatch_ticks_sum;
+extern uint32_t tsch_shared_cell_dispatch_ticks_max;
+#endif
+
 /* hckim measure cell utilization during association */
 extern uint32_t tsch_scheduled_eb_sf_cell_count;
 extern uint32_t tsch_scheduled_common_sf_cell_count;
@@ -334,6 +399,14 @@ void tsch_set_join_priority(uint8_t jp);
  * \param period The period in Clock ticks.
  */
 void tsch_set_eb_period(uint32_t period);
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+/**
+ * Restart EB output from the minimum trickle interval, on join activity
+ * in the neighborhood. Called when RPL shortens the EB period, i.e. when
+ * its DIO trickle was reset (multicast DIS, inconsistency).
+ */
+void tsch_adaptive_eb_reset(void);
+#endif
 /**
  * Set the desynchronization timeout after which a node sends a unicasst
  * keep-alive (KA) to its time source. Set to 0 to stop sending KAs. The
@@ -73,14 +73,56 @@ struct queuebuf {
 
 /* The actual queuebuf data */
 struct queuebuf_data {
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+  /* Data last, so that a small slab shares the layout of the header fields */
+  uint16_t len;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t data[PACKETBUF_SIZE];
+#else
   uint8_t data[PACKETBUF_SIZE];
   uint16_t len;
   struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+#endif
 };
 
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
+
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+#if WITH_SWAP
+#error "HCK_MOD_QUEUEBUF_SLAB_POOL cannot be used with queuebuf swapping"
+#endif
+/* Queuebuf handles (QUEUEBUF_NUM) are decoupled from the data slabs: short
+   frames (EB, keepalive, most RPL control) take a small slab, only longer
+   frames take a full PACKETBUF_SIZE slab. */
+#ifndef HCK_QUEUEBUF_SMALL_SLAB_SIZE
+#define HCK_QUEUEBUF_SMALL_SLAB_SIZE 64
+#endif
+#ifndef HCK_QUEUEBUF_SMALL_SLAB_NUM
+#define HCK_QUEUEBUF_SMALL_SLAB_NUM QUEUEBUF_NUM
+#endif
+#ifndef HCK_QUEUEBUF_FULL_SLAB_NUM
+#define HCK_QUEUEBUF_FULL_SLAB_NUM QUEUEBUFRAM_NUM
+#endif
+/* TSCH appends the MIC of an authenticated-only frame in place, after the
+   frame held in the queuebuf */
+#if LLSEC802154_ENABLED
+#define QUEUEBUF_SMALL_SLAB_TAIL LLSEC802154_MIC_LEN(7)
+#else
+#define QUEUEBUF_SMALL_SLAB_TAIL 0
+#endif
+struct queuebuf_data_small {
+  uint16_t len;
+  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
+  uint8_t data[HCK_QUEUEBUF_SMALL_SLAB_SIZE + QUEUEBUF_SMALL_SLAB_TAIL];
+};
+MEMB(buframmem, struct queuebuf_data, HCK_QUEUEBUF_FULL_SLAB_NUM);
+MEMB(bufsmallmem, struct queuebuf_data_small, HCK_QUEUEBUF_SMALL_SLAB_NUM);
+#else
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
+#endif
 
 #if WITH_SWAP
 
@@ -135,6 +177,39 @@ LIST(queuebuf_list);
 uint8_t queuebuf_len, queuebuf_max_len;
 #endif /* QUEUEBUF_STATS */
 
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+/*---------------------------------------------------------------------------*/
+/* Allocate the smallest slab that holds len bytes */
+static struct queuebuf_data *
+queuebuf_slab_alloc(uint16_t len)
+{
+  struct queuebuf_data *ptr = NULL;
+  if(len <= HCK_QUEUEBUF_SMALL_SLAB_SIZE) {
+    ptr = (struct queuebuf_data *)memb_alloc(&bufsmallmem);
+  }
+  if(ptr == NULL) {
+    ptr = memb_alloc(&buframmem);
+  }
+  return ptr;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+queuebuf_slab_capacity(struct queuebuf_data *ptr)
+{
+  return memb_inmemb(&bufsmallmem, ptr) ? HCK_QUEUEBUF_SMALL_SLAB_SIZE : PACKETBUF_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static void
+queuebuf_slab_free(struct queuebuf_data *ptr)
+{
+  if(memb_inmemb(&bufsmallmem, ptr)) {
+    memb_free(&bufsmallmem, ptr);
+  } else {
+    memb_free(&buframmem, ptr);
+  }
+}
+#endif /* HCK_MOD_QUEUEBUF_SLAB_POOL */
+
 #if WITH_SWAP
 /*---------------------------------------------------------------------------*/
 static void
@@ -288,6 +363,9 @@ queuebuf_init(void)
   }
 #endif
   memb_init(&buframmem);
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+  memb_init(&bufsmallmem);
+#endif
   memb_init(&bufmem);
 #if QUEUEBUF_STATS
   queuebuf_max_len = 0;
@@ -319,7 +397,11 @@ queuebuf_new_from_packetbuf(void)
     buf->line = line;
     buf->time = clock_time();
 #endif /* QUEUEBUF_DEBUG */
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+    buf->ram_ptr = queuebuf_slab_alloc(packetbuf_totlen());
+#else
     buf->ram_ptr = memb_alloc(&buframmem);
+#endif
 #if WITH_SWAP
     /* If the allocation failed, store the qbuf in swap files */
     if(buf->ram_ptr != NULL) {
@@ -379,10 +461,22 @@ queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 #endif
 }
 /*---------------------------------------------------------------------------*/
-void
+int
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+  if(packetbuf_totlen() > queuebuf_slab_capacity(buframptr)) {
+    /* The packet grew out of its small slab: move it to a full one */
+    struct queuebuf_data *full = memb_alloc(&buframmem);
+    if(full == NULL) {
+      PRINTF("queuebuf_update_from_packetbuf: could not grow queuebuf data\n");
+      return 0;
+    }
+    queuebuf_slab_free(buframptr);
+    buf->ram_ptr = buframptr = full;
+  }
+#endif
   packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
   buframptr->len = packetbuf_copyto(buframptr->data);
 #if WITH_SWAP
@@ -390,6 +484,7 @@ queuebuf_update_from_packetbuf(struct queuebuf *buf)
     queuebuf_flush_tmpdata();
   }
 #endif
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -402,6 +497,8 @@ queuebuf_free(struct queuebuf *buf)
     } else {
       queuebuf_remove_from_file(buf->swap_id);
     }
+#elif HCK_MOD_QUEUEBUF_SLAB_POOL
+    queuebuf_slab_free(buf->ram_ptr);
 #else
     memb_free(&buframmem, buf->ram_ptr);
 #endif
@@ -426,6 +523,20 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+/* Restore only the attributes and addresses of a queuebuf into packetbuf,
+   for consumers such as packet_sent callbacks that do not read the frame. */
+void
+queuebuf_attr_to_packetbuf(struct queuebuf *b)
+{
+  if(memb_inmemb(&bufmem, b)) {
+    struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
+    packetbuf_clear();
+    packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+  }
+}
+#endif
+/*---------------------------------------------------------------------------*/
 void *
 queuebuf_dataptr(struct queuebuf *b)
 {
@@ -102,9 +102,16 @@ struct queuebuf *queuebuf_new_from_packetbuf_debug(const char *file, int line);
 struct queuebuf *queuebuf_new_from_packetbuf(void);
 #endif /* QUEUEBUF_DEBUG */
 void queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
-void queuebuf_update_from_packetbuf(struct queuebuf *b);
+/* Returns 0 if the queuebuf could not hold the packetbuf, and was left
+   unchanged. With HCK_MOD_QUEUEBUF_SLAB_POOL this happens when a frame
+   outgrows its small slab and no full slab is free, so callers must
+   check the result and keep or drop the old frame themselves. */
+int queuebuf_update_from_packetbuf(struct queuebuf *b);
 
 void queuebuf_to_packetbuf(struct queuebuf *b);
+#if HCK_MOD_QUEUEBUF_SLAB_POOL
+void queuebuf_attr_to_packetbuf(struct queuebuf *b);
+#endif
 void queuebuf_free(struct queuebuf *b);
 
 void *queuebuf_dataptr(struct queuebuf *b);
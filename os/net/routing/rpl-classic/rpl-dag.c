@@ -70,11 +70,28 @@
 
 static uint16_t rpl_parent_switch_count;
 static uint16_t rpl_local_repair_count;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+static uint32_t rpl_best_parent_full_scan_count;
+static uint32_t rpl_best_parent_incremental_count;
+#endif
+
+void print_log_rpl_dag()
+{
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  LOG_HCK("bp_scan %lu bp_incr %lu |\n",
+        rpl_best_parent_full_scan_count,
+        rpl_best_parent_incremental_count);
+#endif
+}
 
 void reset_log_rpl_dag()
 {
   rpl_parent_switch_count = 0;
   rpl_local_repair_count = 0;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  rpl_best_parent_full_scan_count = 0;
+  rpl_best_parent_incremental_count = 0;
+#endif
 }
 
 /* A configurable function called after every RPL parent switch */
@@ -82,6 +99,10 @@ void reset_log_rpl_dag()
 void RPL_CALLBACK_PARENT_SWITCH(rpl_parent_t *old, rpl_parent_t *new);
 #endif /* RPL_CALLBACK_PARENT_SWITCH */
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+static rpl_parent_t *select_parent(rpl_dag_t *dag, rpl_parent_t *changed);
+static void parent_leaves_dag(rpl_parent_t *p);
+#endif
 /*---------------------------------------------------------------------------*/
 extern rpl_of_t rpl_of0, rpl_mrhof;
 static rpl_of_t * const objective_functions[] = RPL_SUPPORTED_OFS;
@@ -252,6 +273,10 @@ static void
 rpl_set_preferred_parent(rpl_dag_t *dag, rpl_parent_t *p)
 {
   if(dag != NULL && dag->preferred_parent != p) {
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    /* The OF hysteresis is relative to the preferred parent */
+    dag->best_parent_valid = 0;
+#endif
     LOG_INFO("rpl_set_preferred_parent ");
     if(p != NULL) {
       LOG_INFO_6ADDR(rpl_parent_get_ipaddr(p));
@@ -737,7 +762,11 @@ rpl_free_instance(rpl_instance_t *instance)
 #if RPL_WITH_PROBING
   ctimer_stop(&instance->probing_timer);
 #endif /* RPL_WITH_PROBING */
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+  trickle_sched_stop(&instance->dio_timer);
+#else
   ctimer_stop(&instance->dio_timer);
+#endif
   ctimer_stop(&instance->dao_timer);
   ctimer_stop(&instance->dao_lifetime_timer);
 
@@ -804,6 +833,9 @@ rpl_add_parent(rpl_dag_t *dag, rpl_dio_t *dio, uip_ipaddr_t *addr)
 #if RPL_WITH_MC
       memcpy(&p->mc, &dio->mc, sizeof(p->mc));
 #endif /* RPL_WITH_MC */
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+      rpl_parent_cost_changed(p);
+#endif
     }
   }
 
@@ -862,7 +894,11 @@ rpl_select_dag(rpl_instance_t *instance, rpl_parent_t *p)
   last_parent = instance->current_dag->preferred_parent;
 
   if(instance->current_dag->rank != ROOT_RANK(instance)) {
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    select_parent(p->dag, p);
+#else
     rpl_select_parent(p->dag);
+#endif
   }
 
   best_dag = NULL;
@@ -948,6 +984,35 @@ rpl_select_dag(rpl_instance_t *instance, rpl_parent_t *p)
   return best_dag;
 }
 /*---------------------------------------------------------------------------*/
+static int
+parent_is_candidate(rpl_dag_t *dag, rpl_parent_t *p, int fresh_only)
+{
+  /* Exclude parents from other DAGs or announcing an infinite rank */
+  if(p->dag != dag || p->rank == RPL_INFINITE_RANK || p->rank < ROOT_RANK(dag->instance)) {
+    if(p->rank < ROOT_RANK(dag->instance)) {
+      LOG_WARN("Parent has invalid rank\n");
+    }
+    return 0;
+  }
+
+  if(fresh_only && !rpl_parent_is_fresh(p)) {
+    /* Filter out non-fresh parents if fresh_only is set */
+    return 0;
+  }
+
+#if UIP_ND6_SEND_NS
+  {
+  uip_ds6_nbr_t *nbr = rpl_get_nbr(p);
+  /* Exclude links to a neighbor that is not reachable at a NUD level */
+  if(nbr == NULL || nbr->state != NBR_REACHABLE) {
+    return 0;
+  }
+  }
+#endif /* UIP_ND6_SEND_NS */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
 static rpl_parent_t *
 best_parent(rpl_dag_t *dag, int fresh_only)
 {
@@ -962,42 +1027,133 @@ best_parent(rpl_dag_t *dag, int fresh_only)
   of = dag->instance->of;
   /* Search for the best parent according to the OF */
   for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
-
-    /* Exclude parents from other DAGs or announcing an infinite rank */
-    if(p->dag != dag || p->rank == RPL_INFINITE_RANK || p->rank < ROOT_RANK(dag->instance)) {
-      if(p->rank < ROOT_RANK(dag->instance)) {
-        LOG_WARN("Parent has invalid rank\n");
-      }
-      continue;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    if(!fresh_only && p->dag == dag) {
+      /* This scan compares every parent of the DAG */
+      p->flags &= ~RPL_PARENT_FLAG_COST_PENDING;
     }
+#endif
 
-    if(fresh_only && !rpl_parent_is_fresh(p)) {
-      /* Filter out non-fresh parents if fresh_only is set */
+    if(!parent_is_candidate(dag, p, fresh_only)) {
       continue;
     }
 
-#if UIP_ND6_SEND_NS
-    {
-    uip_ds6_nbr_t *nbr = rpl_get_nbr(p);
-    /* Exclude links to a neighbor that is not reachable at a NUD level */
-    if(nbr == NULL || nbr->state != NBR_REACHABLE) {
-      continue;
-    }
-    }
-#endif /* UIP_ND6_SEND_NS */
-
     /* Now we have an acceptable parent, check if it is the new best */
     best = of->best_parent(best, p);
   }
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  if(!fresh_only) {
+    rpl_best_parent_full_scan_count++;
+    dag->best_parent = best;
+    dag->best_parent_rank = rpl_rank_via_parent(best);
+    dag->best_parent_valid = 1;
+    dag->best_parent_pending = 0;
+    dag->best_parent_link_stats_generation = link_stats_generation;
+  }
+#endif
+
   return best;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+/* Called whenever the rank advertised by p or the link metric towards p
+ * may have changed. A parent other than the cached best one is folded
+ * into the cached result the next time it goes through rpl_select_dag();
+ * the cached best one is re-checked against its rank at selection time. */
+void
+rpl_parent_cost_changed(rpl_parent_t *p)
+{
+  rpl_dag_t *dag;
+
+  if(p == NULL) {
+    return;
+  }
+  p->flags &= ~RPL_PARENT_FLAG_LINK_METRIC_VALID;
+
+  dag = p->dag;
+  if(dag == NULL || p == dag->best_parent) {
+    return;
+  }
+  if(!(p->flags & RPL_PARENT_FLAG_COST_PENDING)) {
+    p->flags |= RPL_PARENT_FLAG_COST_PENDING;
+    dag->best_parent_pending++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+parent_leaves_dag(rpl_parent_t *p)
+{
+  rpl_dag_t *dag = p->dag;
+  if(dag != NULL &&
+     (p == dag->best_parent || (p->flags & RPL_PARENT_FLAG_COST_PENDING))) {
+    dag->best_parent_valid = 0;
+  }
+  p->flags &= ~RPL_PARENT_FLAG_COST_PENDING;
+}
+/*---------------------------------------------------------------------------*/
+/* Best parent of the DAG given that only 'changed' may differ from the
+ * last selection. Falls back to a full scan if the cache is invalid or
+ * other parents changed in the meantime. */
+static rpl_parent_t *
+best_parent_incremental(rpl_dag_t *dag, rpl_parent_t *changed)
+{
+  if(dag == NULL || dag->instance == NULL || dag->instance->of == NULL) {
+    return NULL;
+  }
+
+  /* A link-stats entry was created or removed since the last full scan:
+   * the metric of any parent may have been reset */
+  if(!dag->best_parent_valid
+     || dag->best_parent_link_stats_generation != link_stats_generation) {
+    return best_parent(dag, 0);
+  }
+
+  if(dag->best_parent != NULL) {
+    /* If the best parent got worse, another one may now win */
+    rpl_rank_t rank = rpl_rank_via_parent(dag->best_parent);
+    if(rank > dag->best_parent_rank || !parent_is_candidate(dag, dag->best_parent, 0)) {
+      return best_parent(dag, 0);
+    }
+    dag->best_parent_rank = rank;
+  }
+
+  if(changed != NULL && changed->dag == dag
+     && (changed->flags & RPL_PARENT_FLAG_COST_PENDING)) {
+    changed->flags &= ~RPL_PARENT_FLAG_COST_PENDING;
+    dag->best_parent_pending--;
+    if(dag->best_parent_pending == 0) {
+      rpl_best_parent_incremental_count++;
+      if(parent_is_candidate(dag, changed, 0)) {
+        dag->best_parent = dag->instance->of->best_parent(dag->best_parent, changed);
+        dag->best_parent_rank = rpl_rank_via_parent(dag->best_parent);
+      }
+      return dag->best_parent;
+    }
+  }
+
+  if(dag->best_parent_pending > 0) {
+    return best_parent(dag, 0);
+  }
+
+  rpl_best_parent_incremental_count++;
+  return dag->best_parent;
+}
+#endif /* HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION */
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+static rpl_parent_t *
+select_parent(rpl_dag_t *dag, rpl_parent_t *changed)
+{
+  /* Look for best parent (regardless of freshness) */
+  rpl_parent_t *best = best_parent_incremental(dag, changed);
+#else
 rpl_parent_t *
 rpl_select_parent(rpl_dag_t *dag)
 {
   /* Look for best parent (regardless of freshness) */
   rpl_parent_t *best = best_parent(dag, 0);
+#endif
 
   if(best != NULL) {
 #if RPL_WITH_PROBING
@@ -1027,9 +1183,28 @@ rpl_select_parent(rpl_dag_t *dag)
     rpl_set_preferred_parent(dag, NULL);
   }
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  /* Changing the preferred parent cleared the cache; the parent just
+   * selected stays best under its own hysteresis */
+  if(dag != NULL && !dag->best_parent_valid && dag->best_parent_pending == 0
+     && dag->preferred_parent == best) {
+    dag->best_parent = best;
+    dag->best_parent_rank = rpl_rank_via_parent(best);
+    dag->best_parent_valid = 1;
+  }
+#endif
+
   dag->rank = rpl_rank_via_parent(dag->preferred_parent);
   return dag->preferred_parent;
 }
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+/*---------------------------------------------------------------------------*/
+rpl_parent_t *
+rpl_select_parent(rpl_dag_t *dag)
+{
+  return select_parent(dag, NULL);
+}
+#endif
 /*---------------------------------------------------------------------------*/
 void
 rpl_remove_parent(rpl_parent_t *parent)
@@ -1040,6 +1215,10 @@ rpl_remove_parent(rpl_parent_t *parent)
 
   rpl_nullify_parent(parent);
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  parent_leaves_dag(parent);
+#endif
+
   nbr_table_remove(rpl_parents, parent);
 }
 /*---------------------------------------------------------------------------*/
@@ -1106,7 +1285,13 @@ rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *parent)
   LOG_INFO_6ADDR(rpl_parent_get_ipaddr(parent));
   LOG_INFO_("\n");
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  parent_leaves_dag(parent);
+#endif
   parent->dag = dag_dst;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  rpl_parent_cost_changed(parent);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 static rpl_dag_t *
@@ -1350,6 +1535,9 @@ rpl_add_dag(uip_ipaddr_t *from, rpl_dio_t *dio)
 #if WITH_TRGB
   p->trgb_rpl_grandP_id = dio->trgb_rpl_grandP_id;
 #endif
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  rpl_parent_cost_changed(p);
+#endif
 
   /* Determine the objective function by using the
      objective code point of the DIO. */
@@ -1457,6 +1645,18 @@ rpl_local_repair(rpl_instance_t *instance)
     }
   }
 
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  {
+    /* Link statistics are typically reset along with a local repair */
+    rpl_parent_t *p;
+    for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
+      if(p->dag != NULL && p->dag->instance == instance) {
+        rpl_parent_cost_changed(p);
+      }
+    }
+  }
+#endif
+
   /* no downward route anymore */
   instance->has_downward_route = 0;
 #if RPL_WITH_DAO_ACK
@@ -1743,6 +1943,9 @@ rpl_process_dio(uip_ipaddr_t *from, rpl_dio_t *dio)
 
   /* Parent info has been updated, trigger rank recalculation */
   p->flags |= RPL_PARENT_FLAG_UPDATED;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  rpl_parent_cost_changed(p);
+#endif
 
   LOG_INFO("preferred DAG ");
   LOG_INFO_6ADDR(&instance->current_dag->dag_id);
@@ -130,6 +130,9 @@ rpl_ext_header_hbh_update(uint8_t *ext_buf, int opt_offset)
     /* A rank error was signalled, attempt to repair it by updating
      * the sender's rank from ext header */
     sender->rank = sender_rank;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    rpl_parent_cost_changed(sender);
+#endif
     if(RPL_IS_NON_STORING(instance)) {
       /* Select DAG and preferred parent only in non-storing mode. In storing mode,
        * a parent switch would result in an immediate No-path DAO transmission, dropping
@@ -89,6 +89,15 @@ static uint16_t rpl_dao_path_fwd_count;
 static uint16_t rpl_dao_nopath_fwd_count;
 static uint16_t rpl_dao_ack_recv_count;
 static uint16_t rpl_dao_ack_send_count;
+#if HCK_MOD_RPL_DAO_AGGREGATION
+#ifndef HCK_RPL_DAO_AGGREGATION_MAX_TARGETS
+#define HCK_RPL_DAO_AGGREGATION_MAX_TARGETS                 3
+#endif
+#ifndef HCK_RPL_DAO_AGGREGATION_WINDOW
+#define HCK_RPL_DAO_AGGREGATION_WINDOW                      CLOCK_SECOND
+#endif
+static uint16_t rpl_dao_agg_send_count;
+#endif
 
 void reset_log_rpl_icmp6()
 {
@@ -104,6 +113,9 @@ void reset_log_rpl_icmp6()
   rpl_dao_nopath_fwd_count = 0;
   rpl_dao_ack_recv_count = 0;
   rpl_dao_ack_send_count = 0;
+#if HCK_MOD_RPL_DAO_AGGREGATION
+  rpl_dao_agg_send_count = 0;
+#endif
 }
 
 /*---------------------------------------------------------------------------*/
@@ -146,7 +158,7 @@ UIP_ICMP6_HANDLER(dao_no_path_handler, ICMP6_RPL, RPL_CODE_NO_PATH_DAO, dao_inpu
 UIP_ICMP6_HANDLER(dao_ack_handler, ICMP6_RPL, RPL_CODE_DAO_ACK, dao_ack_input);
 /*---------------------------------------------------------------------------*/
 
-#if RPL_WITH_DAO_ACK
+#if RPL_WITH_DAO_ACK && !HCK_MOD_RPL_DAO_AGGREGATION
 static uip_ds6_route_t *
 find_route_entry_by_dao_ack(uint8_t seq)
 {
@@ -161,7 +173,7 @@ find_route_entry_by_dao_ack(uint8_t seq)
   }
   return NULL;
 }
-#endif /* RPL_WITH_DAO_ACK */
+#endif /* RPL_WITH_DAO_ACK && !HCK_MOD_RPL_DAO_AGGREGATION */
 
 #if RPL_WITH_STORING
 /* prepare for forwarding of DAO */
@@ -179,6 +191,176 @@ prepare_for_dao_fwd(uint8_t sequence, uip_ds6_route_t *rep)
 }
 #endif /* RPL_WITH_STORING */
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING && HCK_MOD_RPL_DAO_AGGREGATION
+/* Child targets waiting to be forwarded to the preferred parent in one DAO */
+struct dao_aggregation_entry {
+  uip_ipaddr_t prefix;
+  uint8_t prefixlen;
+  uint8_t seqno_in;
+};
+static struct dao_aggregation_entry dao_agg_entries[HCK_RPL_DAO_AGGREGATION_MAX_TARGETS];
+static uint8_t dao_agg_num_entries;
+static uint8_t dao_agg_lifetime;
+static uint8_t dao_agg_k_flag;
+static rpl_instance_t *dao_agg_instance;
+static struct ctimer dao_agg_timer;
+/*---------------------------------------------------------------------------*/
+/* Forward all batched targets in a single DAO. The DAO gets one outgoing
+ * sequence number; every route it covers records it as dao_seqno_out so
+ * that the DAO ACK can be forwarded to each child in dao_ack_input(). If
+ * every target is a child's retransmission of a DAO still pending under
+ * the same outgoing sequence number, that number is reused as in the
+ * single-target path, so an ACK for the earlier copy still matches. */
+static void
+dao_aggregation_flush(void *ptr)
+{
+  rpl_instance_t *instance = dao_agg_instance;
+  rpl_parent_t *parent;
+  uip_ipaddr_t *parent_ipaddr;
+  uip_ds6_route_t *rep;
+  unsigned char *buffer;
+  uint8_t num_entries = dao_agg_num_entries;
+  uint8_t num_targets = 0;
+  uint8_t out_seq = 0;
+  int is_retransmission = 1;
+  int pos;
+  int i;
+
+  ctimer_stop(&dao_agg_timer);
+  dao_agg_num_entries = 0;
+
+  if(num_entries == 0 || instance == NULL || instance->current_dag == NULL) {
+    return;
+  }
+  parent = instance->current_dag->preferred_parent;
+  parent_ipaddr = parent != NULL ? rpl_parent_get_ipaddr(parent) : NULL;
+  if(parent_ipaddr == NULL) {
+    LOG_WARN("No parent to forward %u aggregated DAO targets to\n", num_entries);
+    return;
+  }
+
+  for(i = 0; i < num_entries; i++) {
+    struct dao_aggregation_entry *e = &dao_agg_entries[i];
+    rep = uip_ds6_route_lookup(&e->prefix);
+    if(rep == NULL || RPL_ROUTE_IS_NOPATH_RECEIVED(rep)) {
+      continue;
+    }
+    if(!RPL_ROUTE_IS_DAO_PENDING(rep) || rep->state.dao_seqno_in != e->seqno_in
+       || (num_targets > 0 && rep->state.dao_seqno_out != out_seq)) {
+      is_retransmission = 0;
+    }
+    out_seq = rep->state.dao_seqno_out;
+    num_targets++;
+  }
+  if(num_targets == 0) {
+    /* Every route went away within the aggregation window */
+    return;
+  }
+  if(!is_retransmission) {
+    RPL_LOLLIPOP_INCREMENT(dao_sequence);
+    out_seq = dao_sequence;
+  }
+  num_targets = 0;
+
+  buffer = UIP_ICMP_PAYLOAD;
+  pos = 0;
+
+  buffer[pos++] = instance->instance_id;
+  buffer[pos] = dao_agg_k_flag;
+#if RPL_DAO_SPECIFY_DAG
+  buffer[pos] |= RPL_DAO_D_FLAG;
+#endif /* RPL_DAO_SPECIFY_DAG */
+  ++pos;
+  buffer[pos++] = 0; /* reserved */
+  buffer[pos++] = out_seq;
+#if RPL_DAO_SPECIFY_DAG
+  memcpy(buffer + pos, &instance->current_dag->dag_id, sizeof(instance->current_dag->dag_id));
+  pos += sizeof(instance->current_dag->dag_id);
+#endif /* RPL_DAO_SPECIFY_DAG */
+
+  for(i = 0; i < num_entries; i++) {
+    struct dao_aggregation_entry *e = &dao_agg_entries[i];
+    rep = uip_ds6_route_lookup(&e->prefix);
+    if(rep == NULL || RPL_ROUTE_IS_NOPATH_RECEIVED(rep)) {
+      /* The route went away within the aggregation window */
+      continue;
+    }
+    rep->state.dao_seqno_in = e->seqno_in;
+    rep->state.dao_seqno_out = out_seq;
+    RPL_ROUTE_SET_DAO_PENDING(rep);
+
+    buffer[pos++] = RPL_OPTION_TARGET;
+    buffer[pos++] = 2 + ((e->prefixlen + 7) / CHAR_BIT);
+    buffer[pos++] = 0; /* reserved */
+    buffer[pos++] = e->prefixlen;
+    memcpy(buffer + pos, &e->prefix, (e->prefixlen + 7) / CHAR_BIT);
+    pos += ((e->prefixlen + 7) / CHAR_BIT);
+    num_targets++;
+  }
+
+  /* One transit information option covers all preceding targets */
+  buffer[pos++] = RPL_OPTION_TRANSIT;
+  buffer[pos++] = 4;
+  buffer[pos++] = 0; /* flags - ignored */
+  buffer[pos++] = 0; /* path control - ignored */
+  buffer[pos++] = 0; /* path seq - ignored */
+  buffer[pos++] = dao_agg_lifetime;
+
+  LOG_INFO("Forwarding an aggregated DAO with %u targets, out seq %u%s to ",
+           num_targets, out_seq, is_retransmission ? " (retransmission)" : "");
+  LOG_INFO_6ADDR(parent_ipaddr);
+  LOG_INFO_("\n");
+
+  ++rpl_dao_agg_send_count;
+  uint64_t rpl_dao_agg_send_asn = tsch_calculate_current_asn();
+  LOG_HCK("daoG_fwd %u tgt %u | at %llx\n", rpl_dao_agg_send_count, num_targets, rpl_dao_agg_send_asn);
+
+  uip_icmp6_send(parent_ipaddr, ICMP6_RPL, RPL_CODE_DAO, pos);
+}
+/*---------------------------------------------------------------------------*/
+/* Queue a child target for forwarding. The batch is flushed when it is full,
+ * when the window expires, or when a target with a different lifetime comes. */
+static void
+dao_aggregation_add(rpl_instance_t *instance, uip_ipaddr_t *prefix, uint8_t prefixlen,
+                    uint8_t lifetime, uint8_t flags, uint8_t seqno_in)
+{
+  struct dao_aggregation_entry *e;
+  int i;
+
+  if(dao_agg_num_entries > 0 &&
+     (instance != dao_agg_instance || lifetime != dao_agg_lifetime)) {
+    dao_aggregation_flush(NULL);
+  }
+
+  for(i = 0; i < dao_agg_num_entries; i++) {
+    e = &dao_agg_entries[i];
+    if(e->prefixlen == prefixlen && uip_ipaddr_cmp(&e->prefix, prefix)) {
+      /* Retransmission or refresh of a target already in the batch */
+      e->seqno_in = seqno_in;
+      dao_agg_k_flag |= flags & RPL_DAO_K_FLAG;
+      return;
+    }
+  }
+
+  if(dao_agg_num_entries == 0) {
+    dao_agg_instance = instance;
+    dao_agg_lifetime = lifetime;
+    dao_agg_k_flag = 0;
+    ctimer_set(&dao_agg_timer, HCK_RPL_DAO_AGGREGATION_WINDOW,
+               dao_aggregation_flush, NULL);
+  }
+  e = &dao_agg_entries[dao_agg_num_entries++];
+  uip_ipaddr_copy(&e->prefix, prefix);
+  e->prefixlen = prefixlen;
+  e->seqno_in = seqno_in;
+  dao_agg_k_flag |= flags & RPL_DAO_K_FLAG;
+
+  if(dao_agg_num_entries == HCK_RPL_DAO_AGGREGATION_MAX_TARGETS) {
+    dao_aggregation_flush(NULL);
+  }
+}
+#endif /* RPL_WITH_STORING && HCK_MOD_RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 static int
 get_global_addr(uip_ipaddr_t *addr)
 {
@@ -269,6 +451,13 @@ dis_input(void)
   ++rpl_dis_recv_count;
   LOG_HCK("dis_recv %u |\n", rpl_dis_recv_count);
 
+#if HCK_MOD_TSCH_ADAPTIVE_EB
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr)) {
+    /* A neighbor is joining: it may have neighbors still scanning for EBs */
+    tsch_adaptive_eb_reset();
+  }
+#endif
+
   for(instance = &instance_table[0], end = instance + RPL_MAX_INSTANCES;
       instance < end; ++instance) {
     if(instance->used == 1) {
@@ -738,6 +927,89 @@ dio_output(rpl_instance_t *instance, uip_ipaddr_t *uc_addr)
 #endif /* RPL_LEAF_ONLY */
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_STORING && HCK_MOD_RPL_DAO_AGGREGATION
+/* Handle a DAO carrying several targets from an aggregating child. Routes are
+ * installed per target, the DAO is acknowledged once as a whole. */
+static void
+dao_input_storing_aggregated(rpl_instance_t *instance, uip_ipaddr_t *dao_sender_addr,
+                             uint8_t flags, uint8_t sequence, uint8_t lifetime,
+                             uip_ipaddr_t *targets, uint8_t *target_lens,
+                             uint8_t num_targets)
+{
+  rpl_dag_t *dag = instance->current_dag;
+  int is_root = (dag->rank == ROOT_RANK(instance));
+  int all_installed = 1;
+  uip_ds6_route_t *rep;
+  int i;
+
+  LOG_INFO("Aggregated DAO with %u targets, lifetime %u\n", num_targets, lifetime);
+
+  if(lifetime == RPL_ZERO_LIFETIME || num_targets > HCK_RPL_DAO_AGGREGATION_MAX_TARGETS) {
+    /* Only path DAOs are aggregated, and never beyond what we can batch ourselves */
+    LOG_WARN("Dropping unsupported aggregated DAO\n");
+    if(flags & RPL_DAO_K_FLAG) {
+      uipbuf_clear();
+      dao_ack_output(instance, dao_sender_addr, sequence, RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+    }
+    return;
+  }
+
+#if WITH_OST
+  uip_ds6_nbr_t *sender_nbr = uip_ds6_nbr_lookup(dao_sender_addr);
+  if(sender_nbr != NULL) {
+    if(sender_nbr->ost_rx_no_path == 1) {
+      sender_nbr->ost_rx_no_path = 0;
+    }
+  }
+#endif
+
+  if(rpl_icmp6_update_nbr_table(dao_sender_addr, NBR_TABLE_REASON_RPL_DAO, instance) == NULL) {
+    LOG_ERR("Out of Memory, dropping aggregated DAO from ");
+    LOG_ERR_6ADDR(dao_sender_addr);
+    LOG_ERR_("\n");
+    if(flags & RPL_DAO_K_FLAG) {
+      dao_ack_output(instance, dao_sender_addr, sequence,
+                     is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+                     RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+    }
+    return;
+  }
+
+  for(i = 0; i < num_targets; i++) {
+    rep = rpl_add_route(dag, &targets[i], target_lens[i], dao_sender_addr);
+    if(rep == NULL) {
+      RPL_STAT(rpl_stats.mem_overflows++);
+      LOG_ERR("Could not add a route after receiving an aggregated DAO\n");
+      if(flags & RPL_DAO_K_FLAG) {
+        uipbuf_clear();
+        dao_ack_output(instance, dao_sender_addr, sequence,
+                       is_root ? RPL_DAO_ACK_UNABLE_TO_ADD_ROUTE_AT_ROOT :
+                       RPL_DAO_ACK_UNABLE_TO_ACCEPT);
+      }
+      return;
+    }
+    rep->state.lifetime = RPL_LIFETIME(instance, lifetime);
+    RPL_ROUTE_CLEAR_NOPATH_RECEIVED(rep);
+
+    /* Same check as for a single target: already installed and acked */
+    if(RPL_ROUTE_IS_DAO_PENDING(rep) || rep->state.dao_seqno_in != sequence) {
+      all_installed = 0;
+    }
+
+    if(!is_root && dag->preferred_parent != NULL) {
+      dao_aggregation_add(instance, &targets[i], target_lens[i], lifetime, flags, sequence);
+    }
+  }
+
+  if((flags & RPL_DAO_K_FLAG) && (is_root || all_installed)) {
+    LOG_DBG("Sending DAO ACK\n");
+    uipbuf_clear();
+    dao_ack_output(instance, dao_sender_addr, sequence,
+                   RPL_DAO_ACK_UNCONDITIONAL_ACCEPT);
+  }
+}
+#endif /* RPL_WITH_STORING && HCK_MOD_RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 static void
 dao_input_storing(void)
 {
@@ -766,6 +1038,11 @@ dao_input_storing(void)
   rpl_parent_t *parent;
   uip_ds6_nbr_t *nbr;
   int is_root;
+#if HCK_MOD_RPL_DAO_AGGREGATION
+  uip_ipaddr_t agg_targets[HCK_RPL_DAO_AGGREGATION_MAX_TARGETS];
+  uint8_t agg_target_lens[HCK_RPL_DAO_AGGREGATION_MAX_TARGETS];
+  uint8_t agg_num_targets = 0;
+#endif
 
   prefixlen = 0;
   parent = NULL;
@@ -821,6 +1098,9 @@ dao_input_storing(void)
       parent->rank = RPL_INFINITE_RANK;
       parent->hop_distance = 0xff; /* hckim to measure hop distance accurately */
       parent->flags |= RPL_PARENT_FLAG_UPDATED;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+      rpl_parent_cost_changed(parent);
+#endif
       return;
     }
 
@@ -830,6 +1110,9 @@ dao_input_storing(void)
       parent->rank = RPL_INFINITE_RANK;
       parent->hop_distance = 0xff; /* hckim to measure hop distance accurately */
       parent->flags |= RPL_PARENT_FLAG_UPDATED;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+      rpl_parent_cost_changed(parent);
+#endif
       return;
     }
   }
@@ -850,6 +1133,13 @@ dao_input_storing(void)
         prefixlen = buffer[i + 3];
         memset(&prefix, 0, sizeof(prefix));
         memcpy(&prefix, buffer + i + 4, (prefixlen + 7) / CHAR_BIT);
+#if HCK_MOD_RPL_DAO_AGGREGATION
+        if(agg_num_targets < HCK_RPL_DAO_AGGREGATION_MAX_TARGETS) {
+          uip_ipaddr_copy(&agg_targets[agg_num_targets], &prefix);
+          agg_target_lens[agg_num_targets] = prefixlen;
+        }
+        agg_num_targets++;
+#endif
         break;
       case RPL_OPTION_TRANSIT:
         /* The path sequence and control are ignored. */
@@ -861,6 +1151,14 @@ dao_input_storing(void)
     }
   }
 
+#if HCK_MOD_RPL_DAO_AGGREGATION
+  if(agg_num_targets > 1 && learned_from == RPL_ROUTE_FROM_UNICAST_DAO) {
+    dao_input_storing_aggregated(instance, &dao_sender_addr, flags, sequence, lifetime,
+                                 agg_targets, agg_target_lens, agg_num_targets);
+    return;
+  }
+#endif
+
   LOG_INFO("DAO lifetime: %u, prefix length: %u prefix: ",
          (unsigned)lifetime, (unsigned)prefixlen);
   LOG_INFO_6ADDR(&prefix);
@@ -1022,6 +1320,12 @@ fwd_dao:
       }
     }
 
+#if HCK_MOD_RPL_DAO_AGGREGATION
+    if(rep != NULL && dag->preferred_parent != NULL) {
+      /* Forwarded together with other child targets, see dao_aggregation_flush() */
+      dao_aggregation_add(instance, &prefix, prefixlen, lifetime, flags, sequence);
+    } else
+#endif
     if(dag->preferred_parent != NULL &&
        rpl_parent_get_ipaddr(dag->preferred_parent) != NULL) {
       uint8_t out_seq = 0;
@@ -1248,6 +1552,17 @@ handle_dao_retransmission(void *ptr)
     return;
   }
 
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  if(rpl_shaper_suppress_dao_retransmission(parent)) {
+    /* The previous transmission is still in the TSCH queue, check again later */
+    ctimer_set(&instance->dao_retransmit_timer,
+               RPL_DAO_RETRANSMISSION_TIMEOUT / 2 +
+               (random_rand() % (RPL_DAO_RETRANSMISSION_TIMEOUT / 2)),
+               handle_dao_retransmission, parent);
+    return;
+  }
+#endif
+
   ctimer_set(&instance->dao_retransmit_timer,
              RPL_DAO_RETRANSMISSION_TIMEOUT / 2 +
              (random_rand() % (RPL_DAO_RETRANSMISSION_TIMEOUT / 2)),
@@ -1439,6 +1754,71 @@ dao_output_target_seq(rpl_parent_t *parent, uip_ipaddr_t *prefix,
   }
 }
 /*---------------------------------------------------------------------------*/
+#if RPL_WITH_DAO_ACK && HCK_MOD_RPL_DAO_AGGREGATION
+/* An aggregated DAO covers the routes of several children under one outgoing
+ * sequence number: forward the DAO ACK once to every (child, seqno) pair. */
+static void
+dao_ack_forward_aggregated(rpl_instance_t *instance, uint8_t sequence, uint8_t status)
+{
+  uip_ds6_route_t *re;
+  uip_ds6_route_t *next;
+  uip_ipaddr_t nexthop;
+  uip_ipaddr_t acked_nexthops[HCK_RPL_DAO_AGGREGATION_MAX_TARGETS];
+  uint8_t acked_seqnos[HCK_RPL_DAO_AGGREGATION_MAX_TARGETS];
+  uint8_t num_acked = 0;
+  uint8_t found = 0;
+  unsigned char *buffer;
+  int i;
+
+  re = uip_ds6_route_head();
+  while(re != NULL) {
+    next = uip_ds6_route_next(re);
+    if(re->state.dao_seqno_out == sequence && RPL_ROUTE_IS_DAO_PENDING(re)) {
+      found = 1;
+      RPL_ROUTE_CLEAR_DAO_PENDING(re);
+
+      if(uip_ds6_route_nexthop(re) == NULL) {
+        LOG_WARN("No next hop to fwd DAO ACK to\n");
+      } else {
+        uip_ipaddr_copy(&nexthop, uip_ds6_route_nexthop(re));
+        for(i = 0; i < num_acked; i++) {
+          if(acked_seqnos[i] == re->state.dao_seqno_in &&
+             uip_ipaddr_cmp(&acked_nexthops[i], &nexthop)) {
+            break;
+          }
+        }
+        if(i == num_acked) {
+          if(num_acked < HCK_RPL_DAO_AGGREGATION_MAX_TARGETS) {
+            uip_ipaddr_copy(&acked_nexthops[num_acked], &nexthop);
+            acked_seqnos[num_acked] = re->state.dao_seqno_in;
+            num_acked++;
+          }
+          LOG_INFO("Fwd DAO ACK to:");
+          LOG_INFO_6ADDR(&nexthop);
+          LOG_INFO_("\n");
+          buffer = UIP_ICMP_PAYLOAD;
+          buffer[0] = instance->instance_id;
+          buffer[1] = 0;
+          buffer[2] = re->state.dao_seqno_in;
+          buffer[3] = status;
+          uip_icmp6_send(&nexthop, ICMP6_RPL, RPL_CODE_DAO_ACK, 4);
+        }
+      }
+
+      if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
+        /* this node did not get in to the routing tables above... - remove */
+        uip_ds6_route_rm(re);
+      }
+    }
+    re = next;
+  }
+
+  if(!found) {
+    LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
+  }
+}
+#endif /* RPL_WITH_DAO_ACK && HCK_MOD_RPL_DAO_AGGREGATION */
+/*---------------------------------------------------------------------------*/
 static void
 dao_ack_input(void)
 {
@@ -1511,6 +1891,9 @@ dao_ack_input(void)
 #endif
 
   } else if(RPL_IS_STORING(instance)) {
+#if HCK_MOD_RPL_DAO_AGGREGATION
+    dao_ack_forward_aggregated(instance, sequence, status);
+#else
     /* this DAO ACK should be forwarded to another recently registered route */
     uip_ds6_route_t *re;
     const uip_ipaddr_t *nexthop;
@@ -1537,6 +1920,7 @@ dao_ack_input(void)
     } else {
       LOG_WARN("No route entry found to forward DAO ACK (seqno %u)\n", sequence);
     }
+#endif
   }
 #endif /* RPL_WITH_DAO_ACK */
   uipbuf_clear();
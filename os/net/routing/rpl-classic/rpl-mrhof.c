@@ -122,9 +122,15 @@ dao_ack_callback(rpl_parent_t *p, int status)
   if(status >= RPL_DAO_ACK_UNABLE_TO_ACCEPT) {
     /* punish the ETX as if this was 10 packets lost */
     link_stats_packet_sent(rpl_get_parent_lladdr(p), MAC_TX_OK, 10);
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    rpl_parent_cost_changed(p);
+#endif
   } else if(status == RPL_DAO_ACK_TIMEOUT) { /* timeout = no ack */
     /* punish the total lack of ACK with a similar punishment */
     link_stats_packet_sent(rpl_get_parent_lladdr(p), MAC_TX_OK, 10);
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+    rpl_parent_cost_changed(p);
+#endif
   }
 }
 #endif /* RPL_WITH_DAO_ACK */
@@ -132,16 +138,40 @@ dao_ack_callback(rpl_parent_t *p, int status)
 static uint16_t
 parent_link_metric(rpl_parent_t *p)
 {
-  const struct link_stats *stats = rpl_get_parent_link_stats(p);
-  if(stats != NULL) {
+  const struct link_stats *stats;
+  uint16_t link_metric;
+
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  /* Avoid the link-stats table lookup; the cache is dropped by
+   * rpl_parent_cost_changed() whenever the ETX towards p is updated, and
+   * ignored once a link-stats entry was created or removed since */
+  if((p->flags & RPL_PARENT_FLAG_LINK_METRIC_VALID)
+     && p->link_stats_generation == link_stats_generation) {
+    return p->link_metric;
+  }
+#endif
+
+  stats = rpl_get_parent_link_stats(p);
+  if(stats == NULL) {
+    return 0xffff;
+  }
+
 #if RPL_MRHOF_SQUARED_ETX
+  {
     uint32_t squared_etx = ((uint32_t)stats->etx * stats->etx) / LINK_STATS_ETX_DIVISOR;
-    return (uint16_t)MIN(squared_etx, 0xffff);
+    link_metric = (uint16_t)MIN(squared_etx, 0xffff);
+  }
 #else /* RPL_MRHOF_SQUARED_ETX */
-  return stats->etx;
+  link_metric = stats->etx;
 #endif /* RPL_MRHOF_SQUARED_ETX */
-  }
-  return 0xffff;
+
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  p->link_metric = link_metric;
+  p->link_stats_generation = link_stats_generation;
+  p->flags |= RPL_PARENT_FLAG_LINK_METRIC_VALID;
+#endif
+
+  return link_metric;
 }
 /*---------------------------------------------------------------------------*/
 static uint16_t
@@ -335,6 +335,9 @@ void rpl_nullify_parent(rpl_parent_t *);
 void rpl_remove_parent(rpl_parent_t *);
 void rpl_move_parent(rpl_dag_t *dag_src, rpl_dag_t *dag_dst, rpl_parent_t *parent);
 rpl_parent_t *rpl_select_parent(rpl_dag_t *dag);
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+void rpl_parent_cost_changed(rpl_parent_t *p);
+#endif
 rpl_dag_t *rpl_select_dag(rpl_instance_t *instance,rpl_parent_t *parent);
 void rpl_recalculate_ranks(void);
 
@@ -358,6 +361,9 @@ void rpl_schedule_probing_now(rpl_instance_t *instance);
 
 void rpl_reset_dio_timer(rpl_instance_t *);
 void rpl_reset_periodic_timer(void);
+#if HCK_MOD_RPL_CONTROL_SHAPER
+int rpl_shaper_suppress_dao_retransmission(rpl_parent_t *parent);
+#endif
 
 /* Route poisoning. */
 void rpl_poison_routes(rpl_dag_t *, rpl_parent_t *);
@@ -50,6 +50,7 @@
 #include "sys/ctimer.h"
 #include "sys/log.h"
 #include <net/mac/tsch/tsch.h>
+#include <string.h>
 
 #define LOG_MODULE "RPL"
 #define LOG_LEVEL LOG_LEVEL_RPL
@@ -63,6 +64,23 @@ static uint32_t hop_distance_measure_sum;
 #if HCK_MOD_RPL_IGNORE_REDUNDANCY_IN_BOOTSTRAP
 static uint8_t ignore_redundancy = 1;
 #endif
+#if HCK_MOD_RPL_CONTROL_SHAPER
+#ifndef HCK_RPL_CONTROL_SHAPER_BCAST_QUEUE_THRESH
+#define HCK_RPL_CONTROL_SHAPER_BCAST_QUEUE_THRESH           2
+#endif
+#ifndef HCK_RPL_CONTROL_SHAPER_DAO_DEFER_DELAY
+#define HCK_RPL_CONTROL_SHAPER_DAO_DEFER_DELAY              CLOCK_SECOND
+#endif
+#ifndef HCK_RPL_CONTROL_SHAPER_MAX_DAO_DEFERRALS
+#define HCK_RPL_CONTROL_SHAPER_MAX_DAO_DEFERRALS            3
+#endif
+static uint32_t rpl_ctrl_dio_suppressed_count;
+static uint32_t rpl_ctrl_dao_deferred_count;
+static uint32_t rpl_ctrl_dao_retx_suppressed_count;
+static uint8_t dao_deferrals;
+static uint8_t dao_retx_deferrals;
+static uint8_t dao_retx_deferred_seqno;
+#endif
 /*---------------------------------------------------------------------------*/
 void print_log_rpl_timers()
 {
@@ -71,6 +89,19 @@ void print_log_rpl_timers()
         dag->rank == ROOT_RANK(dag->instance) ? 
           0 : dag->preferred_parent->hop_distance + 1, 
         hop_distance_measure_sum, hop_distance_measure_count);
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  LOG_HCK("dio_supp %lu dao_defer %lu dao_retx_supp %lu |\n",
+        rpl_ctrl_dio_suppressed_count,
+        rpl_ctrl_dao_deferred_count,
+        rpl_ctrl_dao_retx_suppressed_count);
+#endif
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+  LOG_HCK("trk_wake %lu trk_exp %lu trk_tx %lu trk_supp %lu |\n",
+        trickle_sched_stats.wakeups,
+        trickle_sched_stats.expiries,
+        trickle_sched_stats.tx,
+        trickle_sched_stats.suppressed);
+#endif
 }
 /*---------------------------------------------------------------------------*/
 void reset_log_rpl_timers()
@@ -84,7 +115,57 @@ void reset_log_rpl_timers()
   next_hop_distance_measure = 0;
   hop_distance_measure_count = 0;
   hop_distance_measure_sum = 0;
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  rpl_ctrl_dio_suppressed_count = 0;
+  rpl_ctrl_dao_deferred_count = 0;
+  rpl_ctrl_dao_retx_suppressed_count = 0;
+#endif
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+  memset(&trickle_sched_stats, 0, sizeof(trickle_sched_stats));
+#endif
+}
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_RPL_CONTROL_SHAPER
+/* A multicast DIO is held back while the broadcast queue is backlogged with
+ * other packets. If a stale DIO is still queued, the new one replaces it in
+ * place within the TSCH queue, so it is not suppressed here. */
+static int
+shaper_suppress_dio(void)
+{
+  return tsch_queue_nbr_packet_count(n_broadcast) >= HCK_RPL_CONTROL_SHAPER_BCAST_QUEUE_THRESH
+         && tsch_queue_nbr_packet_type_count(n_broadcast, HCK_PACKET_TYPE_M_DIO) == 0;
+}
+/*---------------------------------------------------------------------------*/
+static int
+shaper_dao_queued(rpl_parent_t *parent)
+{
+  const linkaddr_t *lladdr = rpl_get_parent_lladdr(parent);
+  if(lladdr == NULL) {
+    return 0;
+  }
+  return tsch_queue_nbr_packet_type_count(tsch_queue_get_nbr(lladdr), HCK_PACKET_TYPE_DAO) > 0;
+}
+/*---------------------------------------------------------------------------*/
+/* A DAO retransmission is redundant while an earlier DAO towards the same
+ * parent has not even left the TSCH queue. Bounded per DAO sequence number. */
+int
+rpl_shaper_suppress_dao_retransmission(rpl_parent_t *parent)
+{
+  rpl_instance_t *instance = parent->dag->instance;
+
+  if(dao_retx_deferred_seqno != instance->my_dao_seqno) {
+    dao_retx_deferred_seqno = instance->my_dao_seqno;
+    dao_retx_deferrals = 0;
+  }
+  if(dao_retx_deferrals >= HCK_RPL_CONTROL_SHAPER_MAX_DAO_DEFERRALS
+     || !shaper_dao_queued(parent)) {
+    return 0;
+  }
+  dao_retx_deferrals++;
+  rpl_ctrl_dao_retx_suppressed_count++;
+  return 1;
 }
+#endif
 /*---------------------------------------------------------------------------*/
 
 /* A configurable function called after update of the RPL DIO interval */
@@ -106,6 +187,14 @@ static struct ctimer periodic_timer;
 static void handle_periodic_timer(void *ptr);
 static void new_dio_interval(rpl_instance_t *instance);
 static void handle_dio_timer(void *ptr);
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+/* DIO timers share the trickle scheduler with MPL and other trickle users */
+#define dio_timer_set(instance, ticks) \
+  trickle_sched_set(&(instance)->dio_timer, (ticks), handle_dio_timer, (instance))
+#else
+#define dio_timer_set(instance, ticks) \
+  ctimer_set(&(instance)->dio_timer, (ticks), handle_dio_timer, (instance))
+#endif
 
 static uint16_t next_dis;
 
@@ -200,7 +289,7 @@ new_dio_interval(rpl_instance_t *instance)
 
   /* schedule the timer */
   LOG_INFO("Scheduling DIO timer %lu ticks in future (Interval)\n", ticks);
-  ctimer_set(&instance->dio_timer, ticks, &handle_dio_timer, instance);
+  dio_timer_set(instance, ticks);
 
 #ifdef RPL_CALLBACK_NEW_DIO_INTERVAL
   RPL_CALLBACK_NEW_DIO_INTERVAL((CLOCK_SECOND * 1UL << instance->dio_intcurrent) / 1000);
@@ -220,7 +309,7 @@ handle_dio_timer(void *ptr)
       dio_send_ok = 1;
     } else {
       LOG_WARN("Postponing DIO transmission since link local address is not ok\n");
-      ctimer_set(&instance->dio_timer, CLOCK_SECOND, &handle_dio_timer, instance);
+      dio_timer_set(instance, CLOCK_SECOND);
       return;
     }
   }
@@ -232,18 +321,36 @@ handle_dio_timer(void *ptr)
 #else
     if(instance->dio_redundancy == 0 || instance->dio_counter < instance->dio_redundancy) {
 #endif
+#if HCK_MOD_RPL_CONTROL_SHAPER
+      if(shaper_suppress_dio()) {
+        rpl_ctrl_dio_suppressed_count++;
+        LOG_DBG("Suppressing DIO transmission (broadcast queue backlogged)\n");
+      } else {
+#if RPL_CONF_STATS
+        instance->dio_totsend++;
+#endif /* RPL_CONF_STATS */
+        dio_output(instance, NULL);
+      }
+#else
 #if RPL_CONF_STATS
       instance->dio_totsend++;
 #endif /* RPL_CONF_STATS */
       dio_output(instance, NULL);
+#endif
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+      trickle_sched_stats.tx++;
+#endif
     } else {
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+      trickle_sched_stats.suppressed++;
+#endif
       LOG_DBG("Suppressing DIO transmission (%d >= %d)\n",
              instance->dio_counter, instance->dio_redundancy);
     }
     instance->dio_send = 0;
     LOG_DBG("Scheduling DIO timer %lu ticks in future (sent)\n",
            instance->dio_next_delay);
-    ctimer_set(&instance->dio_timer, instance->dio_next_delay, handle_dio_timer, instance);
+    dio_timer_set(instance, instance->dio_next_delay);
   } else {
     /* check if we need to double interval */
     if(instance->dio_intcurrent < instance->dio_intmin + instance->dio_intdoubl) {
@@ -329,6 +436,20 @@ handle_dao_timer(void *ptr)
     return;
   }
 
+#if HCK_MOD_RPL_CONTROL_SHAPER
+  /* Let an earlier DAO towards the preferred parent leave the TSCH queue first */
+  if(instance->current_dag->preferred_parent != NULL
+     && dao_deferrals < HCK_RPL_CONTROL_SHAPER_MAX_DAO_DEFERRALS
+     && shaper_dao_queued(instance->current_dag->preferred_parent)) {
+    dao_deferrals++;
+    rpl_ctrl_dao_deferred_count++;
+    ctimer_set(&instance->dao_timer, HCK_RPL_CONTROL_SHAPER_DAO_DEFER_DELAY,
+               handle_dao_timer, instance);
+    return;
+  }
+  dao_deferrals = 0;
+#endif
+
   /* Send the DAO to the DAO parent set -- the preferred parent in our case. */
   if(instance->current_dag->preferred_parent != NULL) {
     LOG_INFO("handle_dao_timer - sending DAO\n");
@@ -317,6 +317,9 @@ rpl_link_callback(const linkaddr_t *addr, int status, int numtx)
         /* Trigger DAG rank recalculation. */
         LOG_DBG("rpl_link_callback triggering update\n");
         parent->flags |= RPL_PARENT_FLAG_UPDATED;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+        rpl_parent_cost_changed(parent);
+#endif
       }
     }
   }
@@ -345,6 +348,9 @@ rpl_ipv6_neighbor_callback(uip_ds6_nbr_t *nbr)
         /* Trigger DAG rank recalculation. */
         LOG_DBG("rpl_ipv6_neighbor_callback infinite rank\n");
         p->flags |= RPL_PARENT_FLAG_UPDATED;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+        rpl_parent_cost_changed(p);
+#endif
       }
     }
   }
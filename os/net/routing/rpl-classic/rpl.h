@@ -44,8 +44,12 @@
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-ds6.h"
 #include "sys/ctimer.h"
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+#include "lib/trickle-timer.h"
+#endif
 
 void print_log_rpl_timers();
+void print_log_rpl_dag();
 void print_log_rpl();
 
 void reset_log_rpl_icmp6();
@@ -139,6 +143,9 @@ struct rpl_dag;
 /*---------------------------------------------------------------------------*/
 #define RPL_PARENT_FLAG_UPDATED           0x1
 #define RPL_PARENT_FLAG_LINK_METRIC_VALID 0x2
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+#define RPL_PARENT_FLAG_COST_PENDING      0x4 /* cost changed, not yet compared with the cached best parent */
+#endif
 
 struct rpl_parent {
   struct rpl_dag *dag;
@@ -152,6 +159,10 @@ struct rpl_parent {
 #if WITH_TRGB
   uint8_t trgb_rpl_grandP_id;
 #endif
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  uint16_t link_metric; /* valid if RPL_PARENT_FLAG_LINK_METRIC_VALID is set */
+  uint16_t link_stats_generation; /* link_stats_generation link_metric was read at */
+#endif
 };
 typedef struct rpl_parent rpl_parent_t;
 /*---------------------------------------------------------------------------*/
@@ -179,6 +190,13 @@ struct rpl_dag {
   struct rpl_instance *instance;
   rpl_prefix_t prefix_info;
   uint32_t lifetime;
+#if HCK_MOD_RPL_INCREMENTAL_PARENT_SELECTION
+  rpl_parent_t *best_parent; /* result of the last parent selection */
+  rpl_rank_t best_parent_rank; /* rank via best_parent when it was selected */
+  uint8_t best_parent_valid;
+  uint8_t best_parent_pending; /* number of parents with RPL_PARENT_FLAG_COST_PENDING */
+  uint16_t best_parent_link_stats_generation; /* link_stats_generation at the last full scan */
+#endif
 };
 typedef struct rpl_dag rpl_dag_t;
 typedef struct rpl_instance rpl_instance_t;
@@ -287,7 +305,11 @@ struct rpl_instance {
   rpl_parent_t *urgent_probing_target;
   int last_dag;
 #endif /* RPL_WITH_PROBING */
+#if HCK_MOD_TRICKLE_SHARED_SCHEDULER
+  struct trickle_sched_entry dio_timer;
+#else
   struct ctimer dio_timer;
+#endif
   struct ctimer dao_timer;
   struct ctimer dao_lifetime_timer;
   struct ctimer unicast_dio_timer;
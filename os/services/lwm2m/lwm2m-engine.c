@@ -54,6 +54,9 @@
 #include "lwm2m-tlv-writer.h"
 #include "lib/list.h"
 #include "sys/cc.h"
+#if HCK_MOD_LWM2M_STREAMING_READ
+#include "lib/crc16.h"
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
@@ -147,14 +150,37 @@ COAP_HANDLER(lwm2m_handler, lwm2m_handler_callback);
 LIST(object_list);
 LIST(generic_object_list);
 
+#if HCK_MOD_LWM2M_STREAMING_READ
+/*
+ * Objects and object instances are also hashed on their object ID. A
+ * bucket keeps the registration order, so lookups find what the list
+ * walk finds.
+ */
+#ifdef HCK_LWM2M_OBJECT_INDEX_CONF_BUCKETS
+#define OBJECT_INDEX_BUCKETS HCK_LWM2M_OBJECT_INDEX_CONF_BUCKETS
+#else
+#define OBJECT_INDEX_BUCKETS 8
+#endif
+#define OBJECT_INDEX_BUCKET(object_id) ((object_id) % OBJECT_INDEX_BUCKETS)
+
+static lwm2m_object_instance_t *instance_index[OBJECT_INDEX_BUCKETS];
+static lwm2m_object_t *object_index[OBJECT_INDEX_BUCKETS];
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+
 /*---------------------------------------------------------------------------*/
 static lwm2m_object_t *
 get_object(uint16_t object_id)
 {
   lwm2m_object_t *object;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  for(object = object_index[OBJECT_INDEX_BUCKET(object_id)];
+      object != NULL;
+      object = object->index_next) {
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
   for(object = list_head(generic_object_list);
       object != NULL;
       object = object->next) {
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
     if(object->impl && object->impl->object_id == object_id) {
       return object;
     }
@@ -166,9 +192,15 @@ static int
 has_non_generic_object(uint16_t object_id)
 {
   lwm2m_object_instance_t *instance;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  for(instance = instance_index[OBJECT_INDEX_BUCKET(object_id)];
+      instance != NULL;
+      instance = instance->index_next) {
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
   for(instance = list_head(object_list);
       instance != NULL;
       instance = instance->next) {
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
     if(instance->object_id == object_id) {
       return 1;
     }
@@ -187,9 +219,15 @@ get_instance(uint16_t object_id, uint16_t instance_id, lwm2m_object_t **o)
     *o = NULL;
   }
 
+#if HCK_MOD_LWM2M_STREAMING_READ
+  for(instance = instance_index[OBJECT_INDEX_BUCKET(object_id)];
+      instance != NULL;
+      instance = instance->index_next) {
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
   for(instance = list_head(object_list);
       instance != NULL;
       instance = instance->next) {
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
     if(instance->object_id == object_id) {
       if(instance->instance_id == instance_id ||
          instance_id == LWM2M_OBJECT_INSTANCE_NONE) {
@@ -508,6 +546,10 @@ lwm2m_engine_init(void)
 {
   list_init(object_list);
   list_init(generic_object_list);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  memset(instance_index, 0, sizeof(instance_index));
+  memset(object_index, 0, sizeof(object_index));
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 
 #ifdef LWM2M_ENGINE_CLIENT_ENDPOINT_NAME
   const char *endpoint = LWM2M_ENGINE_CLIENT_ENDPOINT_NAME;
@@ -642,6 +684,7 @@ lwm2m_engine_select_reader(lwm2m_context_t *context, unsigned int content_format
 /*---------------------------------------------------------------------------*/
 /* Lightweight object instances */
 /*---------------------------------------------------------------------------*/
+#if !HCK_MOD_LWM2M_STREAMING_READ
 static uint32_t last_instance_id = NO_INSTANCE;
 static int last_rsc_pos;
 
@@ -923,6 +966,257 @@ perform_multi_resource_read_op(lwm2m_object_t *object,
 
   return LWM2M_STATUS_OK;
 }
+#endif /* !HCK_MOD_LWM2M_STREAMING_READ */
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_LWM2M_STREAMING_READ
+/*
+ * Streaming read: the representation is produced from its start for
+ * each block requested, one resource at a time through the double
+ * buffer, and only the bytes that fall into the block are kept. Nothing
+ * is remembered between blocks, so they can be requested in any order,
+ * several at a time, and again.
+ */
+typedef struct {
+  lwm2m_buffer_t *block; /* the block requested */
+  uint32_t offset;       /* of the block in the representation */
+  uint32_t len;          /* of the representation produced so far */
+  uint16_t crc;          /* of the representation produced so far */
+  uint8_t counting;      /* nothing is output, the bytes are only counted */
+} read_stream_t;
+
+static void
+stream_flush(read_stream_t *stream, lwm2m_buffer_t *buf)
+{
+  uint32_t from;
+  uint32_t to;
+
+  if(!stream->counting) {
+    from = MAX(stream->offset, stream->len);
+    to = MIN(stream->offset + stream->block->size, stream->len + buf->len);
+    if(from < to) {
+      memcpy(&stream->block->buffer[from - stream->offset],
+             &buf->buffer[from - stream->len], to - from);
+      stream->block->len = to - stream->offset;
+    }
+    stream->crc = crc16_data(buf->buffer, buf->len, stream->crc);
+  }
+  stream->len += buf->len;
+  buf->len = 0;
+}
+/*---------------------------------------------------------------------------*/
+static lwm2m_status_t
+stream_resource(lwm2m_object_instance_t *instance, lwm2m_context_t *ctx,
+                read_stream_t *stream)
+{
+  lwm2m_status_t success;
+  uint32_t opaque_offset;
+
+  current_opaque_callback = NULL;
+  success = instance->callback(instance, ctx);
+  if(success == LWM2M_STATUS_OK && current_opaque_callback != NULL) {
+    /* The opaque is drawn from its callback a double buffer at a time */
+    opaque_offset = 0;
+    do {
+      stream_flush(stream, ctx->outbuf);
+      ctx->offset = opaque_offset;
+      ctx->writer_flags &= ~WRITER_HAS_MORE;
+      success = current_opaque_callback(instance, ctx, ctx->outbuf->size);
+      opaque_offset += ctx->outbuf->len;
+    } while(success == LWM2M_STATUS_OK && ctx->outbuf->len > 0 &&
+            (ctx->writer_flags & WRITER_HAS_MORE));
+    ctx->writer_flags &= ~WRITER_HAS_MORE;
+    current_opaque_callback = NULL;
+  }
+  stream_flush(stream, ctx->outbuf);
+  return success;
+}
+/*---------------------------------------------------------------------------*/
+static lwm2m_status_t
+stream_instance(lwm2m_object_instance_t *instance, lwm2m_context_t *ctx,
+                read_stream_t *stream, uint8_t lv, uint8_t *num_read)
+{
+  lwm2m_resource_id_t rsc;
+  lwm2m_status_t success;
+  uint16_t i;
+  int len;
+  int dim;
+
+  if(instance->resource_ids == NULL) {
+    return LWM2M_STATUS_OK;
+  }
+
+  for(i = 0; i < instance->resource_count; i++) {
+    rsc = instance->resource_ids[i];
+    if(lv == 3 && ctx->resource_id != RSC_ID(rsc)) {
+      continue;
+    }
+
+    if(ctx->operation == LWM2M_OP_DISCOVER) {
+      len = snprintf((char *)&ctx->outbuf->buffer[ctx->outbuf->len],
+                     ctx->outbuf->size - ctx->outbuf->len,
+                     stream->len == 0 ? "</%d/%d/%d>" : ",</%d/%d/%d>",
+                     instance->object_id, instance->instance_id, RSC_ID(rsc));
+      if(len < 0 || len >= ctx->outbuf->size - ctx->outbuf->len) {
+        return LWM2M_STATUS_ERROR;
+      }
+      ctx->outbuf->len += len;
+      if(instance->resource_dim_callback != NULL &&
+         (dim = instance->resource_dim_callback(instance, RSC_ID(rsc))) > 0) {
+        len = snprintf((char *)&ctx->outbuf->buffer[ctx->outbuf->len],
+                       ctx->outbuf->size - ctx->outbuf->len, ";dim=%d", dim);
+        if(len < 0 || len >= ctx->outbuf->size - ctx->outbuf->len) {
+          return LWM2M_STATUS_ERROR;
+        }
+        ctx->outbuf->len += len;
+      }
+      (*num_read)++;
+      stream_flush(stream, ctx->outbuf);
+      continue;
+    }
+
+    /* Do not allow a read on a non-readable */
+    if(!RSC_READABLE(rsc)) {
+      if(lv == 3) {
+        return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+      }
+      LOG_DBG("Resource %u not readable\n", RSC_ID(rsc));
+      continue;
+    }
+
+    ctx->object_instance_id = instance->instance_id;
+    ctx->resource_id = RSC_ID(rsc);
+    ctx->level = 3;
+    success = stream_resource(instance, ctx, stream);
+    ctx->level = lv;
+    (*num_read)++;
+    LOG_DBG("Called %u/%u/%u stream:%"PRIu32" %s\n",
+            ctx->object_id, ctx->object_instance_id, ctx->resource_id,
+            stream->len, get_status_as_string(success));
+
+    /* A resource not found is skipped in a read of more than one */
+    if(success != LWM2M_STATUS_OK &&
+       (lv == 3 || success != LWM2M_STATUS_NOT_FOUND)) {
+      return success;
+    }
+  }
+  return LWM2M_STATUS_OK;
+}
+/*---------------------------------------------------------------------------*/
+static lwm2m_status_t
+perform_stream_read_op(lwm2m_object_t *object,
+                       lwm2m_object_instance_t *instance,
+                       lwm2m_context_t *ctx)
+{
+  read_stream_t stream;
+  lwm2m_status_t success;
+  uint32_t instance_start;
+  uint8_t num_read = 0;
+  uint8_t etag[2];
+  uint8_t lv;
+
+  if(instance == NULL) {
+    /* No existing instance */
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+
+  if(ctx->level < 3 &&
+     (ctx->content_type == LWM2M_TEXT_PLAIN ||
+      ctx->content_type == TEXT_PLAIN ||
+      ctx->content_type == LWM2M_OLD_OPAQUE)) {
+    return LWM2M_STATUS_OPERATION_NOT_ALLOWED;
+  }
+
+  /* The double buffer keeps the rest of the RD data between its blocks */
+  if(lwm2m_buf_lock[0] != 0 && (lwm2m_buf_lock_timeout > coap_timer_uptime())) {
+    LOG_DBG("Stream-read: already exporting resource: %d/%d/%d\n",
+            lwm2m_buf_lock[1], lwm2m_buf_lock[2], lwm2m_buf_lock[3]);
+    return LWM2M_STATUS_SERVICE_UNAVAILABLE;
+  }
+
+  LOG_DBG("StreamRead: %d/%d/%d lv:%d offset:%"PRIu32"\n",
+          ctx->object_id, ctx->object_instance_id, ctx->resource_id,
+          ctx->level, ctx->offset);
+
+  stream.block = ctx->outbuf;
+  stream.offset = ctx->offset;
+  stream.len = 0;
+  stream.crc = 0;
+  stream.counting = 0;
+  stream.block->len = 0;
+
+  ctx->outbuf = &lwm2m_buf;
+  lwm2m_buf.len = 0;
+  current_opaque_callback = NULL;
+  success = LWM2M_STATUS_OK;
+  lv = ctx->level;
+
+  if(ctx->operation == LWM2M_OP_READ) {
+    if(lv == 1) {
+      /* All instances of the object in one representation */
+      ctx->writer_flags |= WRITER_COMPOSITE;
+    }
+    ctx->outbuf->len += ctx->writer->init_write(ctx);
+    stream_flush(&stream, ctx->outbuf);
+  }
+
+  for(; instance != NULL; instance = next_object_instance(ctx, object, instance)) {
+    if((ctx->writer_flags & WRITER_COMPOSITE) &&
+       ctx->writer->write_instance_header != NULL) {
+      /* The instance is wrapped in a header with its size, counted first */
+      instance_start = stream.len;
+      stream.counting = 1;
+      success = stream_instance(instance, ctx, &stream, lv, &num_read);
+      stream.counting = 0;
+      if(success != LWM2M_STATUS_OK) {
+        break;
+      }
+      ctx->object_instance_id = instance->instance_id;
+      ctx->outbuf->len +=
+        ctx->writer->write_instance_header(ctx, stream.len - instance_start);
+      stream.len = instance_start;
+      stream_flush(&stream, ctx->outbuf);
+    }
+    success = stream_instance(instance, ctx, &stream, lv, &num_read);
+    if(success != LWM2M_STATUS_OK) {
+      break;
+    }
+  }
+
+  if(success == LWM2M_STATUS_OK && ctx->operation == LWM2M_OP_READ) {
+    ctx->outbuf->len += ctx->writer->end_write(ctx);
+    stream_flush(&stream, ctx->outbuf);
+  }
+  ctx->outbuf = stream.block;
+
+  if(success != LWM2M_STATUS_OK) {
+    return success;
+  }
+
+  /* did not read anything even if we should have - on single item */
+  if(num_read == 0 && lv == 3) {
+    return LWM2M_STATUS_NOT_FOUND;
+  }
+
+  ctx->offset = stream.offset + stream.block->len;
+  if(stream.len > ctx->offset) {
+    ctx->writer_flags |= WRITER_HAS_MORE;
+  } else {
+    ctx->writer_flags &= ~WRITER_HAS_MORE;
+  }
+
+  if(stream.len > stream.block->size) {
+    /* Lets the client tell blocks of different representations apart */
+    etag[0] = stream.crc >> 8;
+    etag[1] = stream.crc & 0xff;
+    coap_set_header_etag(ctx->response, etag, sizeof(etag));
+    coap_set_header_size2(ctx->response, stream.len);
+  }
+
+  LOG_DBG("At END: %"PRIu32" of %"PRIu32" bytes\n", ctx->offset, stream.len);
+
+  return LWM2M_STATUS_OK;
+}
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 /*---------------------------------------------------------------------------*/
 static lwm2m_object_instance_t *
 create_instance(lwm2m_context_t *context, lwm2m_object_t *object)
@@ -1215,6 +1509,62 @@ lwm2m_engine_has_instance(uint16_t object_id, uint16_t instance_id)
   return get_instance(object_id, instance_id, NULL) != NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_LWM2M_STREAMING_READ
+static void
+index_add_instance(lwm2m_object_instance_t *instance)
+{
+  lwm2m_object_instance_t **p;
+
+  for(p = &instance_index[OBJECT_INDEX_BUCKET(instance->object_id)];
+      *p != NULL;
+      p = &(*p)->index_next);
+  instance->index_next = NULL;
+  *p = instance;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_remove_instance(lwm2m_object_instance_t *instance)
+{
+  lwm2m_object_instance_t **p;
+
+  for(p = &instance_index[OBJECT_INDEX_BUCKET(instance->object_id)];
+      *p != NULL;
+      p = &(*p)->index_next) {
+    if(*p == instance) {
+      *p = instance->index_next;
+      return;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_add_object(lwm2m_object_t *object)
+{
+  lwm2m_object_t **p;
+
+  for(p = &object_index[OBJECT_INDEX_BUCKET(object->impl->object_id)];
+      *p != NULL;
+      p = &(*p)->index_next);
+  object->index_next = NULL;
+  *p = object;
+}
+/*---------------------------------------------------------------------------*/
+static void
+index_remove_object(lwm2m_object_t *object)
+{
+  lwm2m_object_t **p;
+
+  for(p = &object_index[OBJECT_INDEX_BUCKET(object->impl->object_id)];
+      *p != NULL;
+      p = &(*p)->index_next) {
+    if(*p == object) {
+      *p = object->index_next;
+      return;
+    }
+  }
+}
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+/*---------------------------------------------------------------------------*/
 int
 lwm2m_engine_add_object(lwm2m_object_instance_t *object)
 {
@@ -1234,9 +1584,15 @@ lwm2m_engine_add_object(lwm2m_object_instance_t *object)
     return 0;
   }
 
+#if HCK_MOD_LWM2M_STREAMING_READ
+  for(instance = instance_index[OBJECT_INDEX_BUCKET(object->object_id)];
+      instance != NULL;
+      instance = instance->index_next) {
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
   for(instance = list_head(object_list);
       instance != NULL;
       instance = instance->next) {
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
     if(object->object_id == instance->object_id) {
       if(object->instance_id == instance->instance_id) {
         LOG_DBG("object with id %u/%u already registered\n",
@@ -1266,6 +1622,9 @@ lwm2m_engine_add_object(lwm2m_object_instance_t *object)
     }
   }
   list_add(object_list, object);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  index_add_instance(object);
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1276,6 +1635,9 @@ void
 lwm2m_engine_remove_object(lwm2m_object_instance_t *object)
 {
   list_remove(object_list, object);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  index_remove_instance(object);
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1304,6 +1666,9 @@ lwm2m_engine_add_generic_object(lwm2m_object_t *object)
     return 0;
   }
   list_add(generic_object_list, object);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  index_add_object(object);
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
@@ -1316,6 +1681,9 @@ void
 lwm2m_engine_remove_generic_object(lwm2m_object_t *object)
 {
   list_remove(generic_object_list, object);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  index_remove_object(object);
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 #if USE_RD_CLIENT
   lwm2m_rd_client_set_update_rd();
 #endif
@@ -1336,6 +1704,17 @@ next_object_instance(const lwm2m_context_t *context, lwm2m_object_t *object,
   }
 
   if(object == NULL) {
+#if HCK_MOD_LWM2M_STREAMING_READ
+    if(context != NULL) {
+      /* The other instances of the object are in the same bucket */
+      for(last = last->index_next; last != NULL; last = last->index_next) {
+        if(last->object_id == context->object_id) {
+          return last;
+        }
+      }
+      return NULL;
+    }
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
     for(last = last->next; last != NULL; last = last->next) {
       /* if no context is given - this will just give the next object */
       if(context == NULL || last->object_id == context->object_id) {
@@ -1565,6 +1944,12 @@ lwm2m_queue_mode_request_received();
 
   /* This is a discovery operation */
   switch(context.operation) {
+#if HCK_MOD_LWM2M_STREAMING_READ
+  case LWM2M_OP_DISCOVER:
+  case LWM2M_OP_READ:
+    success = perform_stream_read_op(object, instance, &context);
+    break;
+#else /* HCK_MOD_LWM2M_STREAMING_READ */
   case LWM2M_OP_DISCOVER:
     /* Assume only one disco at a time... */
     success = perform_multi_resource_read_op(object, instance, &context);
@@ -1572,6 +1957,7 @@ lwm2m_queue_mode_request_received();
   case LWM2M_OP_READ:
     success = perform_multi_resource_read_op(object, instance, &context);
     break;
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   case LWM2M_OP_WRITE:
     success = perform_multi_resource_write_op(object, instance, &context, format);
     break;
@@ -84,6 +84,10 @@ struct lwm2m_object_instance {
   /* the callback for requests */
   lwm2m_object_instance_callback_t callback;
   lwm2m_resource_dim_callback_t resource_dim_callback;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  /* next instance in the same bucket of the object index */
+  lwm2m_object_instance_t *index_next;
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 };
 
 typedef struct {
@@ -102,6 +106,10 @@ typedef struct lwm2m_object lwm2m_object_t;
 struct lwm2m_object {
   lwm2m_object_t *next;
   const lwm2m_object_impl_t *impl;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  /* next object in the same bucket of the object index */
+  lwm2m_object_t *index_next;
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 };
 
 lwm2m_object_instance_t *lwm2m_engine_get_instance_buffer(void);
@@ -153,6 +153,19 @@ lwm2m_json_next_token(lwm2m_context_t *ctx, struct json_data *json)
 static size_t
 init_write(lwm2m_context_t *ctx)
 {
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(ctx->writer_flags & WRITER_COMPOSITE) {
+    /* One document for all instances, the names carry the instance */
+    int len = snprintf((char *)&ctx->outbuf->buffer[ctx->outbuf->len],
+                       ctx->outbuf->size - ctx->outbuf->len, "{\"bn\":\"/%u/\",\"e\":[",
+                       ctx->object_id);
+    ctx->writer_flags = WRITER_COMPOSITE;
+    if((len < 0) || (len >= ctx->outbuf->size - ctx->outbuf->len)) {
+      return 0;
+    }
+    return len;
+  }
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   int len = snprintf((char *)&ctx->outbuf->buffer[ctx->outbuf->len],
                      ctx->outbuf->size - ctx->outbuf->len, "{\"bn\":\"/%u/%u/\",\"e\":[",
                      ctx->object_id, ctx->object_instance_id);
@@ -192,12 +205,36 @@ exit_sub(lwm2m_context_t *ctx)
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_LWM2M_STREAMING_READ
+/* The name of a value of a composite read, relative to the object */
+static int
+write_composite_name(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
+                     const char *sep)
+{
+  if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
+    return snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u/%u\",", sep,
+                    ctx->object_instance_id, ctx->resource_id,
+                    ctx->resource_instance_id);
+  }
+  return snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u\",", sep,
+                  ctx->object_instance_id, ctx->resource_id);
+}
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+/*---------------------------------------------------------------------------*/
 static size_t
 write_boolean(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
               int value)
 {
   char *sep = (ctx->writer_flags & WRITER_OUTPUT_VALUE) ? "," : "";
   int len;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(ctx->writer_flags & WRITER_COMPOSITE) {
+    len = write_composite_name(ctx, outbuf, outlen, sep);
+    if(len > 0 && len < outlen) {
+      len += snprintf((char *)&outbuf[len], outlen - len, "\"bv\":%s}", value ? "true" : "false");
+    }
+  } else
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
     len = snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u\",\"bv\":%s}", sep, ctx->resource_id, ctx->resource_instance_id, value ? "true" : "false");
   } else {
@@ -218,6 +255,14 @@ write_int(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
 {
   char *sep = (ctx->writer_flags & WRITER_OUTPUT_VALUE) ? "," : "";
   int len;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(ctx->writer_flags & WRITER_COMPOSITE) {
+    len = write_composite_name(ctx, outbuf, outlen, sep);
+    if(len > 0 && len < outlen) {
+      len += snprintf((char *)&outbuf[len], outlen - len, "\"v\":%"PRId32"}", value);
+    }
+  } else
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
     len = snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u\",\"v\":%"PRId32"}", sep, ctx->resource_id, ctx->resource_instance_id, value);
   } else {
@@ -239,6 +284,14 @@ write_float32fix(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
   char *sep = (ctx->writer_flags & WRITER_OUTPUT_VALUE) ? "," : "";
   size_t len = 0;
   int res;
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(ctx->writer_flags & WRITER_COMPOSITE) {
+    res = write_composite_name(ctx, outbuf, outlen, sep);
+    if(res > 0 && res < outlen) {
+      res += snprintf((char *)&outbuf[res], outlen - res, "\"v\":");
+    }
+  } else
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
     res = snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u\",\"v\":", sep, ctx->resource_id, ctx->resource_instance_id);
   } else {
@@ -273,6 +326,14 @@ write_string(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen,
   size_t len = 0;
   int res;
   LOG_DBG("{\"n\":\"%u\",\"sv\":\"", ctx->resource_id);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  if(ctx->writer_flags & WRITER_COMPOSITE) {
+    res = write_composite_name(ctx, outbuf, outlen, sep);
+    if(res > 0 && res < outlen) {
+      res += snprintf((char *)&outbuf[res], outlen - res, "\"sv\":\"");
+    }
+  } else
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
   if(ctx->writer_flags & WRITER_RESOURCE_INSTANCE) {
     res = snprintf((char *)outbuf, outlen, "%s{\"n\":\"%u/%u\",\"sv\":\"", sep,
                    ctx->resource_id, ctx->resource_instance_id);
@@ -116,6 +116,10 @@ typedef enum {
 #define WRITER_OUTPUT_VALUE      1
 #define WRITER_RESOURCE_INSTANCE 2
 #define WRITER_HAS_MORE          4
+#if HCK_MOD_LWM2M_STREAMING_READ
+/* values of all instances of an object in one document */
+#define WRITER_COMPOSITE         8
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 
 typedef struct lwm2m_reader lwm2m_reader_t;
 typedef struct lwm2m_writer lwm2m_writer_t;
@@ -174,6 +178,10 @@ struct lwm2m_writer {
   size_t (* write_float32fix)(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen, int32_t value, int bits);
   size_t (* write_boolean)(lwm2m_context_t *ctx, uint8_t *outbuf, size_t outlen, int value);
   size_t (* write_opaque_header)(lwm2m_context_t *ctx, size_t total_size);
+#if HCK_MOD_LWM2M_STREAMING_READ
+  /* For formats that wrap each instance of a composite read */
+  size_t (* write_instance_header)(lwm2m_context_t *ctx, size_t instance_size);
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 };
 
 struct lwm2m_reader {
@@ -117,6 +117,20 @@ write_opaque_header(lwm2m_context_t *ctx, size_t payloadsize)
                          ctx->outbuf->size - ctx->outbuf->len);
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_LWM2M_STREAMING_READ
+static size_t
+write_instance_header(lwm2m_context_t *ctx, size_t instance_size)
+{
+  lwm2m_tlv_t tlv;
+  tlv.type = LWM2M_TLV_TYPE_OBJECT_INSTANCE;
+  tlv.value = (uint8_t *) NULL;
+  tlv.length = (uint32_t) instance_size;
+  tlv.id = ctx->object_instance_id;
+  return lwm2m_tlv_write(&tlv, &ctx->outbuf->buffer[ctx->outbuf->len],
+                         ctx->outbuf->size - ctx->outbuf->len);
+}
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
+/*---------------------------------------------------------------------------*/
 static size_t
 enter_sub(lwm2m_context_t *ctx)
 {
@@ -167,7 +181,10 @@ const lwm2m_writer_t lwm2m_tlv_writer = {
   write_string_tlv,
   write_float32fix_tlv,
   write_boolean_tlv,
-  write_opaque_header
+  write_opaque_header,
+#if HCK_MOD_LWM2M_STREAMING_READ
+  write_instance_header
+#endif /* HCK_MOD_LWM2M_STREAMING_READ */
 };
 /*---------------------------------------------------------------------------*/
 /** @} */
@@ -617,6 +617,37 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
 
   PT_END(pt);
 }
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_policy(struct pt *pt, shell_output_func output, char *args))
+{
+  char *next_args;
+  const char *name;
+  int i;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+
+  /* Get optional arg (policy name) */
+  SHELL_ARGS_NEXT(args, next_args);
+
+  if(args != NULL && !tsch_shared_cell_policy_select(args)) {
+    SHELL_OUTPUT(output, "Cannot select %s: unknown policy or node is associated\n", args);
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "TSCH shared-cell policy: %s\n", tsch_shared_cell_policy_current());
+  SHELL_OUTPUT(output, "-- Available:");
+  for(i = 0; (name = tsch_shared_cell_policy_get(i)) != NULL; i++) {
+    SHELL_OUTPUT(output, " %s", name);
+  }
+  SHELL_OUTPUT(output, "\n");
+
+  PT_END(pt);
+}
+#endif /* HCK_MOD_TSCH_SHARED_CELL_POLICY */
 #endif /* MAC_CONF_WITH_TSCH */
 #if NETSTACK_CONF_WITH_IPV6
 /*---------------------------------------------------------------------------*/
@@ -1007,6 +1038,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if HCK_MOD_TSCH_SHARED_CELL_POLICY
+  { "tsch-policy",          cmd_tsch_policy,          "'> tsch-policy [name]': Shows or selects the TSCH shared-cell policy (only while not associated)" },
+#endif /* HCK_MOD_TSCH_SHARED_CELL_POLICY */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
@@ -164,6 +164,9 @@ simple_energest_init(void)
   curr_tx = energest_type_time(ENERGEST_TYPE_TRANSMIT);
   last_deep_lpm = energest_type_time(ENERGEST_TYPE_DEEP_LPM);
   last_rx = energest_type_time(ENERGEST_TYPE_LISTEN);
+#if HCK_MOD_PROCESS_PRIORITY
+  process_set_priority(&simple_energest_process, PROCESS_PRIO_LOG);
+#endif
   process_start(&simple_energest_process, NULL);
 }
 
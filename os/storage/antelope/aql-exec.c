@@ -79,6 +79,16 @@ aql_execute(db_handle_t *handle, aql_adt_t *adt)
     return DB_OK;
   }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  /* Other operations must see the buffered rows of a bulk insertion. */
+  if(optype != AQL_TYPE_INSERT) {
+    result = relation_bulk_flush();
+    if(DB_ERROR(result)) {
+      return result;
+    }
+  }
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
   /* If the ASSIGN flag is set, the first relation in the array is
      the desired result relation. */
   first_rel_arg = !!(adt->flags & AQL_FLAG_ASSIGN);
@@ -210,6 +220,26 @@ db_query(db_handle_t *handle, const char *format, ...)
   return aql_execute(handle, &adt);
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t
+db_bulk_begin(char *name)
+{
+  return relation_bulk_begin(name);
+}
+
+db_result_t
+db_bulk_flush(void)
+{
+  return relation_bulk_flush();
+}
+
+db_result_t
+db_bulk_end(void)
+{
+  return relation_bulk_end();
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 db_result_t
 db_process(db_handle_t *handle)
 {
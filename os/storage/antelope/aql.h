@@ -218,5 +218,10 @@ db_result_t aql_add_attribute(aql_adt_t *adt, char *name,
 db_result_t aql_add_value(aql_adt_t *adt, domain_t domain, void *value);
 db_result_t db_query(db_handle_t *handle, const char *format, ...);
 db_result_t db_process(db_handle_t *handle);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t db_bulk_begin(char *name);
+db_result_t db_bulk_flush(void);
+db_result_t db_bulk_end(void);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 
 #endif /* !AQL_H */
@@ -62,6 +62,9 @@ static db_result_t null_op(index_t *);
 static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
 static db_result_t delete(index_t *, attribute_value_t *);
 static tuple_id_t get_next(index_iterator_t *);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+static db_result_t insert_rows(index_t *, unsigned char *, unsigned, tuple_id_t);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 
 /*
  * The create, destroy, load, release, insert, and delete operations
@@ -80,6 +83,9 @@ index_api_t index_inline = {
   insert,
   delete,
   get_next
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  , insert_rows
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 };
 
 static attribute_value_t *
@@ -198,6 +204,16 @@ delete(index_t *index, attribute_value_t *value)
   return DB_OK;
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+static db_result_t
+insert_rows(index_t *index, unsigned char *rows, unsigned count,
+            tuple_id_t tuple_id)
+{
+  /* The appended rows are the index, so there are no keys to decode. */
+  return DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 static tuple_id_t
 get_next(index_iterator_t *iterator)
 {
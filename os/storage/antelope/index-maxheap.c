@@ -70,6 +70,10 @@
 #define BUCKET_SIZE	128
 #define NODE_LIMIT	511
 #define NODE_DEPTH      9
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+/* Keys of a bulk insertion that are sorted and appended together */
+#define BULK_BATCH      32
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 
 #if (1 << NODE_DEPTH) != (NODE_LIMIT + 1)
 #error "NODE_DEPTH is set incorrectly."
@@ -141,6 +145,9 @@ static db_result_t release(index_t *);
 static db_result_t insert(index_t *, attribute_value_t *, tuple_id_t);
 static db_result_t delete(index_t *, attribute_value_t *);
 static tuple_id_t get_next(index_iterator_t *);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+static db_result_t insert_rows(index_t *, unsigned char *, unsigned, tuple_id_t);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 
 index_api_t index_maxheap = {
   INDEX_MAXHEAP,
@@ -152,6 +159,9 @@ index_api_t index_maxheap = {
   insert,
   delete,
   get_next
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  , insert_rows
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 };
 
 static struct bucket_cache *
@@ -395,6 +405,7 @@ static int
 bucket_append(heap_t *heap, int bucket_id, struct key_value_pair *pair)
 {
   unsigned long offset;
+  struct bucket_cache *cache;
 
   if(heap->next_free_slot[bucket_id] >= BUCKET_SIZE) {
     PRINTF("DB: Invalid write attempt to the full bucket %d\n", bucket_id);
@@ -408,6 +419,11 @@ bucket_append(heap_t *heap, int bucket_id, struct key_value_pair *pair)
     return 0;
   }
 
+  /* Keep a cached copy of the bucket in step with the storage. */
+  cache = get_cache(heap, bucket_id);
+  if(cache != NULL) {
+    cache->bucket.pairs[heap->next_free_slot[bucket_id]] = *pair;
+  }
   heap->next_free_slot[bucket_id]++;
 
   return 1;
@@ -491,6 +507,138 @@ insert_item(heap_t *heap, maxheap_key_t key, maxheap_value_t value)
   return 1;
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+/*
+ * Find the bucket of a key. If the bucket has no children, every key
+ * whose hash is in *range goes into it as well; otherwise *range is set
+ * to be empty.
+ */
+static int
+find_bucket(heap_t *heap, maxheap_key_t key, heap_node_t *range)
+{
+  int heap_iterator;
+  int bucket_id;
+  int last_good_bucket_id;
+  int first_child;
+  heap_node_t child;
+
+  for(heap_iterator = 0, last_good_bucket_id = -1;;) {
+    bucket_id = heap_find(heap, key, &heap_iterator);
+    if(bucket_id < 0) {
+      break;
+    }
+    last_good_bucket_id = bucket_id;
+  }
+
+  range->min = 1;
+  range->max = 0;
+  if(last_good_bucket_id < 0) {
+    return -1;
+  }
+
+  first_child = BRANCH_FACTOR * last_good_bucket_id + 1;
+  if(first_child < NODE_LIMIT) {
+    if(heap_read(heap, first_child, &child) == 0) {
+      return -1;
+    }
+    if(!EMPTY_NODE(&child)) {
+      return last_good_bucket_id;
+    }
+  }
+
+  if(heap_read(heap, last_good_bucket_id, range) == 0) {
+    return -1;
+  }
+
+  return last_good_bucket_id;
+}
+
+/*
+ * Insert the keys of a chunk of rows. The pairs are sorted by hashed
+ * key, so that the ones that go into the same bucket are adjacent: the
+ * heap is searched once per bucket, and each bucket is appended to with
+ * a single write.
+ */
+static int
+insert_items(heap_t *heap, struct key_value_pair *pairs,
+             maxheap_key_t *hashes, unsigned count)
+{
+  struct key_value_pair pair;
+  maxheap_key_t hash;
+  struct bucket_cache *cache;
+  heap_node_t range;
+  unsigned long offset;
+  unsigned i, j, run;
+  int bucket_id;
+
+  for(i = 1; i < count; i++) {
+    pair = pairs[i];
+    hash = hashes[i];
+    for(j = i; j > 0 && hashes[j - 1] > hash; j--) {
+      pairs[j] = pairs[j - 1];
+      hashes[j] = hashes[j - 1];
+    }
+    pairs[j] = pair;
+    hashes[j] = hash;
+  }
+
+  range.min = 1;
+  range.max = 0;
+  bucket_id = -1;
+  for(i = 0; i < count; i += run) {
+    run = 0;
+    if(bucket_id < 0 || hashes[i] < range.min || hashes[i] > range.max) {
+      bucket_id = find_bucket(heap, pairs[i].key, &range);
+      if(bucket_id < 0) {
+        PRINTF("DB: No bucket for key %ld\n", (long)pairs[i].key);
+        return 0;
+      }
+    }
+
+    /* Learn the free slot of a bucket that has not been used since
+       the index was loaded. */
+    if(heap->next_free_slot[bucket_id] == 0 &&
+       bucket_load(heap, bucket_id) == NULL) {
+      return 0;
+    }
+
+    if(heap->next_free_slot[bucket_id] == BUCKET_SIZE) {
+      PRINTF("DB: Bucket %d is full\n", bucket_id);
+      if(bucket_split(heap, bucket_id) == 0) {
+        return 0;
+      }
+      /* Find the new bucket of the key in the next iteration. */
+      bucket_id = -1;
+      continue;
+    }
+
+    for(run = 1;
+        i + run < count &&
+        heap->next_free_slot[bucket_id] + run < BUCKET_SIZE &&
+        hashes[i + run] >= range.min && hashes[i + run] <= range.max;
+        run++);
+
+    offset = (unsigned long)bucket_id * sizeof(bucket_t);
+    offset += heap->next_free_slot[bucket_id] * sizeof(struct key_value_pair);
+    if(DB_ERROR(storage_write(heap->bucket_storage, &pairs[i], offset,
+                              run * sizeof(struct key_value_pair)))) {
+      return 0;
+    }
+
+    cache = get_cache(heap, bucket_id);
+    if(cache != NULL) {
+      memcpy(&cache->bucket.pairs[heap->next_free_slot[bucket_id]], &pairs[i],
+             run * sizeof(struct key_value_pair));
+    }
+    heap->next_free_slot[bucket_id] += run;
+
+    PRINTF("DB: Appended %u keys to bucket %d\n", run, bucket_id);
+  }
+
+  return 1;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 static db_result_t
 create(index_t *index)
 {
@@ -665,6 +813,41 @@ delete(index_t *index, attribute_value_t *value)
   return DB_INDEX_ERROR;
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+static db_result_t
+insert_rows(index_t *index, unsigned char *rows, unsigned count,
+            tuple_id_t tuple_id)
+{
+  struct key_value_pair pairs[BULK_BATCH];
+  maxheap_key_t hashes[BULK_BATCH];
+  attribute_value_t value;
+  unsigned batch;
+  unsigned i;
+
+  for(; count > 0; count -= batch) {
+    batch = MIN(count, BULK_BATCH);
+    for(i = 0; i < batch; i++) {
+      if(DB_ERROR(relation_get_value(index->rel, index->attr,
+                                     rows + i * index->rel->row_length,
+                                     &value))) {
+        return DB_INDEX_ERROR;
+      }
+      pairs[i].key = (maxheap_key_t)db_value_to_long(&value);
+      pairs[i].value = (maxheap_value_t)(tuple_id + i);
+      hashes[i] = transform_key(pairs[i].key);
+    }
+
+    if(insert_items((heap_t *)index->opaque_data, pairs, hashes, batch) == 0) {
+      PRINTF("DB: Failed to insert %u keys into a max-heap index\n", batch);
+      return DB_INDEX_ERROR;
+    }
+    rows += batch * index->rel->row_length;
+    tuple_id += batch;
+  }
+  return DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 static tuple_id_t
 get_next(index_iterator_t *iterator)
 {
@@ -736,6 +919,9 @@ get_next(index_iterator_t *iterator)
         }
       }
     }
+    /* The resume position belongs to this bucket only; the next
+       bucket on the path is searched from its start. */
+    cache.start = 0;
   }
 
   if(VALUE_INT(&iterator->min_value) == VALUE_INT(&iterator->max_value)) {
@@ -230,6 +230,31 @@ index_insert(index_t *index, attribute_value_t *value,
   return index->api->insert(index, value, tuple_id);
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t
+index_insert_rows(index_t *index, unsigned char *rows, unsigned count,
+                  tuple_id_t tuple_id)
+{
+  attribute_value_t value;
+  unsigned i;
+
+  if(index->api->insert_rows != NULL) {
+    return index->api->insert_rows(index, rows, count, tuple_id);
+  }
+
+  for(i = 0; i < count; i++) {
+    if(DB_ERROR(relation_get_value(index->rel, index->attr,
+                                   rows + i * index->rel->row_length,
+                                   &value)) ||
+       DB_ERROR(index->api->insert(index, &value, tuple_id + i))) {
+      return DB_INDEX_ERROR;
+    }
+  }
+
+  return DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 db_result_t
 index_delete(index_t *index, attribute_value_t *value)
 {
@@ -90,6 +90,10 @@ struct index_api {
   db_result_t (*insert)(index_t *, attribute_value_t *, tuple_id_t);
   db_result_t (*delete)(index_t *, attribute_value_t *);
   tuple_id_t (*get_next)(index_iterator_t *);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  /* Optional: insert the keys of consecutive rows starting at a tuple id. */
+  db_result_t (*insert_rows)(index_t *, unsigned char *, unsigned, tuple_id_t);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 };
 
 typedef struct index_api index_api_t;
@@ -104,6 +108,9 @@ db_result_t index_destroy(index_t *);
 db_result_t index_load(relation_t *, attribute_t *);
 db_result_t index_release(index_t *);
 db_result_t index_insert(index_t *, attribute_value_t *, tuple_id_t);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t index_insert_rows(index_t *, unsigned char *, unsigned, tuple_id_t);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 db_result_t index_delete(index_t *, attribute_value_t *);
 db_result_t index_get_iterator(index_iterator_t *, index_t *,
                                attribute_value_t *, attribute_value_t *);
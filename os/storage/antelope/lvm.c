@@ -754,6 +754,398 @@ lvm_get_derived_range(lvm_instance_t *p, char *name,
   return LVM_INVALID_IDENTIFIER;
 }
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+/*
+ * The plan compiler translates the prefix bytecode once per query into
+ * a flat postfix plan. Constant subexpressions are folded, comparisons
+ * of a variable with a constant become range tests, and range tests of
+ * the same variable under a conjunction are merged into one.
+ */
+
+/* Plan opcodes besides the operators, which are stored unchanged. */
+#define PLAN_CONST		1
+#define PLAN_VARIABLE		2
+#define PLAN_RANGE		3
+#define PLAN_NOT_RANGE		4
+
+static lvm_status_t
+plan_append(lvm_plan_t *plan, uint8_t op, variable_id_t id,
+            long min, long max)
+{
+  struct lvm_plan_step *step;
+
+  if(plan->count >= HCK_ANTELOPE_PLAN_STEPS) {
+    return LVM_STACK_OVERFLOW;
+  }
+
+  step = &plan->steps[plan->count++];
+  step->op = op;
+  step->id = id;
+  step->min = min;
+  step->max = max;
+  return LVM_TRUE;
+}
+
+/* Get the step that a subexpression compiled into, if it is only one. */
+static struct lvm_plan_step *
+single_step(lvm_plan_t *plan, uint8_t start, uint8_t end)
+{
+  return end - start == 1 ? &plan->steps[start] : NULL;
+}
+
+static int
+compare(operator_t op, long l1, long l2)
+{
+  switch(op) {
+  case LVM_EQ:
+    return l1 == l2;
+  case LVM_NEQ:
+    return l1 != l2;
+  case LVM_GE:
+    return l1 > l2;
+  case LVM_GEQ:
+    return l1 >= l2;
+  case LVM_LE:
+    return l1 < l2;
+  case LVM_LEQ:
+    return l1 <= l2;
+  default:
+    return -1;
+  }
+}
+
+static lvm_status_t
+compile_value(lvm_instance_t *p, lvm_plan_t *plan)
+{
+  node_type_t type;
+  operator_t op;
+  operand_t operand;
+  uint8_t start[2];
+  struct lvm_plan_step *a;
+  struct lvm_plan_step *b;
+  int i;
+  lvm_status_t r;
+
+  type = get_type(p);
+  if(type == LVM_OPERAND) {
+    get_operand(p, &operand);
+    if(operand.type == LVM_VARIABLE) {
+      if(operand.value.id >= LVM_MAX_VARIABLE_ID) {
+        return LVM_INVALID_IDENTIFIER;
+      }
+      return plan_append(plan, PLAN_VARIABLE, operand.value.id, 0, 0);
+    }
+    return plan_append(plan, PLAN_CONST, 0, operand_to_long(&operand), 0);
+  } else if(type != LVM_ARITH_OP) {
+    return LVM_SEMANTIC_ERROR;
+  }
+
+  op = *get_operator(p);
+  if(op != LVM_ADD && op != LVM_SUB && op != LVM_MUL && op != LVM_DIV) {
+    return LVM_EXECUTION_ERROR;
+  }
+
+  for(i = 0; i < 2; i++) {
+    start[i] = plan->count;
+    r = compile_value(p, plan);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+  }
+
+  a = single_step(plan, start[0], start[1]);
+  b = single_step(plan, start[1], plan->count);
+  if(a != NULL && b != NULL && a->op == PLAN_CONST && b->op == PLAN_CONST &&
+     !(op == LVM_DIV && b->min == 0)) {
+    switch(op) {
+    case LVM_ADD:
+      a->min += b->min;
+      break;
+    case LVM_SUB:
+      a->min -= b->min;
+      break;
+    case LVM_MUL:
+      a->min *= b->min;
+      break;
+    default:
+      a->min /= b->min;
+      break;
+    }
+    plan->count--;
+    return LVM_TRUE;
+  }
+
+  return plan_append(plan, op, 0, 0, 0);
+}
+
+static lvm_status_t
+compile_range(lvm_plan_t *plan, uint8_t start, operator_t op,
+              variable_id_t id, long value)
+{
+  uint8_t code;
+  long min;
+  long max;
+
+  code = PLAN_RANGE;
+  min = LONG_MIN;
+  max = LONG_MAX;
+
+  /* An empty range is expressed as min > max. */
+  switch(op) {
+  case LVM_NEQ:
+    code = PLAN_NOT_RANGE;
+    /* Fall through. */
+  case LVM_EQ:
+    min = max = value;
+    break;
+  case LVM_GE:
+    if(value == LONG_MAX) {
+      min = LONG_MAX;
+      max = LONG_MIN;
+    } else {
+      min = value + 1;
+    }
+    break;
+  case LVM_GEQ:
+    min = value;
+    break;
+  case LVM_LE:
+    if(value == LONG_MIN) {
+      min = LONG_MAX;
+      max = LONG_MIN;
+    } else {
+      max = value - 1;
+    }
+    break;
+  case LVM_LEQ:
+    max = value;
+    break;
+  default:
+    return LVM_EXECUTION_ERROR;
+  }
+
+  plan->count = start;
+  return plan_append(plan, code, id, min, max);
+}
+
+static lvm_status_t
+compile_comparison(lvm_instance_t *p, lvm_plan_t *plan, operator_t op)
+{
+  uint8_t start[2];
+  struct lvm_plan_step *a;
+  struct lvm_plan_step *b;
+  int i;
+  int result;
+  lvm_status_t r;
+
+  for(i = 0; i < 2; i++) {
+    start[i] = plan->count;
+    r = compile_value(p, plan);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+  }
+
+  if(compare(op, 0, 0) < 0) {
+    return LVM_EXECUTION_ERROR;
+  }
+
+  a = single_step(plan, start[0], start[1]);
+  b = single_step(plan, start[1], plan->count);
+  if(a != NULL && b != NULL) {
+    if(a->op == PLAN_CONST && b->op == PLAN_CONST) {
+      result = compare(op, a->min, b->min);
+      plan->count = start[0];
+      return plan_append(plan, PLAN_CONST, 0, result, 0);
+    } else if(a->op == PLAN_VARIABLE && b->op == PLAN_CONST) {
+      return compile_range(plan, start[0], op, a->id, b->min);
+    } else if(a->op == PLAN_CONST && b->op == PLAN_VARIABLE) {
+      /* Mirror the operator to put the variable on the left side. */
+      switch(op) {
+      case LVM_GE:
+        op = LVM_LE;
+        break;
+      case LVM_GEQ:
+        op = LVM_LEQ;
+        break;
+      case LVM_LE:
+        op = LVM_GE;
+        break;
+      case LVM_LEQ:
+        op = LVM_GEQ;
+        break;
+      default:
+        break;
+      }
+      return compile_range(plan, start[0], op, b->id, a->min);
+    }
+  }
+
+  return plan_append(plan, op, 0, 0, 0);
+}
+
+static lvm_status_t
+compile_logic(lvm_instance_t *p, lvm_plan_t *plan)
+{
+  operator_t op;
+  uint8_t start[2];
+  struct lvm_plan_step *a;
+  struct lvm_plan_step *b;
+  unsigned arguments;
+  int i;
+  lvm_status_t r;
+
+  if(get_type(p) != LVM_CMP_OP) {
+    return LVM_SEMANTIC_ERROR;
+  }
+
+  op = *get_operator(p);
+  if(!IS_CONNECTIVE(op)) {
+    return compile_comparison(p, plan, op);
+  }
+
+  arguments = op == LVM_NOT ? 1 : 2;
+  for(i = 0; i < arguments; i++) {
+    start[i] = plan->count;
+    r = compile_logic(p, plan);
+    if(LVM_ERROR(r)) {
+      return r;
+    }
+  }
+
+  if(op == LVM_NOT) {
+    a = single_step(plan, start[0], plan->count);
+    if(a != NULL && a->op == PLAN_RANGE) {
+      a->op = PLAN_NOT_RANGE;
+    } else if(a != NULL && a->op == PLAN_NOT_RANGE) {
+      a->op = PLAN_RANGE;
+    } else if(a != NULL && a->op == PLAN_CONST) {
+      a->min = !a->min;
+    } else {
+      return plan_append(plan, op, 0, 0, 0);
+    }
+    return LVM_TRUE;
+  } else if(op != LVM_AND && op != LVM_OR) {
+    return LVM_EXECUTION_ERROR;
+  }
+
+  a = single_step(plan, start[0], start[1]);
+  b = single_step(plan, start[1], plan->count);
+  if(a != NULL && b != NULL) {
+    if(a->op == PLAN_CONST && b->op == PLAN_CONST) {
+      a->min = op == LVM_AND ? a->min && b->min : a->min || b->min;
+      plan->count--;
+      return LVM_TRUE;
+    } else if(op == LVM_AND && a->op == PLAN_RANGE &&
+              b->op == PLAN_RANGE && a->id == b->id) {
+      /* Intersect the ranges of the same variable. */
+      if(b->min > a->min) {
+        a->min = b->min;
+      }
+      if(b->max < a->max) {
+        a->max = b->max;
+      }
+      plan->count--;
+      return LVM_TRUE;
+    }
+  }
+
+  return plan_append(plan, op, 0, 0, 0);
+}
+
+lvm_status_t
+lvm_compile(lvm_instance_t *p, lvm_plan_t *plan)
+{
+  lvm_status_t status;
+
+  p->ip = 0;
+  plan->count = 0;
+  status = compile_logic(p, plan);
+  PRINTF("Compiled the predicate into %u plan steps (status %d)\n",
+         (unsigned)plan->count, (int)status);
+  return LVM_ERROR(status) ? status : LVM_TRUE;
+}
+
+lvm_status_t
+lvm_plan_execute(const lvm_plan_t *plan, const long *values)
+{
+  const struct lvm_plan_step *step;
+  const struct lvm_plan_step *end;
+  long stack[HCK_ANTELOPE_PLAN_STEPS];
+  long *top;
+  long v;
+
+  top = stack;
+  end = plan->steps + plan->count;
+  for(step = plan->steps; step < end; step++) {
+    switch(step->op) {
+    case PLAN_CONST:
+      *top++ = step->min;
+      continue;
+    case PLAN_VARIABLE:
+      *top++ = values[step->id];
+      continue;
+    case PLAN_RANGE:
+      v = values[step->id];
+      *top++ = v >= step->min && v <= step->max;
+      continue;
+    case PLAN_NOT_RANGE:
+      v = values[step->id];
+      *top++ = v < step->min || v > step->max;
+      continue;
+    case LVM_NOT:
+      top[-1] = !top[-1];
+      continue;
+    default:
+      break;
+    }
+
+    /* Binary operator on the two topmost values. */
+    v = *--top;
+    switch(step->op) {
+    case LVM_ADD:
+      top[-1] += v;
+      break;
+    case LVM_SUB:
+      top[-1] -= v;
+      break;
+    case LVM_MUL:
+      top[-1] *= v;
+      break;
+    case LVM_DIV:
+      if(v == 0) {
+        return LVM_MATH_ERROR;
+      }
+      top[-1] /= v;
+      break;
+    case LVM_AND:
+      top[-1] = top[-1] && v;
+      break;
+    case LVM_OR:
+      top[-1] = top[-1] || v;
+      break;
+    default:
+      top[-1] = compare(step->op, top[-1], v);
+      break;
+    }
+  }
+
+  return stack[0] ? LVM_TRUE : LVM_FALSE;
+}
+
+variable_id_t
+lvm_get_variable_id(char *name)
+{
+  variable_id_t id;
+
+  id = lookup(name);
+  if(id < LVM_MAX_VARIABLE_ID && variables[id].name[0] == '\0') {
+    return LVM_MAX_VARIABLE_ID;
+  }
+  return id;
+}
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
 #if DEBUG
 static lvm_ip_t
 print_operator(lvm_instance_t *p, lvm_ip_t index)
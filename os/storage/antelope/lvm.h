@@ -141,4 +141,33 @@ lvm_status_t lvm_set_operand(lvm_instance_t *p, operand_t *op);
 lvm_status_t lvm_set_long(lvm_instance_t *p, long l);
 lvm_status_t lvm_set_variable(lvm_instance_t *p, char *name);
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+#ifdef HCK_ANTELOPE_PLAN_CONF_STEPS
+#define HCK_ANTELOPE_PLAN_STEPS HCK_ANTELOPE_PLAN_CONF_STEPS
+#else
+#define HCK_ANTELOPE_PLAN_STEPS 16
+#endif
+
+/* One step of a compiled predicate. Steps are stored in postfix order
+   and evaluated on a small value stack. A range step tests a single
+   variable against constant bounds, and replaces a comparison node
+   together with its operands. */
+struct lvm_plan_step {
+  uint8_t op;
+  variable_id_t id;
+  long min;
+  long max;
+};
+
+struct lvm_plan {
+  struct lvm_plan_step steps[HCK_ANTELOPE_PLAN_STEPS];
+  uint8_t count;
+};
+typedef struct lvm_plan lvm_plan_t;
+
+lvm_status_t lvm_compile(lvm_instance_t *p, lvm_plan_t *plan);
+lvm_status_t lvm_plan_execute(const lvm_plan_t *plan, const long *values);
+variable_id_t lvm_get_variable_id(char *name);
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
 #endif /* LVM_H */
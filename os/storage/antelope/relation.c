@@ -37,6 +37,7 @@
 #include <limits.h>
 #include <string.h>
 
+#include "cfs/cfs.h"
 #include "lib/crc16.h"
 #include "lib/list.h"
 #include "lib/memb.h"
@@ -79,6 +80,103 @@ struct source_map {
 };
 
 static struct source_map source_map[AQL_ATTRIBUTE_LIMIT];
+
+#if HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
+/*
+ * Joins on attributes without an index use a hash join, or a merge
+ * join when both relations are already sorted on the join attribute.
+ * The hash table holds at most HCK_ANTELOPE_JOIN_HASH_ENTRIES keys of
+ * the right relation. A larger right relation is partitioned on the
+ * key hash into CFS spill files, and partitions that still do not fit
+ * are joined in chunks.
+ */
+#ifdef HCK_ANTELOPE_JOIN_CONF_HASH_ENTRIES
+#define HCK_ANTELOPE_JOIN_HASH_ENTRIES HCK_ANTELOPE_JOIN_CONF_HASH_ENTRIES
+#else
+#define HCK_ANTELOPE_JOIN_HASH_ENTRIES 64
+#endif
+
+#ifdef HCK_ANTELOPE_JOIN_CONF_HASH_BUCKETS
+#define HCK_ANTELOPE_JOIN_HASH_BUCKETS HCK_ANTELOPE_JOIN_CONF_HASH_BUCKETS
+#else
+#define HCK_ANTELOPE_JOIN_HASH_BUCKETS 16
+#endif
+
+#ifdef HCK_ANTELOPE_JOIN_CONF_MAX_PARTITIONS
+#define HCK_ANTELOPE_JOIN_MAX_PARTITIONS HCK_ANTELOPE_JOIN_CONF_MAX_PARTITIONS
+#else
+#define HCK_ANTELOPE_JOIN_MAX_PARTITIONS 8
+#endif
+
+#if (HCK_ANTELOPE_JOIN_HASH_BUCKETS & (HCK_ANTELOPE_JOIN_HASH_BUCKETS - 1)) != 0
+#error "HCK_ANTELOPE_JOIN_HASH_BUCKETS must be a power of two"
+#endif
+
+/* Multiplicative hashing; buckets and partitions use different bits. */
+#define JOIN_HASH(key)      ((uint32_t)((uint32_t)(key) * 2654435761UL) >> 16)
+#define JOIN_BUCKET(key)    (JOIN_HASH(key) & (HCK_ANTELOPE_JOIN_HASH_BUCKETS - 1))
+#define JOIN_PARTITION(key) ((JOIN_HASH(key) >> 8) % join_partitions)
+#define HASH_NONE           0xffff
+
+enum join_method {
+  JOIN_INDEX,
+  JOIN_MERGE,
+  JOIN_HASH
+};
+
+/* A join key and the tuple it came from, as stored in the spill files. */
+struct join_record {
+  long key;
+  tuple_id_t tuple_id;
+};
+
+struct hash_entry {
+  long key;
+  tuple_id_t tuple_id;
+  uint16_t next;
+};
+
+/*
+ * A stream of join records, read either from a relation or from a
+ * partition of a spill file.
+ */
+struct join_source {
+  relation_t *rel;
+  attribute_t *attr;
+  unsigned char *row;
+  db_storage_id_t fd;
+  tuple_id_t start;
+  tuple_id_t end;
+  tuple_id_t next;
+};
+
+static uint8_t join_method;
+
+static struct hash_entry hash_entries[HCK_ANTELOPE_JOIN_HASH_ENTRIES];
+static uint16_t hash_buckets[HCK_ANTELOPE_JOIN_HASH_BUCKETS];
+static uint16_t hash_count;
+static uint16_t probe_entry;
+static struct join_record probe;
+
+static struct join_source join_left;
+static struct join_source join_right;
+static uint8_t join_right_done;
+static uint8_t join_partitions;
+static uint8_t join_partition;
+static tuple_id_t join_left_loaded;
+
+/* Spill files of the left (0) and the right (1) relation. */
+static char spill_file[2][ATTRIBUTE_NAME_LENGTH + sizeof(".ffff")];
+static db_storage_id_t spill_fd[2] = { -1, -1 };
+static tuple_id_t spill_start[2][HCK_ANTELOPE_JOIN_MAX_PARTITIONS + 1];
+
+static long merge_left_key;
+static long merge_right_key;
+static tuple_id_t merge_left_tid;
+static tuple_id_t merge_right_tid;
+static tuple_id_t merge_pos;
+static uint8_t merge_in_group;
+#endif /* HCK_MOD_ANTELOPE_JOIN_ALGORITHMS */
 #endif /* DB_FEATURE_JOIN */
 
 static unsigned char row[DB_MAX_ATTRIBUTES_PER_RELATION * DB_MAX_ELEMENT_SIZE];
@@ -88,6 +186,62 @@ static unsigned char * const left_row = row;
 static unsigned char * const right_row = extra_row;
 static unsigned char * const join_row = result_row;
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+#ifdef HCK_ANTELOPE_SELECT_CONF_BATCH_SIZE
+#define HCK_ANTELOPE_SELECT_BATCH_SIZE HCK_ANTELOPE_SELECT_CONF_BATCH_SIZE
+#else
+#define HCK_ANTELOPE_SELECT_BATCH_SIZE 256
+#endif
+
+/* An attribute read by the compiled predicate, decoded directly from
+   its offset in the stored row. */
+struct plan_variable {
+  unsigned offset;
+  domain_t domain;
+  variable_id_t id;
+};
+
+static lvm_plan_t select_plan;
+static uint8_t select_compiled;
+static struct plan_variable plan_variables[LVM_MAX_VARIABLE_ID];
+static uint8_t plan_variable_count;
+static long plan_values[LVM_MAX_VARIABLE_ID];
+
+/* Selections without an index filter a page of rows per call. */
+static unsigned char select_batch[HCK_ANTELOPE_SELECT_BATCH_SIZE];
+static unsigned select_batch_capacity;
+static unsigned select_batch_rows;
+static unsigned select_batch_pos;
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+#ifdef HCK_ANTELOPE_BULK_CONF_BUFFER_SIZE
+#define HCK_ANTELOPE_BULK_BUFFER_SIZE HCK_ANTELOPE_BULK_CONF_BUFFER_SIZE
+#else
+#define HCK_ANTELOPE_BULK_BUFFER_SIZE 256
+#endif
+
+/*
+ * Rows inserted into the bulk relation are collected in RAM and
+ * appended to its tuple file one chunk at a time, after which the
+ * indexes of the relation are updated for the whole chunk.
+ *
+ * Crash consistency: rows that are still in the buffer are lost on a
+ * reset, so callers bound the loss by calling relation_bulk_flush()
+ * as often as needed. A chunk is appended with a single write; a write
+ * cut short leaves at most one partial row at the end of the file,
+ * which is not counted as a tuple. The rows are written before the
+ * index entries that refer to them, so a reset in between can leave
+ * the rows of the last chunk out of an external (e.g., max-heap)
+ * index, but an index never points to rows that do not exist. Inline
+ * indexes consist of the rows themselves and are always consistent.
+ */
+static relation_t *bulk_rel;
+static unsigned char bulk_buffer[HCK_ANTELOPE_BULK_BUFFER_SIZE];
+static unsigned bulk_rows;
+static tuple_id_t bulk_first_row;
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 LIST(relations);
 MEMB(relations_memb, relation_t, DB_RELATION_POOL_SIZE);
 MEMB(attributes_memb, attribute_t, DB_ATTRIBUTE_POOL_SIZE);
@@ -231,6 +385,12 @@ relation_load(char *name)
   rel = relation_find(name);
   if(rel != NULL) {
     rel->references++;
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+    if(rel == bulk_rel) {
+      /* The tuple file is kept open during the bulk insertion. */
+      return rel;
+    }
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
     goto end;
   }
 
@@ -533,6 +693,12 @@ relation_insert(relation_t *rel, attribute_value_t *values)
 #endif /* DEBUG */
 
     ptr += attr->element_size;
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+    if(rel == bulk_rel) {
+      /* The indexes are updated when the rows are flushed. */
+      continue;
+    }
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
     if(attr->index != NULL) {
       if(DB_ERROR(index_insert(attr->index, value, rel->next_row))) {
         return DB_INDEX_ERROR;
@@ -542,11 +708,115 @@ relation_insert(relation_t *rel, attribute_value_t *values)
 
   PRINTF(")\n");
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+  if(rel == bulk_rel) {
+    if(bulk_rows == 0) {
+      bulk_first_row = rel->next_row;
+    }
+    memcpy(bulk_buffer + bulk_rows * rel->row_length, record, rel->row_length);
+    bulk_rows++;
+    rel->cardinality++;
+    rel->next_row++;
+    if((bulk_rows + 1) * rel->row_length > sizeof(bulk_buffer)) {
+      return relation_bulk_flush();
+    }
+    return DB_OK;
+  }
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
   rel->cardinality++;
   rel->next_row++;
   return storage_put_row(rel, record);
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t
+relation_bulk_begin(char *name)
+{
+  relation_t *rel;
+
+  if(bulk_rel != NULL) {
+    return DB_BUSY_ERROR;
+  }
+
+  /* The reference is held until the end of the bulk insertion, so the
+     tuple file stays open between the insertions. */
+  rel = relation_load(name);
+  if(rel == NULL) {
+    return DB_NAME_ERROR;
+  }
+
+  if(rel->dir != DB_STORAGE || rel->row_length == 0 ||
+     rel->row_length > sizeof(bulk_buffer)) {
+    relation_release(rel);
+    return DB_LIMIT_ERROR;
+  }
+
+  bulk_rel = rel;
+  bulk_rows = 0;
+
+  return DB_OK;
+}
+
+db_result_t
+relation_bulk_flush(void)
+{
+  attribute_t *attr;
+  db_result_t result;
+
+  if(bulk_rel == NULL || bulk_rows == 0) {
+    return DB_OK;
+  }
+
+  result = storage_put_rows(bulk_rel, bulk_buffer, bulk_rows);
+  if(DB_ERROR(result)) {
+    PRINTF("DB: Failed to append %u rows to relation %s\n",
+           bulk_rows, bulk_rel->name);
+    /* Count the rows that made it to storage again, and give the next
+       row the first tuple ID of the discarded ones. */
+    bulk_rel->cardinality = INVALID_TUPLE;
+    bulk_rel->next_row = bulk_first_row;
+    bulk_rows = 0;
+    return result;
+  }
+
+  for(attr = list_head(bulk_rel->attributes); attr != NULL; attr = attr->next) {
+    if(attr->index != NULL &&
+       DB_ERROR(index_insert_rows(attr->index, bulk_buffer, bulk_rows,
+                                  bulk_first_row))) {
+      result = DB_INDEX_ERROR;
+    }
+  }
+
+  PRINTF("DB: Flushed %u rows into relation %s\n", bulk_rows, bulk_rel->name);
+  bulk_rows = 0;
+
+  return result;
+}
+
+db_result_t
+relation_bulk_end(void)
+{
+  db_result_t result;
+
+  if(bulk_rel == NULL) {
+    return DB_OK;
+  }
+
+  result = relation_bulk_flush();
+  relation_release(bulk_rel);
+  bulk_rel = NULL;
+
+  return result;
+}
+
+relation_t *
+relation_bulk_get(void)
+{
+  return bulk_rel;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 static void
 aggregate(attribute_t *attr, attribute_value_t *value)
 {
@@ -671,6 +941,126 @@ select_index(db_handle_t *handle, lvm_instance_t *lvm_instance)
   }
 }
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+static void
+compile_selection(db_handle_t *handle, aql_adt_t *adt)
+{
+  struct source_dest_map *attr_map_ptr;
+  struct source_dest_map *attr_map_end;
+  attribute_t *attr;
+  variable_id_t id;
+
+  select_compiled = 0;
+  select_batch_rows = 0;
+  select_batch_pos = 0;
+  select_batch_capacity = 0;
+  if(handle->rel->row_length > 0) {
+    select_batch_capacity = HCK_ANTELOPE_SELECT_BATCH_SIZE /
+                            handle->rel->row_length;
+  }
+
+  if(adt->lvm_instance != NULL &&
+     LVM_ERROR(lvm_compile(adt->lvm_instance, &select_plan))) {
+    PRINTF("DB: Unable to compile the predicate; interpreting it instead\n");
+    return;
+  }
+
+  /* Resolve the row offsets of the variables in the predicate. */
+  plan_variable_count = 0;
+  memset(plan_values, 0, sizeof(plan_values));
+  attr_map_end = attr_map + handle->result_rel->attribute_count;
+  for(attr_map_ptr = attr_map;
+      attr_map_ptr < attr_map_end && plan_variable_count < LVM_MAX_VARIABLE_ID;
+      attr_map_ptr++) {
+    attr = attr_map_ptr->to_attr;
+    if(attr->domain != DOMAIN_INT && attr->domain != DOMAIN_LONG) {
+      continue;
+    }
+    id = lvm_get_variable_id(attr->name);
+    if(id < LVM_MAX_VARIABLE_ID) {
+      plan_variables[plan_variable_count].offset = attr_map_ptr->from_offset;
+      plan_variables[plan_variable_count].domain = attr->domain;
+      plan_variables[plan_variable_count].id = id;
+      plan_variable_count++;
+    }
+  }
+
+  select_compiled = 1;
+}
+
+static lvm_status_t
+execute_plan(const unsigned char *tuple)
+{
+  struct plan_variable *var;
+  const unsigned char *ptr;
+
+  for(var = plan_variables; var < plan_variables + plan_variable_count; var++) {
+    ptr = tuple + var->offset;
+    if(var->domain == DOMAIN_INT) {
+      plan_values[var->id] = ptr[0] << 8 | ptr[1];
+    } else {
+      plan_values[var->id] = (uint32_t)ptr[0] << 24 |
+                             (uint32_t)ptr[1] << 16 |
+                             (uint32_t)ptr[2] << 8 |
+                             ptr[3];
+    }
+  }
+
+  return lvm_plan_execute(&select_plan, plan_values);
+}
+
+/* Read tuples until one satisfies the predicate, and copy it into the
+   row buffer. Returns DB_OK if none did in the tuple or page read. */
+static db_result_t
+read_selected_row(db_handle_t *handle, aql_adt_t *adt)
+{
+  db_result_t result;
+  lvm_status_t wanted_result;
+  unsigned char *tuple;
+
+  wanted_result = LVM_TRUE;
+  if(AQL_GET_FLAGS(adt) & AQL_FLAG_INVERSE_LOGIC) {
+    wanted_result = LVM_FALSE;
+  }
+
+  if((handle->flags & DB_HANDLE_FLAG_SEARCH_INDEX) ||
+     select_batch_capacity == 0) {
+    result = storage_get_row(handle->rel, &handle->tuple_id, row);
+    handle->tuple_id++;
+    if(result != DB_OK) {
+      return result;
+    }
+    if(adt->lvm_instance == NULL || execute_plan(row) == wanted_result) {
+      return DB_GOT_ROW;
+    }
+    return DB_OK;
+  }
+
+  if(select_batch_pos == select_batch_rows) {
+    select_batch_pos = 0;
+    select_batch_rows = select_batch_capacity;
+    result = storage_get_rows(handle->rel, handle->tuple_id, select_batch,
+                              &select_batch_rows);
+    if(result != DB_OK) {
+      select_batch_rows = 0;
+      return result;
+    }
+  }
+
+  while(select_batch_pos < select_batch_rows) {
+    tuple = select_batch + select_batch_pos * handle->rel->row_length;
+    select_batch_pos++;
+    handle->tuple_id++;
+    if(adt->lvm_instance == NULL || execute_plan(tuple) == wanted_result) {
+      memcpy(row, tuple, handle->rel->row_length);
+      return DB_GOT_ROW;
+    }
+  }
+
+  return DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
 static db_result_t
 generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
 {
@@ -703,6 +1093,10 @@ generate_selection_result(db_handle_t *handle, relation_t *rel, aql_adt_t *adt)
     }
   }
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+  compile_selection(handle, adt);
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
   handle->flags |= DB_HANDLE_FLAG_PROCESSING;
 
   return DB_OK;
@@ -771,8 +1165,20 @@ relation_process_select(void *handle_ptr)
 
   /* Put the tuples fulfilling the given condition into a new relation.
      The tuples may be projected. */
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+  if(select_compiled) {
+    result = read_selected_row(handle, adt);
+    if(result == DB_OK) {
+      return DB_OK;
+    }
+  } else {
+    result = storage_get_row(handle->rel, &handle->tuple_id, row);
+    handle->tuple_id++;
+  }
+#else
   result = storage_get_row(handle->rel, &handle->tuple_id, row);
   handle->tuple_id++;
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
   if(DB_ERROR(result)) {
     PRINTF("DB: Failed to get a row in relation %s!\n", handle->rel->name);
     return result;
@@ -788,6 +1194,11 @@ relation_process_select(void *handle_ptr)
     from_ptr = row + attr_map_ptr->from_offset;
     result_attr = attr_map_ptr->to_attr;
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+    if(select_compiled) {
+      /* The predicate has already been evaluated on the stored row. */
+    } else
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
     /* Update the internal state of the PLE. */
     if(result_attr->domain == DOMAIN_INT) {
       operand_value.l = from_ptr[0] << 8 | from_ptr[1];
@@ -820,6 +1231,9 @@ relation_process_select(void *handle_ptr)
 
   /* Check whether the given predicate is true for this tuple. */
   if(adt->lvm_instance == NULL ||
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+     select_compiled ||
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
      lvm_execute(adt->lvm_instance) == wanted_result) {
     if(AQL_GET_FLAGS(adt) & AQL_FLAG_AGGREGATE) {
       for(attr_map_ptr = attr_map; attr_map_ptr < attr_map_end; attr_map_ptr++) {
@@ -959,6 +1373,465 @@ relation_select(void *handle_ptr, relation_t *rel, void *adt_ptr)
 }
 
 #if DB_FEATURE_JOIN
+static db_result_t
+emit_join_row(db_handle_t *handle)
+{
+  relation_t *join_rel;
+  unsigned char *join_next_attribute_ptr;
+  size_t element_size;
+  int i;
+
+  join_rel = handle->join_rel;
+
+  /* Use the source attribute map to fill in the physical representation
+     of the resulting tuple. */
+  join_next_attribute_ptr = join_row;
+
+  for(i = 0; i < join_rel->attribute_count; i++) {
+    element_size = source_map[i].attr->element_size;
+
+    memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
+    join_next_attribute_ptr += element_size;
+  }
+
+  if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
+    if(DB_ERROR(storage_put_row(join_rel, join_row))) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  handle->current_row++;
+  return DB_GOT_ROW;
+}
+
+#if HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
+static db_result_t
+read_join_key(relation_t *rel, attribute_t *attr, unsigned char *row_ptr,
+              tuple_id_t tuple_id, long *key)
+{
+  db_result_t result;
+  attribute_value_t value;
+
+  result = storage_get_row(rel, &tuple_id, row_ptr);
+  if(result != DB_OK) {
+    return result;
+  }
+
+  if(DB_ERROR(relation_get_value(rel, attr, row_ptr, &value))) {
+    return DB_IMPLEMENTATION_ERROR;
+  }
+  *key = db_value_to_long(&value);
+
+  return DB_OK;
+}
+
+static void
+source_init(struct join_source *source, relation_t *rel, attribute_t *attr,
+            unsigned char *row_ptr)
+{
+  source->rel = rel;
+  source->attr = attr;
+  source->row = row_ptr;
+  source->fd = -1;
+  source->start = source->next = 0;
+  source->end = INVALID_TUPLE;
+}
+
+static db_result_t
+source_next(struct join_source *source, struct join_record *record)
+{
+  db_result_t result;
+
+  if(source->fd < 0) {
+    result = read_join_key(source->rel, source->attr, source->row,
+                           source->next, &record->key);
+    if(result != DB_OK) {
+      return result;
+    }
+    record->tuple_id = source->next++;
+    if(source->row == left_row) {
+      join_left_loaded = record->tuple_id;
+    }
+    return DB_OK;
+  }
+
+  if(source->next >= source->end) {
+    return DB_FINISHED;
+  }
+  result = storage_read(source->fd, record,
+                        (unsigned long)source->next * sizeof(*record),
+                        sizeof(*record));
+  source->next++;
+  return result;
+}
+
+static void
+join_cleanup(void)
+{
+  int i;
+
+  for(i = 0; i < 2; i++) {
+    if(spill_fd[i] >= 0) {
+      storage_close(spill_fd[i]);
+      cfs_remove(spill_file[i]);
+      spill_fd[i] = -1;
+    }
+  }
+}
+
+/* Write the join records of a relation grouped by partition. */
+static db_result_t
+spill_relation(int side, struct join_source *source)
+{
+  tuple_id_t cursor[HCK_ANTELOPE_JOIN_MAX_PARTITIONS];
+  struct join_record record;
+  db_result_t result;
+  char *filename;
+  int i;
+
+  /* The first pass counts the records of each partition. */
+  memset(cursor, 0, sizeof(cursor));
+  for(source->next = 0;;) {
+    result = source_next(source, &record);
+    if(result != DB_OK) {
+      break;
+    }
+    cursor[JOIN_PARTITION(record.key)]++;
+  }
+  if(DB_ERROR(result)) {
+    return result;
+  }
+
+  spill_start[side][0] = 0;
+  for(i = 0; i < join_partitions; i++) {
+    spill_start[side][i + 1] = spill_start[side][i] + cursor[i];
+    cursor[i] = spill_start[side][i];
+  }
+
+  filename = storage_generate_file("join", (unsigned long)sizeof(record) *
+                                   spill_start[side][join_partitions]);
+  if(filename == NULL) {
+    return DB_STORAGE_ERROR;
+  }
+  strcpy(spill_file[side], filename);
+  spill_fd[side] = storage_open(spill_file[side]);
+  if(spill_fd[side] < 0) {
+    cfs_remove(spill_file[side]);
+    return DB_STORAGE_ERROR;
+  }
+
+  /* The second pass writes each record in the area of its partition. */
+  for(source->next = 0;;) {
+    result = source_next(source, &record);
+    if(result != DB_OK) {
+      break;
+    }
+    i = JOIN_PARTITION(record.key);
+    if(DB_ERROR(storage_write(spill_fd[side], &record,
+                              (unsigned long)cursor[i]++ * sizeof(record),
+                              sizeof(record)))) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+
+  source->fd = spill_fd[side];
+  return DB_ERROR(result) ? result : DB_OK;
+}
+
+static void
+open_partition(uint8_t partition)
+{
+  if(join_partitions > 1) {
+    join_left.start = spill_start[0][partition];
+    join_left.end = spill_start[0][partition + 1];
+    join_right.start = spill_start[1][partition];
+    join_right.end = spill_start[1][partition + 1];
+  }
+  join_left.next = join_left.start;
+  join_right.next = join_right.start;
+  join_right_done = 0;
+  hash_count = 0;
+  probe_entry = HASH_NONE;
+}
+
+/* Load the next chunk of the right side of the partition in the table. */
+static db_result_t
+build_hash_chunk(void)
+{
+  struct join_record record;
+  struct hash_entry *entry;
+  db_result_t result;
+  uint16_t bucket;
+
+  memset(hash_buckets, 0xff, sizeof(hash_buckets));
+  for(hash_count = 0; hash_count < HCK_ANTELOPE_JOIN_HASH_ENTRIES;) {
+    result = source_next(&join_right, &record);
+    if(result == DB_FINISHED) {
+      join_right_done = 1;
+      break;
+    } else if(DB_ERROR(result)) {
+      return result;
+    }
+
+    entry = &hash_entries[hash_count];
+    entry->key = record.key;
+    entry->tuple_id = record.tuple_id;
+    bucket = JOIN_BUCKET(record.key);
+    entry->next = hash_buckets[bucket];
+    hash_buckets[bucket] = hash_count++;
+  }
+  if(hash_count == HCK_ANTELOPE_JOIN_HASH_ENTRIES &&
+     join_right.next >= join_right.end) {
+    join_right_done = 1;
+  }
+
+  return DB_OK;
+}
+
+static db_result_t
+setup_hash_join(db_handle_t *handle)
+{
+  tuple_id_t cardinality;
+  db_result_t result;
+
+  source_init(&join_left, handle->left_rel, handle->left_join_attr, left_row);
+  source_init(&join_right, handle->right_rel, handle->right_join_attr,
+              right_row);
+  join_left_loaded = INVALID_TUPLE;
+
+  cardinality = relation_cardinality(handle->right_rel);
+  if(cardinality == INVALID_TUPLE) {
+    return DB_STORAGE_ERROR;
+  }
+  cardinality = (cardinality + HCK_ANTELOPE_JOIN_HASH_ENTRIES - 1) /
+                HCK_ANTELOPE_JOIN_HASH_ENTRIES;
+  join_partitions = cardinality > HCK_ANTELOPE_JOIN_MAX_PARTITIONS ?
+                    HCK_ANTELOPE_JOIN_MAX_PARTITIONS : cardinality;
+  if(join_partitions == 0) {
+    join_partitions = 1;
+  }
+
+  if(join_partitions > 1) {
+    PRINTF("DB: Spilling the hash join into %u partitions\n",
+           (unsigned)join_partitions);
+    result = spill_relation(0, &join_left);
+    if(!DB_ERROR(result)) {
+      result = spill_relation(1, &join_right);
+    }
+    if(DB_ERROR(result)) {
+      join_cleanup();
+      return result;
+    }
+  }
+
+  join_partition = 0;
+  open_partition(0);
+
+  return DB_OK;
+}
+
+static db_result_t
+emit_tuples(db_handle_t *handle, tuple_id_t left_id, tuple_id_t right_id)
+{
+  if(left_id != join_left_loaded) {
+    if(storage_get_row(handle->left_rel, &left_id, left_row) != DB_OK) {
+      return DB_STORAGE_ERROR;
+    }
+    join_left_loaded = left_id;
+  }
+  if(storage_get_row(handle->right_rel, &right_id, right_row) != DB_OK) {
+    return DB_STORAGE_ERROR;
+  }
+
+  return emit_join_row(handle);
+}
+
+static db_result_t
+process_hash_join(db_handle_t *handle)
+{
+  struct hash_entry *entry;
+  db_result_t result;
+
+  for(;;) {
+    while(probe_entry != HASH_NONE) {
+      entry = &hash_entries[probe_entry];
+      probe_entry = entry->next;
+      if(entry->key == probe.key) {
+        return emit_tuples(handle, probe.tuple_id, entry->tuple_id);
+      }
+    }
+
+    if(hash_count > 0) {
+      result = source_next(&join_left, &probe);
+      if(result == DB_OK) {
+        probe_entry = hash_buckets[JOIN_BUCKET(probe.key)];
+        continue;
+      } else if(DB_ERROR(result)) {
+        join_cleanup();
+        return result;
+      }
+    }
+
+    /* The left side has been probed against the whole chunk. */
+    if(join_right_done) {
+      if(++join_partition >= join_partitions) {
+        join_cleanup();
+        return DB_FINISHED;
+      }
+      open_partition(join_partition);
+    }
+
+    result = build_hash_chunk();
+    if(DB_ERROR(result)) {
+      join_cleanup();
+      return result;
+    }
+    join_left.next = join_left.start;
+  }
+}
+
+static db_result_t
+setup_merge_join(db_handle_t *handle)
+{
+  db_result_t result;
+
+  merge_in_group = 0;
+  merge_left_tid = merge_right_tid = 0;
+  result = read_join_key(handle->left_rel, handle->left_join_attr, left_row,
+                         0, &merge_left_key);
+  if(result == DB_OK) {
+    result = read_join_key(handle->right_rel, handle->right_join_attr,
+                           right_row, 0, &merge_right_key);
+  }
+  if(result == DB_FINISHED) {
+    /* An empty relation; the first process call finishes the join. */
+    merge_left_tid = INVALID_TUPLE;
+    return DB_OK;
+  }
+  return result;
+}
+
+static db_result_t
+process_merge_join(db_handle_t *handle)
+{
+  db_result_t result;
+  long key;
+
+  if(merge_left_tid == INVALID_TUPLE) {
+    return DB_FINISHED;
+  }
+
+  for(;;) {
+    if(merge_in_group) {
+      /* Pair the current left tuple with each right tuple of the group. */
+      result = read_join_key(handle->right_rel, handle->right_join_attr,
+                             right_row, merge_pos, &key);
+      if(DB_ERROR(result)) {
+        return result;
+      } else if(result == DB_OK && key == merge_left_key) {
+        merge_pos++;
+        return emit_join_row(handle);
+      }
+
+      merge_in_group = 0;
+      result = read_join_key(handle->left_rel, handle->left_join_attr,
+                             left_row, ++merge_left_tid, &merge_left_key);
+      if(result != DB_OK) {
+        return result;
+      }
+      if(merge_left_key == merge_right_key) {
+        merge_in_group = 1;
+        merge_pos = merge_right_tid;
+      }
+      continue;
+    }
+
+    if(merge_left_key < merge_right_key) {
+      result = read_join_key(handle->left_rel, handle->left_join_attr,
+                             left_row, ++merge_left_tid, &merge_left_key);
+    } else if(merge_right_key < merge_left_key) {
+      result = read_join_key(handle->right_rel, handle->right_join_attr,
+                             right_row, ++merge_right_tid, &merge_right_key);
+    } else {
+      merge_in_group = 1;
+      merge_pos = merge_right_tid;
+      continue;
+    }
+    if(result != DB_OK) {
+      return result;
+    }
+  }
+}
+
+static db_result_t
+is_sorted(relation_t *rel, attribute_t *attr, unsigned char *row_ptr)
+{
+  tuple_id_t tuple_id;
+  db_result_t result;
+  long previous;
+  long key;
+
+  previous = LONG_MIN;
+  for(tuple_id = 0;; tuple_id++) {
+    result = read_join_key(rel, attr, row_ptr, tuple_id, &key);
+    if(result == DB_FINISHED) {
+      return DB_OK;
+    } else if(DB_ERROR(result)) {
+      return result;
+    }
+    if(key < previous) {
+      return DB_FINISHED;
+    }
+    previous = key;
+  }
+}
+
+/*
+ * Choose the join algorithm in the spirit of select_index(): an index
+ * on the right join attribute is used when it exists; otherwise a
+ * merge join is used if both relations are sorted on the join
+ * attribute, and a hash join if not.
+ */
+static db_result_t
+plan_join(db_handle_t *handle)
+{
+  db_result_t result;
+
+  join_cleanup();
+
+  if(index_exists(handle->right_join_attr)) {
+    join_method = JOIN_INDEX;
+    return DB_OK;
+  }
+
+  if((handle->left_join_attr->domain != DOMAIN_INT &&
+      handle->left_join_attr->domain != DOMAIN_LONG) ||
+     (handle->right_join_attr->domain != DOMAIN_INT &&
+      handle->right_join_attr->domain != DOMAIN_LONG)) {
+    PRINTF("DB: Only integer attributes can be joined without an index\n");
+    return DB_INDEX_ERROR;
+  }
+
+  result = is_sorted(handle->left_rel, handle->left_join_attr, left_row);
+  if(result == DB_OK) {
+    result = is_sorted(handle->right_rel, handle->right_join_attr, right_row);
+  }
+  if(DB_ERROR(result)) {
+    return result;
+  }
+
+  if(result == DB_OK) {
+    PRINTF("DB: Merge join of sorted relations\n");
+    join_method = JOIN_MERGE;
+    return setup_merge_join(handle);
+  }
+
+  PRINTF("DB: Hash join\n");
+  join_method = JOIN_HASH;
+  return setup_hash_join(handle);
+}
+#endif /* HCK_MOD_ANTELOPE_JOIN_ALGORITHMS */
+
 db_result_t
 relation_process_join(void *handle_ptr)
 {
@@ -966,17 +1839,20 @@ relation_process_join(void *handle_ptr)
   db_result_t result;
   relation_t *left_rel;
   relation_t *right_rel;
-  relation_t *join_rel;
-  unsigned char *join_next_attribute_ptr;
-  size_t element_size;
   tuple_id_t right_tuple_id;
   attribute_value_t value;
-  int i;
 
   handle = (db_handle_t *)handle_ptr;
   left_rel = handle->left_rel;
   right_rel = handle->right_rel;
-  join_rel = handle->join_rel;
+
+#if HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
+  if(join_method == JOIN_HASH) {
+    return process_hash_join(handle);
+  } else if(join_method == JOIN_MERGE) {
+    return process_merge_join(handle);
+  }
+#endif /* HCK_MOD_ANTELOPE_JOIN_ALGORITHMS */
 
   if(!(handle->flags & DB_HANDLE_FLAG_INDEX_STEP)) {
     goto inner_loop;
@@ -1030,25 +1906,7 @@ inner_loop:
         return DB_IMPLEMENTATION_ERROR;
       }
 
-      /* Use the source attribute map to fill in the physical representation
-	 of the resulting tuple. */
-      join_next_attribute_ptr = join_row;
-
-      for(i = 0; i < join_rel->attribute_count; i++) {
-	element_size = source_map[i].attr->element_size;
-
-	memcpy(join_next_attribute_ptr, source_map[i].from_ptr, element_size);
-	join_next_attribute_ptr += element_size;
-      }
-
-      if(((aql_adt_t *)handle->adt)->flags & AQL_FLAG_ASSIGN) {
-        if(DB_ERROR(storage_put_row(join_rel, join_row))) {
-          return DB_STORAGE_ERROR;
-        }
-      }
-
-      handle->current_row++;
-      return DB_GOT_ROW;
+      return emit_join_row(handle);
     }
   }
 
@@ -1158,10 +2016,12 @@ relation_join(void *query_result, void *adt_ptr)
     return DB_RELATIONAL_ERROR;
   }
 
+#if !HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
   if(!index_exists(handle->right_join_attr)) {
     PRINTF("DB: The attribute to join on is not indexed\n");
     return DB_INDEX_ERROR;
   }
+#endif /* !HCK_MOD_ANTELOPE_JOIN_ALGORITHMS */
 
   /*
    * Define the resulting relation. We start from 1 when counting attributes
@@ -1189,7 +2049,19 @@ relation_join(void *query_result, void *adt_ptr)
     handle->ncolumns++;
   }
 
+#if HCK_MOD_ANTELOPE_JOIN_ALGORITHMS
+  {
+    db_result_t result;
+
+    result = generate_join_result(handle);
+    if(DB_ERROR(result)) {
+      return result;
+    }
+    return plan_join(handle);
+  }
+#else
   return generate_join_result(handle);
+#endif /* HCK_MOD_ANTELOPE_JOIN_ALGORITHMS */
 }
 #endif /* DB_FEATURE_JOIN */
 
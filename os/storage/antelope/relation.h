@@ -99,4 +99,11 @@ db_result_t relation_select(void *, relation_t *, void *);
 db_result_t relation_join(void *, void *);
 tuple_id_t relation_cardinality(relation_t *);
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t relation_bulk_begin(char *);
+db_result_t relation_bulk_flush(void);
+db_result_t relation_bulk_end(void);
+relation_t *relation_bulk_get(void);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 #endif /* RELATION_H */
@@ -437,6 +437,43 @@ storage_get_row(relation_t *rel, tuple_id_t *tuple_id, storage_row_t row)
   return DB_OK;
 }
 
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+/* Read up to *count consecutive rows starting at tuple_id with a single
+   seek and read, and set *count to the number of complete rows read. */
+db_result_t
+storage_get_rows(relation_t *rel, tuple_id_t tuple_id, storage_row_t rows,
+                 unsigned *count)
+{
+  int r;
+  unsigned i;
+
+  if(rel->row_length == 0 || *count == 0) {
+    *count = 0;
+    return DB_FINISHED;
+  }
+
+  if(cfs_seek(rel->tuple_storage, tuple_id * rel->row_length, CFS_SEEK_SET) ==
+              (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+  r = cfs_read(rel->tuple_storage, rows, *count * rel->row_length);
+  if(r < 0) {
+    PRINTF("DB: Reading failed on fd %d\n", rel->tuple_storage);
+    return DB_STORAGE_ERROR;
+  }
+
+  *count = r / rel->row_length;
+  for(i = 1; i <= *count; i++) {
+    rows[i * rel->row_length - 1] ^= ROW_XOR;
+  }
+
+  PRINTF("DB: Read %u rows from relation %s\n", *count, rel->name);
+
+  return *count == 0 ? DB_FINISHED : DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
+
 db_result_t
 storage_put_row(relation_t *rel, storage_row_t row)
 {
@@ -489,6 +526,67 @@ storage_put_row(relation_t *rel, storage_row_t row)
   return DB_OK;
 }
 
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+/* Append count rows with a single write. As in storage_put_row(), the
+   last byte of every row is separated from 0, so that a write cut short
+   by a reset leaves only complete rows and at most one partial row,
+   which storage_get_row_amount() does not count. */
+db_result_t
+storage_put_rows(relation_t *rel, storage_row_t rows, unsigned count)
+{
+  cfs_offset_t end;
+  unsigned i;
+  unsigned remaining;
+  unsigned char *ptr;
+  int r;
+#if DB_FEATURE_INTEGRITY
+  int missing_bytes;
+  char buf[rel->row_length];
+#endif
+
+  end = cfs_seek(rel->tuple_storage, 0, CFS_SEEK_END);
+  if(end == (cfs_offset_t)-1) {
+    return DB_STORAGE_ERROR;
+  }
+
+#if DB_FEATURE_INTEGRITY
+  /* Complete a partial row left by an earlier interrupted write. */
+  missing_bytes = rel->row_length - end % rel->row_length;
+  if(missing_bytes < rel->row_length) {
+    memset(buf, 0xff, sizeof(buf));
+    r = cfs_write(rel->tuple_storage, buf, missing_bytes);
+    if(r != missing_bytes) {
+      return DB_STORAGE_ERROR;
+    }
+  }
+#endif
+
+  for(i = 1; i <= count; i++) {
+    rows[i * rel->row_length - 1] ^= ROW_XOR;
+  }
+
+  ptr = rows;
+  remaining = count * rel->row_length;
+  do {
+    r = cfs_write(rel->tuple_storage, ptr, remaining);
+    if(r < 0) {
+      PRINTF("DB: Failed to store %u bytes\n", remaining);
+      break;
+    }
+    ptr += r;
+    remaining -= r;
+  } while(remaining > 0);
+
+  for(i = 1; i <= count; i++) {
+    rows[i * rel->row_length - 1] ^= ROW_XOR;
+  }
+
+  PRINTF("DB: Stored %u rows of %d bytes\n", count, rel->row_length);
+
+  return remaining > 0 ? DB_STORAGE_ERROR : DB_OK;
+}
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
+
 db_result_t
 storage_get_row_amount(relation_t *rel, tuple_id_t *amount)
 {
@@ -66,7 +66,13 @@ db_result_t storage_put_index(index_t *);
 
 db_result_t storage_get_row(relation_t *, tuple_id_t *, storage_row_t);
 db_result_t storage_put_row(relation_t *, storage_row_t);
+#if HCK_MOD_ANTELOPE_BULK_INSERT
+db_result_t storage_put_rows(relation_t *, storage_row_t, unsigned);
+#endif /* HCK_MOD_ANTELOPE_BULK_INSERT */
 db_result_t storage_get_row_amount(relation_t *, tuple_id_t *);
+#if HCK_MOD_ANTELOPE_COMPILED_PREDICATES
+db_result_t storage_get_rows(relation_t *, tuple_id_t, storage_row_t, unsigned *);
+#endif /* HCK_MOD_ANTELOPE_COMPILED_PREDICATES */
 
 db_storage_id_t storage_open(const char *);
 void storage_close(db_storage_id_t);
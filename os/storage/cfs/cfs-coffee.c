@@ -206,12 +206,104 @@ static struct file_desc coffee_fd_set[COFFEE_FD_SET_SIZE];
 static coffee_page_t next_free;
 static char gc_wait;
 
+#if HCK_MOD_COFFEE_NAME_INDEX
+/*
+ * RAM index of the active files: name hash -> first page, plus the
+ * last known file end so that reopening an evicted file does not have
+ * to scan its pages. The index is built by one pass over the flash on
+ * the first lookup and kept current by reserve() and remove_by_page().
+ * Garbage collection only erases obsolete pages, so it never
+ * invalidates an entry.
+ */
+#ifdef HCK_COFFEE_NAME_INDEX_CONF_SIZE
+#define HCK_COFFEE_NAME_INDEX_SIZE HCK_COFFEE_NAME_INDEX_CONF_SIZE
+#else
+#define HCK_COFFEE_NAME_INDEX_SIZE 32
+#endif
+
+struct name_index_entry {
+  cfs_offset_t end;
+  coffee_page_t page;
+  uint16_t hash;
+};
+
+static struct name_index_entry name_index[HCK_COFFEE_NAME_INDEX_SIZE];
+static uint16_t name_index_count;
+static uint8_t name_index_valid;
+/* Set when a file did not fit; lookup misses then fall back to a scan. */
+static uint8_t name_index_overflow;
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
+
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+/*
+ * Background garbage collection: coffee_gc_process erases reclaimable
+ * sectors in steps of bounded duration once allocations reach within
+ * HCK_COFFEE_GC_LOW_WATERMARK pages of the end of the flash, so that
+ * reserve() seldom has to collect synchronously.
+ */
+#ifdef HCK_COFFEE_GC_CONF_STEP_BUDGET
+#define HCK_COFFEE_GC_STEP_BUDGET HCK_COFFEE_GC_CONF_STEP_BUDGET
+#else
+#define HCK_COFFEE_GC_STEP_BUDGET (RTIMER_SECOND / 500)
+#endif
+
+#ifdef HCK_COFFEE_GC_CONF_LOW_WATERMARK
+#define HCK_COFFEE_GC_LOW_WATERMARK HCK_COFFEE_GC_CONF_LOW_WATERMARK
+#else
+#define HCK_COFFEE_GC_LOW_WATERMARK (2 * COFFEE_PAGES_PER_SECTOR)
+#endif
+
+/*
+ * Result of get_sector_status() for a sector, valid as long as no
+ * header in the sector is written and the iteration state it was
+ * entered with (the extent spilling over from the previous sectors)
+ * is the same.
+ */
+struct sector_cache {
+  struct sector_status stats;
+  coffee_page_t in_skip;
+  coffee_page_t out_skip;
+  coffee_page_t isolation_count;
+  uint8_t in_active;
+  uint8_t out_active;
+  uint8_t valid;
+};
+
+static struct sector_cache sector_cache[COFFEE_SECTOR_COUNT];
+/* Bumped on every change of the sector layout. */
+static uint16_t gc_generation;
+/* Bumped when pages become obsolete, i.e., reclaimable. */
+static uint16_t gc_removals;
+/* Value of gc_removals when a sweep last found nothing to erase. */
+static uint16_t gc_idle_removals = (uint16_t)-1;
+
+/* Iteration state of get_sector_status(), shared with the cache. */
+static coffee_page_t skip_pages;
+static char last_pages_are_active;
+
+struct cfs_coffee_gc_stats cfs_coffee_gc_stats;
+
+PROCESS(coffee_gc_process, "Coffee GC");
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+static void
+invalidate_sector(coffee_page_t sector)
+{
+  sector_cache[sector].valid = 0;
+  gc_generation++;
+}
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
 /*---------------------------------------------------------------------------*/
 static void
 write_header(struct file_header *hdr, coffee_page_t page)
 {
   hdr->flags |= HDR_FLAG_VALID;
   COFFEE_WRITE(hdr, sizeof(*hdr), page * COFFEE_PAGE_SIZE);
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  invalidate_sector(page / COFFEE_PAGES_PER_SECTOR);
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
 }
 /*---------------------------------------------------------------------------*/
 static void
@@ -232,8 +324,10 @@ absolute_offset(coffee_page_t page, cfs_offset_t offset)
 static coffee_page_t
 get_sector_status(coffee_page_t sector, struct sector_status *stats)
 {
+#if !HCK_MOD_COFFEE_INCREMENTAL_GC
   static coffee_page_t skip_pages;
   static char last_pages_are_active;
+#endif /* !HCK_MOD_COFFEE_INCREMENTAL_GC */
   struct file_header hdr;
   coffee_page_t active, obsolete, free;
   coffee_page_t sector_start, sector_end;
@@ -329,6 +423,41 @@ get_sector_status(coffee_page_t sector, struct sector_status *stats)
          0 : skip_pages;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+static coffee_page_t
+cached_sector_status(coffee_page_t sector, struct sector_status *stats)
+{
+  struct sector_cache *cache;
+
+  if(sector == 0) {
+    skip_pages = 0;
+    last_pages_are_active = 0;
+  }
+
+  cache = &sector_cache[sector];
+  if(cache->valid && cache->in_skip == skip_pages &&
+     cache->in_active == last_pages_are_active) {
+    cfs_coffee_gc_stats.status_hits++;
+    *stats = cache->stats;
+    skip_pages = cache->out_skip;
+    last_pages_are_active = cache->out_active;
+    return cache->isolation_count;
+  }
+
+  cfs_coffee_gc_stats.status_misses++;
+  cache->in_skip = skip_pages;
+  cache->in_active = last_pages_are_active;
+  cache->isolation_count = get_sector_status(sector, stats);
+  cache->stats = *stats;
+  cache->out_skip = skip_pages;
+  cache->out_active = last_pages_are_active;
+  cache->valid = 1;
+  return cache->isolation_count;
+}
+#else /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+#define cached_sector_status get_sector_status
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+/*---------------------------------------------------------------------------*/
 static void
 isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 {
@@ -349,11 +478,39 @@ isolate_pages(coffee_page_t start, coffee_page_t skip_pages)
 }
 /*---------------------------------------------------------------------------*/
 static void
+erase_sector(coffee_page_t sector, coffee_page_t isolation_count)
+{
+  coffee_page_t first_page;
+
+  first_page = sector * COFFEE_PAGES_PER_SECTOR;
+  if(first_page < next_free) {
+    next_free = first_page;
+  }
+
+  if(isolation_count > 0) {
+    isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
+  }
+
+  COFFEE_ERASE(sector);
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  invalidate_sector(sector);
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+  PRINTF("Coffee: Erased sector %d!\n", sector);
+}
+/*---------------------------------------------------------------------------*/
+static void
 collect_garbage(int mode)
 {
   coffee_page_t sector;
   struct sector_status stats;
-  coffee_page_t first_page, isolation_count;
+  coffee_page_t isolation_count;
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  rtimer_clock_t start = RTIMER_NOW();
+  uint32_t pause;
+
+  /* This resets the status iteration of a paused background sweep. */
+  gc_generation++;
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
 
   PRINTF("Coffee: Running the garbage collector in %s mode\n",
          mode == GC_RELUCTANT ? "reluctant" : "greedy");
@@ -362,7 +519,7 @@ collect_garbage(int mode)
    * erasable if there are only free or obsolete pages in it.
    */
   for(sector = 0; sector < COFFEE_SECTOR_COUNT; sector++) {
-    isolation_count = get_sector_status(sector, &stats);
+    isolation_count = cached_sector_status(sector, &stats);
     PRINTF("Coffee: Sector %u has %u active, %u obsolete, and %u free pages.\n",
            (unsigned)sector, (unsigned)stats.active,
            (unsigned)stats.obsolete, (unsigned)stats.free);
@@ -373,24 +530,103 @@ collect_garbage(int mode)
 
     if((mode == GC_RELUCTANT && stats.free == 0) ||
        (mode == GC_GREEDY && stats.obsolete > 0)) {
-      first_page = sector * COFFEE_PAGES_PER_SECTOR;
-      if(first_page < next_free) {
-        next_free = first_page;
-      }
+      erase_sector(sector, isolation_count);
 
-      if(isolation_count > 0) {
-        isolate_pages(first_page + COFFEE_PAGES_PER_SECTOR, isolation_count);
+      if(mode == GC_RELUCTANT && isolation_count > 0) {
+        break;
       }
+    }
+  }
 
-      COFFEE_ERASE(sector);
-      PRINTF("Coffee: Erased sector %d!\n", sector);
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  pause = RTIMER_CLOCK_DIFF(RTIMER_NOW(), start);
+  cfs_coffee_gc_stats.sync_runs++;
+  cfs_coffee_gc_stats.sync_pause_sum += pause;
+  if(pause > cfs_coffee_gc_stats.sync_pause_max) {
+    cfs_coffee_gc_stats.sync_pause_max = pause;
+  }
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+}
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+static void
+gc_check_watermark(coffee_page_t alloc_end)
+{
+  /*
+   * Allocations take the first extent that fits, so one ending close
+   * to the end of the flash means that little room is left before it.
+   */
+  if(COFFEE_PAGE_COUNT - alloc_end < HCK_COFFEE_GC_LOW_WATERMARK &&
+     gc_removals != gc_idle_removals) {
+    if(!process_is_running(&coffee_gc_process)) {
+      process_start(&coffee_gc_process, NULL);
+    }
+    process_poll(&coffee_gc_process);
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(coffee_gc_process, ev, data)
+{
+  static coffee_page_t sector;
+  static uint16_t generation;
+  static uint16_t removals;
+  static uint8_t erased;
+  struct sector_status stats;
+  coffee_page_t isolation_count;
+  rtimer_clock_t start;
+  uint32_t pause;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_WAIT_EVENT_UNTIL(ev == PROCESS_EVENT_POLL);
+
+    cfs_coffee_gc_stats.sweeps++;
+    removals = gc_removals;
+    erased = 0;
+    sector = 0;
+    while(sector < COFFEE_SECTOR_COUNT) {
+      /* Erase greedily, always making progress of at least one sector. */
+      start = RTIMER_NOW();
+      do {
+        isolation_count = cached_sector_status(sector, &stats);
+        if(stats.active == 0 && stats.obsolete > 0) {
+          erase_sector(sector, isolation_count);
+          cfs_coffee_gc_stats.erased++;
+          erased = 1;
+        }
+        sector++;
+      } while(sector < COFFEE_SECTOR_COUNT &&
+              RTIMER_CLOCK_DIFF(RTIMER_NOW(), start) < HCK_COFFEE_GC_STEP_BUDGET);
+
+      pause = RTIMER_CLOCK_DIFF(RTIMER_NOW(), start);
+      cfs_coffee_gc_stats.steps++;
+      if(pause > cfs_coffee_gc_stats.step_pause_max) {
+        cfs_coffee_gc_stats.step_pause_max = pause;
+      }
 
-      if(mode == GC_RELUCTANT && isolation_count > 0) {
-        break;
+      if(sector < COFFEE_SECTOR_COUNT) {
+        generation = gc_generation;
+        PROCESS_PAUSE();
+        /*
+         * Files reserved or removed meanwhile may have changed the
+         * extent spilling into the next sector. Restart the sweep, the
+         * cache makes the unchanged sectors free to revisit.
+         */
+        if(generation != gc_generation) {
+          sector = 0;
+        }
       }
     }
+
+    if(!erased) {
+      gc_idle_removals = removals;
+    }
   }
+
+  PROCESS_END();
 }
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
 /*---------------------------------------------------------------------------*/
 static coffee_page_t
 next_file(coffee_page_t page, struct file_header *hdr)
@@ -413,6 +649,79 @@ next_file(coffee_page_t page, struct file_header *hdr)
   return page + hdr->max_pages;
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_COFFEE_NAME_INDEX
+static uint16_t
+name_hash(const char *name)
+{
+  uint16_t hash;
+  int i;
+
+  /* Only the part of the name that fits in a file header counts. */
+  hash = 5381;
+  for(i = 0; i < COFFEE_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+    hash = (hash << 5) + hash + (uint8_t)name[i];
+  }
+  return hash;
+}
+/*---------------------------------------------------------------------------*/
+static struct name_index_entry *
+name_index_by_page(coffee_page_t page)
+{
+  int i;
+
+  for(i = 0; i < name_index_count; i++) {
+    if(name_index[i].page == page) {
+      return &name_index[i];
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_add(const char *name, coffee_page_t page, cfs_offset_t end)
+{
+  if(name_index_count == HCK_COFFEE_NAME_INDEX_SIZE) {
+    name_index_overflow = 1;
+    return;
+  }
+  name_index[name_index_count].hash = name_hash(name);
+  name_index[name_index_count].page = page;
+  name_index[name_index_count].end = end;
+  name_index_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_remove(coffee_page_t page)
+{
+  struct name_index_entry *entry;
+
+  entry = name_index_by_page(page);
+  if(entry != NULL) {
+    *entry = name_index[--name_index_count];
+  } else if(name_index_overflow) {
+    /* Rebuild on the next lookup, the freed room may fit all files now. */
+    name_index_valid = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+name_index_build(void)
+{
+  struct file_header hdr;
+  coffee_page_t page;
+
+  name_index_count = 0;
+  name_index_overflow = 0;
+  for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
+    read_header(&hdr, page);
+    if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
+      name_index_add(hdr.name, page, UNKNOWN_OFFSET);
+    }
+  }
+  name_index_valid = 1;
+}
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
+/*---------------------------------------------------------------------------*/
 static struct file *
 load_file(coffee_page_t start, struct file_header *hdr)
 {
@@ -442,6 +751,15 @@ load_file(coffee_page_t start, struct file_header *hdr)
   }
 
   file = &coffee_files[i];
+#if HCK_MOD_COFFEE_NAME_INDEX
+  /* Keep the end of the evicted file as a hint for its next open. */
+  if(free == -1 && file->end != UNKNOWN_OFFSET && name_index_valid) {
+    struct name_index_entry *entry = name_index_by_page(file->page);
+    if(entry != NULL) {
+      entry->end = file->end;
+    }
+  }
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
   file->page = start;
   file->end = UNKNOWN_OFFSET;
   file->max_pages = hdr->max_pages;
@@ -458,6 +776,14 @@ find_file(const char *name)
   int i;
   struct file_header hdr;
   coffee_page_t page;
+#if HCK_MOD_COFFEE_NAME_INDEX
+  uint16_t hash;
+
+  if(!name_index_valid) {
+    name_index_build();
+  }
+  hash = name_hash(name);
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
 
   /* First check if the file metadata is cached. */
   for(i = 0; i < COFFEE_MAX_OPEN_FILES; i++) {
@@ -465,12 +791,47 @@ find_file(const char *name)
       continue;
     }
 
+#if HCK_MOD_COFFEE_NAME_INDEX
+    /* Without an overflow, every active non-log file is indexed, so
+       only a cached file with the same name hash can match. */
+    if(!name_index_overflow) {
+      struct name_index_entry *entry = name_index_by_page(coffee_files[i].page);
+      if(entry == NULL || entry->hash != hash) {
+        continue;
+      }
+    }
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
+
     read_header(&hdr, coffee_files[i].page);
     if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
       return &coffee_files[i];
     }
   }
 
+#if HCK_MOD_COFFEE_NAME_INDEX
+  {
+    struct file *file;
+
+    for(i = 0; i < name_index_count; i++) {
+      if(name_index[i].hash != hash) {
+        continue;
+      }
+      read_header(&hdr, name_index[i].page);
+      if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr) && strcmp(name, hdr.name) == 0) {
+        file = load_file(name_index[i].page, &hdr);
+        if(file != NULL) {
+          file->end = name_index[i].end;
+        }
+        return file;
+      }
+    }
+  }
+
+  if(!name_index_overflow) {
+    return NULL;
+  }
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
+
   /* Scan the flash memory sequentially otherwise. */
   for(page = 0; page < COFFEE_PAGE_COUNT; page = next_file(page, &hdr)) {
     read_header(&hdr, page);
@@ -574,6 +935,15 @@ remove_by_page(coffee_page_t page, int remove_log,
   write_header(&hdr, page);
 
   gc_wait = 0;
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  gc_removals++;
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+
+#if HCK_MOD_COFFEE_NAME_INDEX
+  if(name_index_valid && !HDR_LOG(hdr)) {
+    name_index_remove(page);
+  }
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
 
   /* Close all file descriptors that reference the removed file. */
   if(close_fds) {
@@ -637,6 +1007,12 @@ reserve(const char *name, coffee_page_t pages,
   hdr.flags = HDR_FLAG_ALLOCATED | flags;
   write_header(&hdr, page);
 
+#if HCK_MOD_COFFEE_NAME_INDEX
+  if(name_index_valid && !(flags & HDR_FLAG_LOG)) {
+    name_index_add(hdr.name, page, 0);
+  }
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
+
   PRINTF("Coffee: Reserved %u pages starting from %u for file %s\n",
          (unsigned)pages, (unsigned)page, name);
 
@@ -645,6 +1021,10 @@ reserve(const char *name, coffee_page_t pages,
     file->end = 0;
   }
 
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+  gc_check_watermark(page + pages);
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+
   return file;
 }
 /*---------------------------------------------------------------------------*/
@@ -1253,7 +1633,7 @@ cfs_readdir(struct cfs_dir *dir, struct cfs_dirent *record)
   while(page < COFFEE_PAGE_COUNT) {
     read_header(&hdr, page);
     if(HDR_ACTIVE(hdr) && !HDR_LOG(hdr)) {
-      memcpy(record->name, hdr.name, sizeof(record->name));
+      strncpy(record->name, hdr.name, sizeof(record->name) - 1);
       record->name[sizeof(record->name) - 1] = '\0';
       record->size = file_end(page);
 
@@ -1330,6 +1710,9 @@ cfs_coffee_format(void)
 
   for(i = 0; i < COFFEE_SECTOR_COUNT; i++) {
     COFFEE_ERASE(i);
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+    invalidate_sector(i);
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
     PRINTF(".");
   }
 
@@ -1338,6 +1721,9 @@ cfs_coffee_format(void)
   memset(&coffee_fd_set, 0, sizeof(coffee_fd_set));
   next_free = 0;
   gc_wait = 1;
+#if HCK_MOD_COFFEE_NAME_INDEX
+  name_index_valid = 0;
+#endif /* HCK_MOD_COFFEE_NAME_INDEX */
 
   PRINTF(" done!\n");
 
@@ -140,6 +140,27 @@ int cfs_coffee_set_io_semantics(int fd, unsigned flags);
  */
 int cfs_coffee_format(void);
 
+#if HCK_MOD_COFFEE_INCREMENTAL_GC
+/**
+ * Garbage collection statistics, pauses in rtimer ticks. Synchronous
+ * collections run inside reserve() when no room is left, background
+ * steps in the Coffee GC process.
+ */
+struct cfs_coffee_gc_stats {
+  uint32_t sync_runs;
+  uint32_t sync_pause_sum;
+  uint32_t sync_pause_max;
+  uint32_t sweeps;
+  uint32_t steps;
+  uint32_t step_pause_max;
+  uint32_t erased;
+  uint32_t status_hits;
+  uint32_t status_misses;
+};
+
+extern struct cfs_coffee_gc_stats cfs_coffee_gc_stats;
+#endif /* HCK_MOD_COFFEE_INCREMENTAL_GC */
+
 /** @} */
 /** @} */
 
@@ -49,11 +49,202 @@
 #include "sys/etimer.h"
 #include "sys/process.h"
 
+#if HCK_MOD_ETIMER_WHEEL
+/* Hashed timer wheel: a pending timer sits in the slot of its expiry tick,
+ * so a poll only visits the slots of the ticks elapsed since the previous
+ * poll instead of every pending timer. */
+#ifdef HCK_ETIMER_CONF_WHEEL_SLOTS
+#define HCK_ETIMER_WHEEL_SLOTS HCK_ETIMER_CONF_WHEEL_SLOTS
+#else
+#define HCK_ETIMER_WHEEL_SLOTS 64
+#endif
+
+#if HCK_ETIMER_WHEEL_SLOTS > 256 \
+    || (HCK_ETIMER_WHEEL_SLOTS & (HCK_ETIMER_WHEEL_SLOTS - 1)) != 0
+#error "HCK_ETIMER_WHEEL_SLOTS must be a power of two, at most 256"
+#endif
+
+#define WHEEL_SLOT(t)     ((uint8_t)((t) & (HCK_ETIMER_WHEEL_SLOTS - 1)))
+#define EXPIRY(et)        ((et)->timer.start + (et)->timer.interval)
+/* Is a before b, accounting for clock wraps */
+#define BEFORE(a, b)      ((clock_time_t)((a) - (b)) > ((clock_time_t)~0 >> 1))
+
+static struct etimer *wheel[HCK_ETIMER_WHEEL_SLOTS];
+static uint16_t wheel_count;
+/* Slots of the ticks before this one have been served */
+static clock_time_t wheel_last;
+/* Never later than the earliest expiry: when the timer at next_expiration
+ * leaves the wheel, the value stays until etimer_process recomputes it, so
+ * the clock interrupt may only poll early */
+static clock_time_t next_expiration;
+/* Set when the timer at next_expiration left the wheel */
+static uint8_t next_expiration_stale;
+#else /* HCK_MOD_ETIMER_WHEEL */
 static struct etimer *timerlist;
 static clock_time_t next_expiration;
+#endif /* HCK_MOD_ETIMER_WHEEL */
 
 PROCESS(etimer_process, "Event timer");
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_ETIMER_WHEEL
+static void
+update_time(void)
+{
+  clock_time_t tdist = 0;
+  clock_time_t now;
+  struct etimer *t;
+  int first = 1;
+  int i;
+
+  next_expiration_stale = 0;
+  if(wheel_count == 0) {
+    next_expiration = 0;
+    return;
+  }
+
+  now = clock_time();
+  for(i = 0; i < HCK_ETIMER_WHEEL_SLOTS; i++) {
+    for(t = wheel[i]; t != NULL; t = t->next) {
+      /* Must calculate distance to next time into account due to wraps */
+      if(first || EXPIRY(t) - now < tdist) {
+        tdist = EXPIRY(t) - now;
+        first = 0;
+      }
+    }
+  }
+  next_expiration = now + tdist;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_insert(struct etimer *t)
+{
+  clock_time_t expiry = EXPIRY(t);
+
+  if(wheel_count == 0) {
+    wheel_last = clock_time();
+    next_expiration = expiry;
+    next_expiration_stale = 0;
+  } else if(!next_expiration_stale && BEFORE(expiry, next_expiration)) {
+    next_expiration = expiry;
+  }
+
+  /* A timer due before the slots still to be served goes to the first of
+     them, so that the next poll finds it */
+  t->slot = BEFORE(expiry, wheel_last) ? WHEEL_SLOT(wheel_last) : WHEEL_SLOT(expiry);
+  t->next = wheel[t->slot];
+  wheel[t->slot] = t;
+  wheel_count++;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_unlink(struct etimer **pp)
+{
+  struct etimer *t = *pp;
+
+  *pp = t->next;
+  t->next = NULL;
+  if(--wheel_count == 0) {
+    next_expiration = 0;
+    next_expiration_stale = 0;
+  } else if(EXPIRY(t) == next_expiration) {
+    /* Recomputed in etimer_process, not in the clock interrupt */
+    next_expiration_stale = 1;
+    etimer_request_poll();
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Returns 1 if the timer was pending and has been removed */
+static int
+wheel_remove(struct etimer *t)
+{
+  struct etimer **pp;
+
+#if HCK_ETIMER_WHEEL_SLOTS < 256
+  if(t->slot >= HCK_ETIMER_WHEEL_SLOTS) {
+    return 0;
+  }
+#endif
+  for(pp = &wheel[t->slot]; *pp != NULL; pp = &(*pp)->next) {
+    if(*pp == t) {
+      wheel_unlink(pp);
+      return 1;
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+wheel_run(void)
+{
+  clock_time_t now = clock_time();
+  clock_time_t span = now - wheel_last;
+  clock_time_t i;
+  struct etimer **pp;
+  struct etimer *t;
+
+  if(wheel_count == 0) {
+    return;
+  }
+  if(span >= HCK_ETIMER_WHEEL_SLOTS) {
+    span = HCK_ETIMER_WHEEL_SLOTS - 1;
+  }
+
+  for(i = 0; i <= span; i++) {
+    pp = &wheel[WHEEL_SLOT(wheel_last + i)];
+    while((t = *pp) != NULL) {
+      if(!timer_expired(&t->timer)) {
+        pp = &t->next;
+      } else if(process_post(t->p, PROCESS_EVENT_TIMER, t) == PROCESS_ERR_OK) {
+        /* Reset the process ID of the event timer, to signal that the
+           etimer has expired. This is later checked in the
+           etimer_expired() function. */
+        t->p = PROCESS_NONE;
+        wheel_unlink(pp);
+      } else {
+        /* Event queue full, serve this slot again on the next poll */
+        wheel_last += i;
+        etimer_request_poll();
+        return;
+      }
+    }
+  }
+  wheel_last = now;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(etimer_process, ev, data)
+{
+  struct etimer **pp;
+  int i;
+
+  PROCESS_BEGIN();
+
+  while(1) {
+    PROCESS_YIELD();
+
+    if(ev == PROCESS_EVENT_EXITED) {
+      struct process *p = data;
+
+      for(i = 0; i < HCK_ETIMER_WHEEL_SLOTS; i++) {
+        pp = &wheel[i];
+        while(*pp != NULL) {
+          if((*pp)->p == p) {
+            wheel_unlink(pp);
+          } else {
+            pp = &(*pp)->next;
+          }
+        }
+      }
+    } else if(ev == PROCESS_EVENT_POLL) {
+      wheel_run();
+    }
+    if(next_expiration_stale) {
+      update_time();
+    }
+  }
+
+  PROCESS_END();
+}
+#else /* HCK_MOD_ETIMER_WHEEL */
 static void
 update_time(void)
 {
@@ -140,6 +331,7 @@ again:
 
   PROCESS_END();
 }
+#endif /* HCK_MOD_ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 void
 etimer_request_poll(void)
@@ -147,6 +339,20 @@ etimer_request_poll(void)
   process_poll(&etimer_process);
 }
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_ETIMER_WHEEL
+static void
+add_timer(struct etimer *timer)
+{
+  etimer_request_poll();
+
+  if(timer->p != PROCESS_NONE && wheel_remove(timer)) {
+    /* Timer was pending, its previous expiry is lost */
+    next_expiration_stale = wheel_count > 0;
+  }
+  timer->p = PROCESS_CURRENT();
+  wheel_insert(timer);
+}
+#else /* HCK_MOD_ETIMER_WHEEL */
 static void
 add_timer(struct etimer *timer)
 {
@@ -172,6 +378,7 @@ add_timer(struct etimer *timer)
 
   update_time();
 }
+#endif /* HCK_MOD_ETIMER_WHEEL */
 /*---------------------------------------------------------------------------*/
 void
 etimer_set(struct etimer *et, clock_time_t interval)
@@ -205,8 +412,17 @@ etimer_restart(struct etimer *et)
 void
 etimer_adjust(struct etimer *et, int timediff)
 {
+#if HCK_MOD_ETIMER_WHEEL
+  int pending = et->p != PROCESS_NONE && wheel_remove(et);
+
+  et->timer.start += timediff;
+  if(pending) {
+    wheel_insert(et);
+  }
+#else
   et->timer.start += timediff;
   update_time();
+#endif
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -230,7 +446,11 @@ etimer_start_time(struct etimer *et)
 int
 etimer_pending(void)
 {
+#if HCK_MOD_ETIMER_WHEEL
+  return wheel_count != 0;
+#else
   return timerlist != NULL;
+#endif
 }
 /*---------------------------------------------------------------------------*/
 clock_time_t
@@ -242,6 +462,9 @@ etimer_next_expiration_time(void)
 void
 etimer_stop(struct etimer *et)
 {
+#if HCK_MOD_ETIMER_WHEEL
+  wheel_remove(et);
+#else
   struct etimer *t;
 
   /* First check if et is the first event timer on the list. */
@@ -263,6 +486,7 @@ etimer_stop(struct etimer *et)
       update_time();
     }
   }
+#endif
 
   /* Remove the next pointer from the item to be removed. */
   et->next = NULL;
@@ -77,6 +77,9 @@ struct etimer {
   struct timer timer;
   struct etimer *next;
   struct process *p;
+#if HCK_MOD_ETIMER_WHEEL
+  uint8_t slot;
+#endif
 };
 
 /**
@@ -44,9 +44,13 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "contiki.h"
 #include "sys/process.h"
+#if HCK_MOD_PROCESS_PRIORITY
+#include "sys/rtimer.h"
+#endif
 
 /*
  * Pointer to the currently running process structure.
@@ -63,10 +67,45 @@ struct event_data {
   process_event_t ev;
   process_data_t data;
   struct process *p;
+#if HCK_MOD_PROCESS_PRIORITY
+  rtimer_clock_t posted;
+#endif
+};
+
+#if HCK_MOD_PROCESS_PRIORITY
+/* One event queue per priority class */
+#ifdef HCK_PROCESS_PRIO_CONF_NUMEVENTS
+#define HCK_PROCESS_PRIO_NUMEVENTS HCK_PROCESS_PRIO_CONF_NUMEVENTS
+#else
+#define HCK_PROCESS_PRIO_NUMEVENTS PROCESS_CONF_NUMEVENTS
+#endif
+/* A non-empty class is served at the latest after this many events of
+   higher classes, which bounds its event latency */
+#ifdef HCK_PROCESS_PRIO_CONF_MAX_SKIPS
+#define HCK_PROCESS_PRIO_MAX_SKIPS HCK_PROCESS_PRIO_CONF_MAX_SKIPS
+#else
+#define HCK_PROCESS_PRIO_MAX_SKIPS 8
+#endif
+
+/* Classes in service order */
+static const unsigned char prio_order[PROCESS_PRIO_NUM] = {
+  PROCESS_PRIO_MAC, PROCESS_PRIO_NET, PROCESS_PRIO_APP, PROCESS_PRIO_LOG
 };
 
+static process_num_events_t nevents;
+static process_num_events_t prio_nevents[PROCESS_PRIO_NUM];
+static process_num_events_t prio_fevent[PROCESS_PRIO_NUM];
+static unsigned char prio_skips[PROCESS_PRIO_NUM];
+static struct event_data events[PROCESS_PRIO_NUM][HCK_PROCESS_PRIO_NUMEVENTS];
+/* Time of the oldest outstanding poll request of each class */
+static volatile unsigned char prio_poll_requested[PROCESS_PRIO_NUM];
+static volatile rtimer_clock_t prio_poll_stamp[PROCESS_PRIO_NUM];
+
+struct process_prio_stats process_prio_stats[PROCESS_PRIO_NUM];
+#else /* HCK_MOD_PROCESS_PRIORITY */
 static process_num_events_t nevents, fevent;
 static struct event_data events[PROCESS_CONF_NUMEVENTS];
+#endif /* HCK_MOD_PROCESS_PRIORITY */
 
 #if PROCESS_CONF_STATS
 process_num_events_t process_maxevents;
@@ -88,6 +127,28 @@ static void call_process(struct process *p, process_event_t ev, process_data_t d
 #define PRINTF(...)
 #endif
 
+/*---------------------------------------------------------------------------*/
+#if HCK_MOD_PROCESS_PRIORITY
+static void
+prio_account(unsigned char prio, rtimer_clock_t since)
+{
+  uint32_t latency = (rtimer_clock_t)(RTIMER_NOW() - since);
+
+  process_prio_stats[prio].served++;
+  process_prio_stats[prio].latency_sum += latency;
+  if(latency > process_prio_stats[prio].latency_max) {
+    process_prio_stats[prio].latency_max = latency;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+process_set_priority(struct process *p, unsigned char prio)
+{
+  if(prio < PROCESS_PRIO_NUM) {
+    p->prio = prio;
+  }
+}
+#endif /* HCK_MOD_PROCESS_PRIORITY */
 /*---------------------------------------------------------------------------*/
 process_event_t
 process_alloc_event(void)
@@ -209,7 +270,14 @@ process_init(void)
 {
   lastevent = PROCESS_EVENT_MAX;
 
+#if HCK_MOD_PROCESS_PRIORITY
+  nevents = 0;
+  memset(prio_nevents, 0, sizeof(prio_nevents));
+  memset(prio_fevent, 0, sizeof(prio_fevent));
+  memset(prio_skips, 0, sizeof(prio_skips));
+#else
   nevents = fevent = 0;
+#endif
 #if PROCESS_CONF_STATS
   process_maxevents = 0;
 #endif /* PROCESS_CONF_STATS */
@@ -221,6 +289,32 @@ process_init(void)
  * Call each process' poll handler.
  */
 /*---------------------------------------------------------------------------*/
+#if HCK_MOD_PROCESS_PRIORITY
+static void
+do_poll(void)
+{
+  struct process *p;
+  unsigned char i, prio;
+
+  poll_requested = 0;
+  /* Call the processes that needs to be polled, class by class. */
+  for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+    prio = prio_order[i];
+    if(!prio_poll_requested[prio]) {
+      continue;
+    }
+    prio_poll_requested[prio] = 0;
+    prio_account(prio, prio_poll_stamp[prio]);
+    for(p = process_list; p != NULL; p = p->next) {
+      if(p->needspoll && p->prio == prio) {
+        p->state = PROCESS_STATE_RUNNING;
+        p->needspoll = 0;
+        call_process(p, PROCESS_EVENT_POLL, NULL);
+      }
+    }
+  }
+}
+#else /* HCK_MOD_PROCESS_PRIORITY */
 static void
 do_poll(void)
 {
@@ -236,6 +330,7 @@ do_poll(void)
     }
   }
 }
+#endif /* HCK_MOD_PROCESS_PRIORITY */
 /*---------------------------------------------------------------------------*/
 /*
  * Process the next event in the event queue and deliver it to
@@ -260,6 +355,36 @@ do_event(void)
 
   if(nevents > 0) {
 
+#if HCK_MOD_PROCESS_PRIORITY
+    struct event_data *e;
+    unsigned char i, prio = PROCESS_PRIO_NUM;
+
+    /* Take the event of the highest non-empty class, unless a lower one
+       has waited for too long */
+    for(i = 0; i < PROCESS_PRIO_NUM; i++) {
+      if(prio_nevents[prio_order[i]] == 0) {
+        continue;
+      }
+      if(prio == PROCESS_PRIO_NUM) {
+        prio = prio_order[i];
+      } else if(++prio_skips[prio_order[i]] > HCK_PROCESS_PRIO_MAX_SKIPS) {
+        prio = prio_order[i];
+        process_prio_stats[prio].aged++;
+        break;
+      }
+    }
+    prio_skips[prio] = 0;
+
+    e = &events[prio][prio_fevent[prio]];
+    ev = e->ev;
+    data = e->data;
+    receiver = e->p;
+    prio_account(prio, e->posted);
+
+    prio_fevent[prio] = (prio_fevent[prio] + 1) % HCK_PROCESS_PRIO_NUMEVENTS;
+    --prio_nevents[prio];
+    --nevents;
+#else /* HCK_MOD_PROCESS_PRIORITY */
     /* There are events that we should deliver. */
     ev = events[fevent].ev;
 
@@ -270,6 +395,7 @@ do_event(void)
        and decrease the number of events. */
     fevent = (fevent + 1) % PROCESS_CONF_NUMEVENTS;
     --nevents;
+#endif /* HCK_MOD_PROCESS_PRIORITY */
 
     /* If this is a broadcast event, we deliver it to all events, in
        order of their priority. */
@@ -332,7 +458,14 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
            p == PROCESS_BROADCAST ? "<broadcast>" : PROCESS_NAME_STRING(p), nevents);
   }
 
+#if HCK_MOD_PROCESS_PRIORITY
+  unsigned char prio = p == PROCESS_BROADCAST ? PROCESS_PRIO_APP : p->prio;
+
+  if(prio_nevents[prio] == HCK_PROCESS_PRIO_NUMEVENTS) {
+    process_prio_stats[prio].full++;
+#else
   if(nevents == PROCESS_CONF_NUMEVENTS) {
+#endif
 #if DEBUG
     if(p == PROCESS_BROADCAST) {
       printf("soft panic: event queue is full when broadcast event %d was posted from %s\n", ev, PROCESS_NAME_STRING(process_current));
@@ -343,10 +476,19 @@ process_post(struct process *p, process_event_t ev, process_data_t data)
     return PROCESS_ERR_FULL;
   }
 
+#if HCK_MOD_PROCESS_PRIORITY
+  snum = (process_num_events_t)(prio_fevent[prio] + prio_nevents[prio]) % HCK_PROCESS_PRIO_NUMEVENTS;
+  events[prio][snum].ev = ev;
+  events[prio][snum].data = data;
+  events[prio][snum].p = p;
+  events[prio][snum].posted = RTIMER_NOW();
+  ++prio_nevents[prio];
+#else
   snum = (process_num_events_t)(fevent + nevents) % PROCESS_CONF_NUMEVENTS;
   events[snum].ev = ev;
   events[snum].data = data;
   events[snum].p = p;
+#endif
   ++nevents;
 
 #if PROCESS_CONF_STATS
@@ -373,6 +515,12 @@ process_poll(struct process *p)
   if(p != NULL) {
     if(p->state == PROCESS_STATE_RUNNING ||
        p->state == PROCESS_STATE_CALLED) {
+#if HCK_MOD_PROCESS_PRIORITY
+      if(!prio_poll_requested[p->prio]) {
+        prio_poll_stamp[p->prio] = RTIMER_NOW();
+        prio_poll_requested[p->prio] = 1;
+      }
+#endif
       p->needspoll = 1;
       poll_requested = 1;
     }
@@ -323,7 +323,47 @@ struct process {
   PT_THREAD((* thread)(struct pt *, process_event_t, process_data_t));
   struct pt pt;
   unsigned char state, needspoll;
+#if HCK_MOD_PROCESS_PRIORITY
+  unsigned char prio;
+#endif
+};
+
+#if HCK_MOD_PROCESS_PRIORITY
+/**
+ * \name Priority classes
+ *
+ * Events and polls of a class are served before those of the classes
+ * after it, in the order MAC, NET, APP, LOG. APP is 0 so that it is the
+ * class of every process that does not set one.
+ * @{
+ */
+#define PROCESS_PRIO_APP 0
+#define PROCESS_PRIO_MAC 1
+#define PROCESS_PRIO_NET 2
+#define PROCESS_PRIO_LOG 3
+#define PROCESS_PRIO_NUM 4
+/** @} */
+
+/** \brief Per-class scheduler statistics, latencies in rtimer ticks */
+struct process_prio_stats {
+  uint32_t served;      /**< Events delivered and polls served */
+  uint32_t latency_sum; /**< Sum of post/poll-to-service latencies */
+  uint32_t latency_max; /**< Largest post/poll-to-service latency */
+  uint32_t full;        /**< Events dropped because the class queue was full */
+  uint32_t aged;        /**< Events served ahead of higher classes by aging */
 };
+extern struct process_prio_stats process_prio_stats[PROCESS_PRIO_NUM];
+
+/**
+ * Set the priority class of a process.
+ *
+ * Events already queued for the process keep their class.
+ *
+ * \param p    A pointer to the process' process structure.
+ * \param prio One of the PROCESS_PRIO_ classes.
+ */
+void process_set_priority(struct process *p, unsigned char prio);
+#endif /* HCK_MOD_PROCESS_PRIORITY */
 
 /**
  * \name Functions called from application programs